@@ -0,0 +1,45 @@
+#ifndef ANALOG_INPUT_H
+#define ANALOG_INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_adc/adc_continuous.h"
+
+// Analog channels (ADC1 only: ADC2 is unusable while the radio is on)
+#define ANALOG_PRESSURE_CHANNEL   ADC_CHANNEL_4   // GPIO32 - nitrous bottle pressure
+#define ANALOG_AFR_CHANNEL        ADC_CHANNEL_5   // GPIO33 - wideband AFR output
+#define ANALOG_ATTEN              ADC_ATTEN_DB_12 // ~0-3.1V input range
+
+// Continuous sampling (DMA); one task wake-up per conversion frame
+#define ANALOG_SAMPLE_FREQ_HZ     20000   // Total across both channels
+#define ANALOG_FRAME_BYTES        1024    // 512 results -> ~39 decimated samples/s per channel
+#define ANALOG_POOL_BYTES         4096
+
+// Front-end divider (sensor mV = ADC mV * RATIO / 1000)
+#define ANALOG_DIVIDER_RATIO_X1000  1650
+
+// Bottle pressure sensor: 0.5-4.5V -> 0-1500 psi
+#define ANALOG_PRESSURE_MV_MIN    500
+#define ANALOG_PRESSURE_MV_MAX    4500
+#define ANALOG_PRESSURE_PSI_MAX   1500
+
+// Wideband controller output: 0-5V -> AFR 10.0-20.0
+#define ANALOG_AFR_X10_AT_0V      100
+#define ANALOG_AFR_X10_AT_5V      200
+
+// Interlock limits
+#define ANALOG_PRESSURE_MIN_PSI   900     // Bottle pressure window for safe activation
+#define ANALOG_PRESSURE_MAX_PSI   1100
+#define ANALOG_AFR_LEAN_LIMIT_X10 135     // Leaner than this blocks activation
+#define ANALOG_SENSOR_FAULT_MV    200     // Sensor output below this = open circuit
+#define ANALOG_READ_TIMEOUT_MS    100     // No frame this long = interlock off
+
+// Function declarations
+void analog_input_init(void);
+void analog_input_task(void *pv);
+
+// Parked power state: sampling off between probes
+void analog_input_suspend(void);
+void analog_input_resume(void);
+
+#endif // ANALOG_INPUT_H 
\ No newline at end of file
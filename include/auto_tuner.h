@@ -0,0 +1,62 @@
+#ifndef AUTO_TUNER_H
+#define AUTO_TUNER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Live acquisition strategy tuning: each candidate runs for a few seconds on
+// the real adapter/ECU and the best one is stored per VIN (mode 09 PID 02)
+#ifndef AUTO_TUNER_ENABLED
+#define AUTO_TUNER_ENABLED          0
+#endif
+#define AUTO_TUNER_ON_NEW_VIN       1       // Tune automatically when no result is stored
+#define AUTO_TUNER_RUN_MS           3000    // Measurement time per candidate
+#define AUTO_TUNER_SETTLE_MS        300     // Drain replies after AT ST / between candidates
+#define AUTO_TUNER_VIN_TIMEOUT_MS   2000
+#define AUTO_TUNER_MAX_ERROR_PCT    5       // Candidates with more failed requests are rejected
+#define AUTO_TUNER_MIN_RPM_X10      20      // At least 2 RPM samples/s, or the result is not stored
+#define AUTO_TUNER_NVS_NAMESPACE    "tuner"
+#define AUTO_TUNER_TABLE_VERSION    1       // Bump when the candidate table changes
+
+// Score weights per samples/s (RPM drives the trigger)
+#define AUTO_TUNER_WEIGHT_RPM       4
+#define AUTO_TUNER_WEIGHT_THROTTLE  2
+#define AUTO_TUNER_WEIGHT_SPEED     1
+
+#define AUTO_TUNER_VIN_LEN          17
+
+// One acquisition strategy
+typedef struct {
+    const char *name;
+    const char *const *commands;    // Normal-profile request cycle
+    uint8_t length;
+    uint32_t slot_ms;               // Engine-running request slot (0 = next request on prompt)
+    const char *atst;               // AT ST value
+    bool individual;                // Single-PID requests (also selects the armed schedule)
+} tuner_strategy_t;
+
+// Function declarations
+void auto_tuner_init(void);
+const tuner_strategy_t *auto_tuner_active(void);
+
+// Vehicle identity: VIN, or "NOVIN" when the ECU does not report one
+void auto_tuner_read_vin(void);     // obd_task, once per adapter session
+const char *auto_tuner_vehicle_id(void);
+void auto_tuner_vehicle_key(char *key, size_t size);    // NVS key (hashed id)
+
+// Polling task side (obd_task context: owns the primary link)
+void auto_tuner_on_connect(void);   // Apply the stored strategy or schedule tuning
+bool auto_tuner_pending(void);
+void auto_tuner_run(void);
+
+// Console: "tune" re-tunes the current vehicle, "tune clear" forgets its result
+void auto_tuner_request(void);
+void auto_tuner_console_task(void *pv);
+
+// Receive path hooks (no-op unless a run or VIN read is active)
+void auto_tuner_on_pid(uint8_t source, uint8_t pid);
+void auto_tuner_on_error(void);
+void auto_tuner_on_vin_line(const char *line);
+
+#endif // AUTO_TUNER_H 
\ No newline at end of file
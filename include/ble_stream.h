@@ -0,0 +1,51 @@
+#ifndef BLE_STREAM_H
+#define BLE_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// BLE peripheral streaming packed sample batches next to the Classic SPP client
+// (needs CONFIG_BTDM_CTRL_MODE_BTDM=y: the controller must run both radios)
+#ifndef BLE_STREAM_ENABLED
+#define BLE_STREAM_ENABLED              0
+#endif
+#define BLE_STREAM_DEVICE_NAME          "RPM_TRIGGER"
+#define BLE_STREAM_LOCAL_MTU            517     // Offered on connect; batch size follows the agreed MTU
+#define BLE_STREAM_NOTIFY_INTERVAL_MS   50      // One coalesced notification per interval
+#define BLE_STREAM_MAX_NOTIFY_PER_TICK  2       // Extra notifications when a batch overflows
+#define BLE_STREAM_CONN_INTERVAL_MIN    24      // 30 ms (1.25 ms units): leaves airtime to the SPP link
+#define BLE_STREAM_CONN_INTERVAL_MAX    40      // 50 ms
+#define BLE_STREAM_REPORT_INTERVAL_MS   30000
+
+// 128-bit UUIDs (little endian as sent over the air)
+#define BLE_STREAM_SERVICE_UUID  {0x6e, 0x40, 0x8a, 0x1f, 0x3c, 0x5d, 0x4b, 0x9e, \
+                                  0x9a, 0x61, 0x2e, 0x7b, 0x01, 0x00, 0x3a, 0x52}
+#define BLE_STREAM_BATCH_UUID    {0x6e, 0x40, 0x8a, 0x1f, 0x3c, 0x5d, 0x4b, 0x9e, \
+                                  0x9a, 0x61, 0x2e, 0x7b, 0x02, 0x00, 0x3a, 0x52}
+
+// Notification payload: header followed by count samples (little endian)
+typedef struct __attribute__((packed)) {
+    uint16_t seq;           // Increments per notification (gaps = lost notifications)
+    uint8_t count;          // Samples that follow
+    uint8_t dropped;        // Stream samples overwritten before they could be sent (saturates)
+    uint32_t base_us;       // Low 32 bits of the first sample's esp_timer timestamp
+} ble_batch_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t offset_100us;  // Time since base_us in 100 us units
+    uint8_t pid;
+    uint8_t source;         // Adapter link index
+    int32_t value;
+} ble_batch_sample_t;
+
+#define BLE_STREAM_MAX_SAMPLES  ((BLE_STREAM_LOCAL_MTU - 3 - sizeof(ble_batch_header_t)) / sizeof(ble_batch_sample_t))
+
+// Function declarations
+void ble_stream_init(void);
+void ble_stream_task(void *pv);
+
+// SPP round trip of the primary link (receive path, O(1)); split by BLE activity
+void ble_stream_on_spp_rtt(uint32_t rtt_us);
+void ble_stream_log_report(void);
+
+#endif // BLE_STREAM_H 
\ No newline at end of file
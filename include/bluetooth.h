@@ -6,22 +6,25 @@
 #include "esp_gap_bt_api.h"
 #include "esp_spp_api.h"
 
-// Bluetooth connection states
-extern bool is_connected;
-extern bool is_connecting;
+// Discovery state (per-link connection state lives in elm327_links)
 extern bool is_searching;
-extern uint32_t spp_handle;
 
-// ELM327 target device
+// ELM327 target devices (primary, and secondary when ELM327_SECONDARY_ENABLED)
 #define ELM327_BT_ADDR {0x01, 0x23, 0x45, 0x67, 0x89, 0xBA}
+#define ELM327_BT_ADDR_2 {0x01, 0x23, 0x45, 0x67, 0x89, 0xBB}
 extern uint8_t target_elm327_bda[6];
+extern uint8_t secondary_elm327_bda[6];
 
 // Function declarations
 void bluetooth_init(void);
 void start_device_discovery(void);
 
+// Parked power state: radio off between probes
+void bluetooth_suspend(void);
+void bluetooth_resume(void);
+
 // Connection management
-void handle_connection_failure(void);
+void handle_connection_failure(uint8_t link_index);
 bool attempt_connection(uint8_t *bda, int scn);
 
 #endif // BLUETOOTH_H 
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef CAN_DISCOVERY_H
+#define CAN_DISCOVERY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Broadcast RPM discovery: sniff all frames (ATMA), poll 010C between monitor
+// windows, and fit every 8/16-bit field against the polled RPM. The best fit
+// is stored per vehicle and handed to the hybrid monitor.
+#ifndef CAN_DISCOVERY_ENABLED
+#define CAN_DISCOVERY_ENABLED           0
+#endif
+#define CAN_DISCOVERY_ON_NEW_VEHICLE    1       // Discover automatically when nothing is stored
+#define CAN_DISCOVERY_SNIFF_MS          2000    // ID survey before correlating
+#define CAN_DISCOVERY_WINDOW_MS         100     // Monitor time per 010C poll
+#define CAN_DISCOVERY_MAX_RUN_MS        60000   // Give up if RPM never varied enough
+#define CAN_DISCOVERY_MIN_SAMPLES       100     // Polled RPM values before fitting
+#define CAN_DISCOVERY_MIN_RPM_SPAN      800     // RPM range needed (rev the engine meanwhile)
+#define CAN_DISCOVERY_MAX_FRAME_AGE_MS  150     // Field value paired with a poll only if this fresh
+#define CAN_DISCOVERY_MIN_R_X1000       980     // Correlation needed to accept a field
+#define CAN_DISCOVERY_MAX_IDS           64      // Distinct IDs tracked while surveying
+#define CAN_DISCOVERY_MAX_CANDIDATES    24      // Busiest changing IDs correlated
+#define CAN_DISCOVERY_ATST              "0A"    // Poll reply timeout while discovering (40 ms)
+#define CAN_DISCOVERY_NVS_NAMESPACE     "candisc"
+#define CAN_DISCOVERY_RECORD_VERSION    1
+
+// Function declarations
+void can_discovery_init(void);
+
+// Polling task side (obd_task context: owns the primary link)
+void can_discovery_on_connect(void);    // Load the stored signal for the identified car
+bool can_discovery_pending(void);
+void can_discovery_request(void);
+void can_discovery_run(void);
+
+// Receive path (primary link lines); true if the line was consumed
+bool can_discovery_on_line(const char *line);
+
+#endif // CAN_DISCOVERY_H 
\ No newline at end of file
@@ -5,24 +5,115 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 
-// ELM327 state
-extern bool elm327_initialized;
+// Primary link ready (given once per primary adapter initialization)
 extern SemaphoreHandle_t connection_semaphore;
 
+// Adapter response timeout (AT ST value, hex x 4ms)
+#ifndef ELM327_ATST_VALUE
+#define ELM327_ATST_VALUE "32"
+#endif
+
 // RX Buffer for ELM327 responses
 #define RX_BUFFER_SIZE 384   /* multi-PID lines are longer */
-extern char rx_buffer[RX_BUFFER_SIZE];
-extern uint16_t rx_buffer_len;
+
+// Multi-frame reassembly ("00A" length line, then "0:", "1:", ... segment lines)
+#define SEGMENT_BUFFER_SIZE 256
+
+// Consecutive CAN ERROR / NO DATA replies before the poller backs off
+#define ELM327_BACKOFF_FAILURES   3
+#define ELM327_BACKOFF_MS         300
+
+// Longest wait for the previous command's prompt before sending anyway
+#define ELM327_PROMPT_TIMEOUT_MS  2000
+
+// Adapter links: the primary drives the trigger, the secondary (optional)
+// polls a disjoint PID set on its own RFCOMM channel
+#define ELM327_LINK_PRIMARY       0
+#define ELM327_LINK_SECONDARY     1
+#define ELM327_LINK_COUNT         2
+#ifndef ELM327_SECONDARY_ENABLED
+#define ELM327_SECONDARY_ENABLED  0     // 1 = also connect ELM327_BT_ADDR_2
+#endif
+
+// Cumulative link traffic and receive path cost
+typedef struct {
+    uint32_t tx_bytes;
+    uint32_t rx_bytes;
+    uint64_t rx_cycles;
+} elm327_link_counters_t;
+
+// Per-connection state (one per adapter)
+typedef struct {
+    uint8_t index;
+    uint32_t generation;                // Incremented per RFCOMM open
+    volatile bool connected;            // RFCOMM open
+    volatile bool connecting;           // Connect initiated, waiting for open
+    volatile bool initialized;          // AT setup complete
+    volatile bool ready;                // Prompt seen, next command may be sent
+    SemaphoreHandle_t prompt;           // Given with every ready (kept across resets)
+    volatile bool forwarding;           // Reply belongs to a proxied phone request
+    uint32_t handle;                    // SPP handle
+    
+    // Receive line assembly
+    char rx_buffer[RX_BUFFER_SIZE];
+    uint16_t rx_len;
+    bool discarding_line;               // Overlong line: drop until next terminator
+    
+    // Command tracking
+    char last_command[32];              // Echo filter for adapters that ignore ATE0
+    volatile int64_t command_sent_us;   // Round trip start (0 = none pending)
+    uint8_t consecutive_fail;
+    volatile bool backoff_requested;    // Set by the receive path, taken by the polling task
+    
+    // Timing of the line being handled (sample timestamps)
+    int64_t response_request_us;
+    int64_t response_rx_us;
+    elm327_link_counters_t counters;    // Kept across resets
+    
+    // ISO-TP reassembly
+    char segment_buffer[SEGMENT_BUFFER_SIZE];
+    uint16_t segment_buffer_len;
+    uint16_t segment_bytes;             // Payload bytes collected so far
+    uint16_t segment_expected;          // Payload bytes announced (0 = unknown)
+} elm327_link_t;
+
+extern elm327_link_t elm327_links[ELM327_LINK_COUNT];
+
+// Receive path cost budget per SPP chunk: BASE + PER_BYTE * len CPU cycles.
+// Every byte is touched a bounded number of times: once when buffered, and per
+// line a fixed set of linear scans (prefix checks, reassembly, tokenizing) over
+// at most RX_BUFFER_SIZE - 1 characters. Overlong lines are discarded, never
+// rescanned, so no input can make the BT callback superlinear.
+#define ELM327_RX_BUDGET_BASE_CYCLES      20000
+#define ELM327_RX_BUDGET_CYCLES_PER_BYTE  400
+#define ELM327_RX_SLOWEST_SAVE_BYTES      48    // Bytes kept from the slowest chunk
 
 // Function declarations
 void elm327_init_system(void);
 void send_obd_command(const char *cmd);
-void initialize_elm327(void);
-void initialize_elm327_task(void *pv);
+void initialize_elm327(elm327_link_t *link);
+void initialize_elm327_task(void *pv);     // pv: elm327_link_t * (NULL = primary)
 void process_received_data(const char *data, uint16_t len);
+void elm327_log_rx_stats(void);
 
-// ELM327 communication
+// ELM327 communication (primary link)
 esp_err_t elm327_send_command(const char *cmd);
 void elm327_handle_response(const char *response);
 
+// Per-link access (BT callbacks for all links run on the BTC task, so the
+// receive path is serialized across links)
+elm327_link_t *elm327_link_by_handle(uint32_t handle);
+bool elm327_link_is_up(uint8_t index);
+esp_err_t elm327_link_send(elm327_link_t *link, const char *cmd);
+bool elm327_link_wait_ready(elm327_link_t *link, TickType_t timeout);
+void elm327_link_receive(elm327_link_t *link, const char *data, uint16_t len);
+void elm327_link_reset(elm327_link_t *link);
+void elm327_link_opened(elm327_link_t *link, uint32_t handle);
+void elm327_link_abort(elm327_link_t *link);
+bool elm327_link_take_backoff(elm327_link_t *link);
+void elm327_link_get_counters(const elm327_link_t *link, elm327_link_counters_t *out);
+
+// Timing of the response currently being handled (request written, line received)
+void elm327_link_get_sample_times(const elm327_link_t *link, int64_t *request_us, int64_t *rx_us);
+
 #endif // ELM327_H 
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef ELM327_SIM_H
+#define ELM327_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Simulated adapter (replaces the Bluetooth link when enabled)
+#ifndef ELM327_SIM_ENABLED
+#define ELM327_SIM_ENABLED        0      // Set to 1 to run against the simulated ELM327 (test/host builds set it)
+#endif
+#define ELM327_SIM_HANDLE         1      // Fake SPP handle of the primary link (secondary +1)
+#define ELM327_SIM_SEED           0x5EED1234u
+#define ELM327_SIM_VIN            "1G1JC5444R7252367"  // Mode 09 PID 02 reply
+
+// Adapter timing model (scheduler ticks, jitter from the seeded PRNG)
+#define ELM327_SIM_LATENCY_MS     40     // Base request -> prompt latency
+#define ELM327_SIM_JITTER_MS      20     // Uniform jitter added to the base latency
+
+// Request/reply split of the latency: the ECU samples the vehicle model
+// ELM327_SIM_ECU_SHARE_PCT into the round trip (request on the bus)
+#define ELM327_SIM_ECU_SHARE_PCT  50
+
+// Mode 01 replies: after the last ECU frame the adapter keeps listening for
+// further ECUs. AT AT0 waits the full AT ST; AT AT1/AT2 (power-on AT1) learn
+// the ECU response time and wait a share of it, capped by AT ST. A trailing
+// response-count digit ("010C1") returns as soon as that many frames arrived.
+#define ELM327_SIM_DEFAULT_ST_MS  200    // ELM327 power-on AT ST (0x32 x 4 ms)
+#define ELM327_SIM_AT1_WAIT_PCT   50     // AT AT1: listen window as a share of the learned response time
+#define ELM327_SIM_AT2_WAIT_PCT   25     // AT AT2: more aggressive
+#define ELM327_SIM_AT_MIN_WAIT_MS 8      // Adaptive window floor
+
+// CAN bus behind the adapter: the ECU answers from 7E8; monitor mode (ATMA)
+// shows the broadcast frames below, one output chunk per scheduler tick.
+// ELM327_SIM_RPM_CAN_ID carries the engine speed in bytes 0-1, big endian,
+// 0.25 rpm per bit (like PID 0C)
+#define ELM327_SIM_ECU_CAN_ID     0x7E8
+#define ELM327_SIM_RPM_CAN_ID     0x3D9
+#define ELM327_SIM_RPM_PERIOD_MS  20
+#define ELM327_SIM_STOP_MS        5      // Interrupt character to STOPPED
+
+// Injectable adapter/link faults
+typedef enum {
+    ELM327_SIM_FAULT_NONE = 0,
+    ELM327_SIM_FAULT_LINK_CLOSE,    // RFCOMM drops (ESP_SPP_CLOSE_EVT path) until reopened
+    ELM327_SIM_FAULT_HANG,          // Adapter swallows requests, no reply or prompt
+    ELM327_SIM_FAULT_NO_DATA,       // ECU silent: every Mode 01 request answers NO DATA
+    ELM327_SIM_FAULT_COUNT
+} elm327_sim_fault_t;
+
+// Function declarations
+void elm327_sim_start(void);
+esp_err_t elm327_sim_write(uint8_t index, const uint8_t *data, uint16_t len);
+
+// Ground truth from the vehicle model (esp_timer time base, 0 = none yet)
+int64_t elm327_sim_last_sample_us(void);     // When the last reply's values were sampled
+int64_t elm327_sim_crossing_us(void);        // Last rising crossing of LAUNCH_RPM_LIMIT
+
+// Fault injection (HANG/NO_DATA clear after duration_ms; LINK_CLOSE until reopened)
+void elm327_sim_inject_fault(elm327_sim_fault_t fault, uint32_t duration_ms);
+void elm327_sim_link_reopen(void);
+void elm327_sim_link_close(void);           // Host-side close (radio off)
+
+// Restart the vehicle model and jitter sequence (no request may be in flight)
+void elm327_sim_reset_model(void);
+
+#endif // ELM327_SIM_H 
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef FREEZE_FRAME_H
+#define FREEZE_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Capture window around each output activation
+#define FREEZE_PRE_MS                5000   // Keep this much history before the trigger
+#define FREEZE_POST_MS               2000   // Keep recording this long after the trigger
+
+// Storage sizes
+#define FREEZE_RING_SIZE             256    // Rolling sample ring (power of two)
+#define FREEZE_MAX_CAPTURE_SAMPLES   128    // Max samples per stored capture (< RING_SIZE / 2)
+#define FREEZE_NVS_SLOTS             4      // Captures kept in flash (oldest overwritten)
+#define FREEZE_NVS_NAMESPACE         "freeze"
+
+// One decoded sample in the ring
+typedef struct {
+    uint32_t time_ms;          // esp_timer time in ms
+    uint16_t rpm;
+    uint8_t throttle_position;
+    uint8_t vehicle_speed;
+    int8_t timing_advance;
+    uint8_t launch_state;      // launch_state_t at sample time
+    int16_t coolant_temp;
+} freeze_sample_t;
+
+// Header stored in front of the samples of each capture
+typedef struct {
+    uint32_t capture_id;       // Monotonic capture number
+    uint32_t trigger_ms;       // esp_timer time of the output activation
+    uint16_t sample_count;     // Samples following this header
+    uint16_t trigger_offset;   // Index of the first sample at/after the trigger
+} freeze_capture_header_t;
+
+// Function declarations
+void freeze_frame_init(void);
+void freeze_frame_task(void *pv);
+
+// Hot path: O(1), no copying, no blocking
+void freeze_frame_record_sample(void);
+void freeze_frame_trigger(void);
+
+#endif // FREEZE_FRAME_H 
\ No newline at end of file
@@ -22,4 +22,9 @@ void led_pulse(int duration_ms);
 void led_on(void);
 void led_off(void);
 
+// Generic output/input pins (used by output logic such as launch control)
+void gpio_output_init(gpio_num_t pin);
+void gpio_input_init(gpio_num_t pin, bool pull_up);
+void gpio_output_set(gpio_num_t pin, bool active);
+
 #endif // GPIO_CONTROL_H 
\ No newline at end of file
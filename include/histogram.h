@@ -0,0 +1,31 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+// Fixed-width bucket histogram; the last bucket collects overflow
+#define HISTOGRAM_BUCKETS 128
+
+typedef struct {
+    uint32_t bucket_width;               // Value range per bucket
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+} histogram_t;
+
+// Function declarations
+void histogram_init(histogram_t *h, uint32_t bucket_width);
+void histogram_record(histogram_t *h, uint32_t value);
+uint32_t histogram_percentile(const histogram_t *h, uint32_t percent);
+
+// Log one table row: label | n | p50 | p95 | p99 | max
+void histogram_log_header(const char *tag, const char *unit);
+void histogram_log_row(const char *tag, const char *label, const histogram_t *h);
+
+// Log the p50/p99 shift of a loaded distribution against its baseline (same
+// bucket width); warns when the median moved by more than one bucket
+void histogram_log_shift(const char *tag, const char *label, const histogram_t *base,
+                         const histogram_t *loaded, const char *unit);
+
+#endif // HISTOGRAM_H 
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef HYBRID_MONITOR_H
+#define HYBRID_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "power_manager.h"
+
+// Hybrid acquisition: RPM from a broadcast CAN frame in monitor mode (ATMA),
+// slow channels polled in short gaps where the monitor is interrupted
+#ifndef HYBRID_MONITOR_ENABLED
+#define HYBRID_MONITOR_ENABLED      0
+#endif
+#define HYBRID_MONITOR_WINDOW_MS    250     // Monitor time between polled gaps (minimum)
+#define HYBRID_MONITOR_WINDOW_MAX_MS 600    // Upper bound, keeps polled channels fresh
+#define HYBRID_MONITOR_MAX_OFF_PCT  35      // Window grows until the gaps stay below this share
+#define HYBRID_MONITOR_STOP_TIMEOUT_MS 200  // Wait for STOPPED after the interrupt character
+#define HYBRID_MONITOR_SILENT_WINDOWS 4     // Windows without the frame before falling back to polling
+#define HYBRID_MONITOR_PROXY_BUDGET_MS 100  // Phone request time per gap (normal profile)
+#define HYBRID_MONITOR_ATST         "0A"    // Poll reply timeout while hybrid (40 ms)
+#define HYBRID_MONITOR_BUCKET_MS    5       // Gap histogram resolution
+
+// Broadcast RPM signal (0 = none configured; hybrid stays off until one is set)
+#ifndef HYBRID_RPM_CAN_ID
+#define HYBRID_RPM_CAN_ID           0x000
+#endif
+#define HYBRID_RPM_START_BYTE       0
+#define HYBRID_RPM_WIDTH            16      // 8 or 16 bits
+#define HYBRID_RPM_LITTLE_ENDIAN    false
+#ifndef HYBRID_RPM_SCALE
+#define HYBRID_RPM_SCALE            1.0f    // rpm = raw * scale + offset
+#endif
+#define HYBRID_RPM_OFFSET           0.0f
+
+// Location and scaling of a value in a broadcast frame
+typedef struct {
+    uint32_t can_id;            // 11-bit or 29-bit identifier
+    uint8_t start_byte;
+    uint8_t width;              // 8 or 16 bits
+    bool little_endian;
+    float scale;
+    float offset;
+} broadcast_signal_t;
+
+// Function declarations
+void hybrid_monitor_init(void);
+void hybrid_monitor_set_signal(const broadcast_signal_t *signal);   // NULL = none
+
+// Polling task side (obd_task context: owns the primary link)
+bool hybrid_monitor_wanted(power_state_t power_state);
+void hybrid_monitor_cycle(bool voltage_due);   // One monitor window plus one polled gap
+void hybrid_monitor_disengage(void);           // Stop monitoring, restore polling settings
+void hybrid_monitor_log_report(void);
+
+// Receive path (primary link lines); true if the line was consumed
+bool hybrid_monitor_on_line(const char *line);
+
+#endif // HYBRID_MONITOR_H 
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef LAUNCH_CONTROL_H
+#define LAUNCH_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gpio.h"
+
+// Launch control pins
+#define LAUNCH_OUTPUT_PIN   GPIO_NUM_25   // Rev-limiter output (HIGH = cut active)
+#define LAUNCH_CLUTCH_PIN   GPIO_NUM_26   // Clutch switch input (active LOW)
+#define LAUNCH_BUTTON_PIN   GPIO_NUM_27   // Launch button input (active LOW)
+#define LAUNCH_NITROUS_PIN  GPIO_NUM_13   // Nitrous solenoid output (HIGH = spraying)
+
+// Launch control parameters
+#define LAUNCH_RPM_LIMIT          4000   // Output turns on at/above this RPM
+#define LAUNCH_RPM_HYSTERESIS     200    // Output turns off below LIMIT - HYSTERESIS
+#define LAUNCH_DISARM_SPEED_KMH   5      // Disarm once the car moves faster than this
+#define LAUNCH_ARMED_TIMEOUT_MS   30000  // Disarm if staged longer than this
+
+// Speed exit: while staged, speed is polled often enough that a launching
+// car is seen past LAUNCH_DISARM_SPEED_KMH at most LAUNCH_SPEED_EXIT_SLIP_KMH
+// late, accelerating at LAUNCH_MAX_ACCEL_KMH_S
+#define LAUNCH_MAX_ACCEL_KMH_S    40     // About 1.1 g
+#define LAUNCH_SPEED_EXIT_SLIP_KMH 25
+#define LAUNCH_SPEED_POLL_MS      (LAUNCH_SPEED_EXIT_SLIP_KMH * 1000 / LAUNCH_MAX_ACCEL_KMH_S)
+
+// Nitrous activation. Needs the analog interlock (bottle pressure, AFR);
+// the rev limiter above never depends on it
+#define NITROUS_MIN_RPM           3000   // Spray only at/above this RPM
+#define NITROUS_MIN_THROTTLE      90     // ... and at/above this throttle (%)
+
+// Transition log size (power of two)
+#define LAUNCH_TRANSITION_LOG_SIZE 32
+
+// Launch control states
+typedef enum {
+    LAUNCH_STATE_IDLE = 0,   // Not staged, output off
+    LAUNCH_STATE_ARMED,      // Staged, RPM below window, output off
+    LAUNCH_STATE_LIMITING    // Staged, RPM in/above window, output on
+} launch_state_t;
+
+// Why a transition happened
+typedef enum {
+    LAUNCH_REASON_ARM_INPUT = 0,   // Clutch/button pressed at standstill
+    LAUNCH_REASON_RPM_HIGH,        // RPM reached the limit
+    LAUNCH_REASON_RPM_LOW,         // RPM dropped below limit - hysteresis
+    LAUNCH_REASON_SPEED,           // Car started moving
+    LAUNCH_REASON_TIMEOUT,         // Staged too long
+    LAUNCH_REASON_RESET            // Link lost / forced reset
+} launch_reason_t;
+
+// Time-stamped transition record
+typedef struct {
+    int64_t timestamp_us;          // esp_timer time of the transition
+    launch_state_t from;
+    launch_state_t to;
+    launch_reason_t reason;
+    uint32_t rpm;                  // RPM sample that caused the transition
+    uint8_t speed;                 // Speed sample that caused the transition
+} launch_transition_t;
+
+// Function declarations
+void launch_control_init(void);
+void launch_control_evaluate(void);
+void launch_control_reset(void);
+launch_state_t launch_control_get_state(void);
+bool launch_control_is_armed(void);
+bool launch_control_nitrous_active(void);
+
+// Transition log (drained outside the hot path)
+void launch_control_log_transitions(void);
+
+#endif // LAUNCH_CONTROL_H 
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef LINK_POLICY_H
+#define LINK_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_gap_bt_api.h"
+
+// ACL poll interval per policy (in 625us baseband slots)
+#define LINK_TPOLL_LOW_LATENCY   ESP_BT_GAP_TPOLL_MIN
+#define LINK_TPOLL_POWER_SAVE    ESP_BT_GAP_TPOLL_DFT
+
+// RTT statistics report period
+#define LINK_STATS_LOG_INTERVAL_MS  10000
+
+// Link policies
+typedef enum {
+    LINK_POLICY_POWER_SAVE = 0,   // Modem sleep allowed, default poll interval
+    LINK_POLICY_LOW_LATENCY,      // Modem sleep off, minimum poll interval
+    LINK_POLICY_COUNT
+} link_policy_t;
+
+// Command round-trip statistics (command sent -> '>' prompt)
+typedef struct {
+    uint32_t count;
+    uint64_t total_us;
+    uint32_t min_us;
+    uint32_t max_us;
+} link_rtt_stats_t;
+
+// Function declarations
+void link_policy_init(void);
+void link_policy_set(link_policy_t policy);
+link_policy_t link_policy_get(void);
+
+// Link events (from Bluetooth callbacks)
+void link_policy_on_connected(const uint8_t *bda);
+void link_policy_on_disconnected(void);
+void link_policy_on_mode_change(esp_bt_pm_mode_t mode);
+
+// RTT measurement
+void link_policy_record_rtt(uint32_t rtt_us);
+void link_policy_log_stats(void);
+
+#endif // LINK_POLICY_H 
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef LOGGING_CONFIG_H
 #define LOGGING_CONFIG_H
 
+#include <stdint.h>
+
 // Logging control flags - Set to 1 to enable, 0 to disable
 #define ENABLE_VERBOSE_LOGGING    0  // Detailed status messages
 #define ENABLE_DEBUG_LOGGING      0  // Debug and trace messages  
@@ -8,6 +10,7 @@
 #define ENABLE_BLUETOOTH_LOGGING  0  // Detailed Bluetooth protocol logs
 #define ENABLE_ELM327_LOGGING     0  // Detailed ELM327 communication logs
 #define ENABLE_ESP_BT_LOGS        0  // ESP-IDF Bluetooth stack logs (BT_RFCOMM, BT_L2CAP, etc.)
+#define ENABLE_ELM327_TRACE       0  // Raw adapter TX/RX bytes in replayable trace form
 
 // Conditional logging macros
 #if ENABLE_VERBOSE_LOGGING
@@ -48,4 +51,7 @@
 // ESP-IDF Bluetooth stack log control function
 void configure_esp_bt_logging(void);
 
+// Raw adapter trace: "TRACE <ms> <TX|RX> <hex bytes>" (no-op unless ENABLE_ELM327_TRACE)
+void log_trace_bytes(const char *direction, const uint8_t *data, uint16_t len);
+
 #endif // LOGGING_CONFIG_H 
\ No newline at end of file
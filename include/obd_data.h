@@ -2,23 +2,74 @@
 #define OBD_DATA_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 // Vehicle data structure
 typedef struct {
     uint32_t rpm;
     uint8_t throttle_position;  // 0-100%
     uint8_t vehicle_speed;      // km/h
+    int8_t timing_advance;      // degrees before TDC (polled when armed)
+    int16_t coolant_temp;       // °C (polled when armed)
+    uint16_t bottle_pressure_psi;   // Analog: nitrous bottle pressure
+    uint16_t afr_x10;               // Analog: wideband AFR x10
+    bool analog_interlock_ok;       // Analog channels within activation limits
 } vehicle_data_t;
 
-// Global vehicle data
+// Request mode at startup (the CAN error fallback switches to single PIDs at runtime)
+#ifndef OBD_INDIVIDUAL_PIDS
+#define OBD_INDIVIDUAL_PIDS     0       // test/host latency sweeps set it
+#endif
+#define OBD_STATS_LOG_INTERVAL_MS 30000 // Receive-path/acquisition tables
+
+// Polling profiles
+typedef enum {
+    OBD_PROFILE_NORMAL = 0,     // Balanced RPM/throttle/speed polling
+    OBD_PROFILE_ARMED           // RPM/throttle/safety PIDs at max rate, speed at its floor
+} obd_poll_profile_t;
+
+// Global vehicle data (windowed statistics per channel: vehicle_stats, rolling_stats.h)
 extern vehicle_data_t vehicle_data;
 
+// Merged channel stream: decoded values from every adapter link that pass
+// their channel's publish policy (publish_policy.h)
+#define OBD_STREAM_LEN 64
+
+typedef struct {
+    int64_t timestamp_us;   // Line received (esp_timer)
+    int32_t value;          // Decoded value (RPM, km/h, %, degrees, °C)
+    uint8_t pid;
+    uint8_t source;         // Adapter link index
+} obd_sample_t;
+
 // Function declarations
 void obd_data_init(void);
 void obd_task(void *pv);
+void obd_secondary_task(void *pv);
 
-// Multi-PID response parsing
+// Polling profile control (switch applies on the next request slot)
+void obd_set_poll_profile(obd_poll_profile_t profile);
+obd_poll_profile_t obd_get_poll_profile(void);
+
+// Channel publication (shared by OBD and pulse inputs)
+void vehicle_data_publish_rpm(uint32_t rpm);
+void vehicle_data_publish_speed(uint8_t speed);
+void vehicle_data_publish_throttle(uint8_t throttle);
+void vehicle_data_publish_timing(int8_t timing);
+void vehicle_data_publish_coolant(int16_t coolant);
+
+// RPM decoded from a broadcast frame (monitor mode, primary link)
+void obd_data_on_broadcast_rpm(uint32_t rpm, int64_t rx_us);
+
+// Time since a polled channel (PID 0C, 0D, 11, 0E, 05) was last updated (UINT32_MAX = unknown)
+uint32_t vehicle_data_age_ms(uint8_t pid);
+
+// Multi-PID response parsing (parse_multi_pid_line: primary link)
 void parse_multi_pid_line(char *line);
+void obd_data_parse_line(uint8_t source, char *line);
+
+// Merged stream reader; returns false when *cursor has caught up
+bool obd_stream_read(uint32_t *cursor, obd_sample_t *out);
 
 // Data display
 void display_vehicle_data(void);
@@ -0,0 +1,55 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Battery voltage thresholds (from AT RV)
+#define POWER_CHARGING_MV          13200  // At/above: alternator charging, engine running
+#define POWER_VOLTAGE_DROP_MV      300    // Drop below running level that confirms engine off
+#define POWER_LOW_VOLTAGE_MV       12200  // Below: ignition off (ATLP-style low voltage)
+
+// State confirmation times
+#define POWER_ENGINE_OFF_CONFIRM_MS  5000   // RPM 0 this long before engine-off
+#define POWER_LINK_LOSS_MS           30000  // Link down this long before ignition-off
+
+// Polling slot period per state
+#ifndef POWER_SLOT_RUNNING_MS
+#define POWER_SLOT_RUNNING_MS       150     // test/host latency sweeps override it
+#endif
+#define POWER_SLOT_ENGINE_OFF_MS    1000
+#define POWER_SLOT_IGNITION_OFF_MS  60000   // Parked: radio off and light sleep between probes
+
+// Parked wake-up: time for Bluetooth to find, reopen and initialize the
+// adapter (about 15 s of AT setup) before the probe is given up and the
+// radio goes off again
+#define POWER_PARKED_RECONNECT_MS   30000
+
+// AT RV polling period per state (ignition-off probes AT RV and RPM on every wake-up)
+#define POWER_VOLTAGE_POLL_RUNNING_MS       5000
+#define POWER_VOLTAGE_POLL_ENGINE_OFF_MS    3000
+#define POWER_VOLTAGE_POLL_IGNITION_OFF_MS  POWER_SLOT_IGNITION_OFF_MS
+
+// CPU frequency limits for dynamic frequency scaling
+#define POWER_MAX_CPU_FREQ_MHZ  240
+#define POWER_MIN_CPU_FREQ_MHZ  40
+
+// Power states
+typedef enum {
+    POWER_STATE_ENGINE_RUNNING = 0,  // Full-rate polling, CPU locked at max frequency
+    POWER_STATE_ENGINE_OFF,          // Ignition on, engine stopped: slow polling
+    POWER_STATE_IGNITION_OFF         // Parked: radio off, light sleep, periodic voltage/RPM probe
+} power_state_t;
+
+// Function declarations
+void power_manager_init(void);
+void power_manager_update(bool link_up);
+void power_manager_update_voltage(uint32_t millivolts);
+
+// Current state and derived polling parameters
+power_state_t power_manager_get_state(void);
+uint32_t power_manager_get_voltage_mv(void);
+uint32_t power_manager_slot_ms(void);
+uint32_t power_manager_voltage_poll_ms(void);
+
+#endif // POWER_MANAGER_H 
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef PUBLISH_POLICY_H
+#define PUBLISH_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Per-channel filter between the decoders and the merged sample stream:
+// consumers (telemetry, dashboard, recording) only see meaningful changes.
+// vehicle_data and the output logic still take every sample.
+#define PUBLISH_POLICY_ENABLED      1
+#define PUBLISH_HEARTBEAT_MS        1000    // Longest silence per channel while samples arrive
+#define PUBLISH_RPM_DEADBAND        25      // rpm
+#define PUBLISH_THROTTLE_DEADBAND   1       // %
+
+typedef enum {
+    PUBLISH_ALWAYS = 0,         // Every sample
+    PUBLISH_ON_CHANGE,          // Value differs from the last published one
+    PUBLISH_DEADBAND            // Value left +/- deadband around the last published one
+} publish_mode_t;
+
+typedef struct {
+    uint8_t pid;
+    publish_mode_t mode;
+    int32_t deadband;           // PUBLISH_DEADBAND only
+    uint32_t heartbeat_ms;      // Publish anyway after this long (0 = never)
+} publish_policy_t;
+
+// Function declarations
+void publish_policy_init(void);
+bool publish_policy_admit(uint8_t pid, int32_t value, int64_t timestamp_us);    // Hot path
+void publish_policy_log_stats(void);
+
+#endif // PUBLISH_POLICY_H 
\ No newline at end of file
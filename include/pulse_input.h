@@ -0,0 +1,37 @@
+#ifndef PULSE_INPUT_H
+#define PULSE_INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gpio.h"
+
+// Pulse input pins (signals conditioned to 3.3V logic)
+#define PULSE_TACH_PIN          GPIO_NUM_34   // Tach signal
+#define PULSE_VSS_PIN           GPIO_NUM_35   // Vehicle speed sensor
+
+// Signal scaling
+#define PULSE_TACH_PER_REV      2      // Tach pulses per crank revolution
+#define PULSE_VSS_PER_KM        2485   // VSS pulses per km travelled
+
+// Frequency measurement
+#define PULSE_SAMPLE_PERIOD_MS  10     // Counter sampling period
+#define PULSE_WINDOW_MAX_MS     500    // Longest sliding window (sets lowest measurable rate)
+#define PULSE_WINDOW_MIN_COUNT  12     // Shrink window to the newest span holding this many pulses
+#define PULSE_GLITCH_NS         1000   // Hardware glitch filter
+
+// OBD fusion (OBD calibrates and checks plausibility, pulses provide latency)
+#define PULSE_PLAUSIBLE_PCT       20   // Max deviation from the OBD value
+#define PULSE_RPM_COMPARE_MIN     400  // Only compare RPM above this
+#define PULSE_SPEED_COMPARE_MIN   5    // Only compare speed above this (km/h)
+#define PULSE_TRUST_COUNT         3    // Consecutive (dis)agreements to change trust
+#define PULSE_CAL_GAIN            0.05f  // Calibration EMA gain per agreeing OBD sample
+#define PULSE_LOSS_PERIODS        4    // Missing pulse intervals (at the OBD rate) before trust drops
+
+// Function declarations
+void pulse_input_init(void);
+
+// Fusion hooks called for each OBD sample; true if pulses own the channel
+bool pulse_input_fuse_rpm(uint32_t obd_rpm);
+bool pulse_input_fuse_speed(uint8_t obd_speed);
+
+#endif // PULSE_INPUT_H 
\ No newline at end of file
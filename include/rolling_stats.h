@@ -0,0 +1,55 @@
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pulse_input.h"
+
+// Time-windowed min/max/mean per published channel, amortized O(1) per sample:
+// monotonic deques for min/max, a running sum for the mean
+#define ROLLING_STATS_ENABLED       1
+
+// Window per channel
+#define ROLLING_WINDOW_RPM_MS       300
+#define ROLLING_WINDOW_THROTTLE_MS  200
+#define ROLLING_WINDOW_SPEED_MS     1000
+
+// Fastest publisher per channel: pulse input samples RPM and speed every
+// PULSE_SAMPLE_PERIOD_MS, throttle only comes from prompt-paced OBD replies
+#define ROLLING_OBD_REPLY_MIN_MS    10      // Request plus reply at 38400 baud, fast ECU
+#define ROLLING_PERIOD_RPM_MS       PULSE_SAMPLE_PERIOD_MS
+#define ROLLING_PERIOD_THROTTLE_MS  ROLLING_OBD_REPLY_MIN_MS
+#define ROLLING_PERIOD_SPEED_MS     PULSE_SAMPLE_PERIOD_MS
+
+// Samples per channel (power of two, at least window / period + 1); oldest
+// dropped early when full, counted as an overflow
+#define ROLLING_CAPACITY_RPM        32
+#define ROLLING_CAPACITY_THROTTLE   32
+#define ROLLING_CAPACITY_SPEED      128
+
+typedef enum {
+    ROLLING_CH_RPM = 0,
+    ROLLING_CH_THROTTLE,
+    ROLLING_CH_SPEED,
+    ROLLING_CH_COUNT
+} rolling_channel_t;
+
+// Statistics over the samples inside the window
+typedef struct {
+    int32_t min;
+    int32_t max;
+    int32_t mean;           // Sample mean
+    uint16_t count;         // 0 = no sample within the window
+    uint32_t span_ms;       // Oldest to newest sample: "held for W ms" needs span near W
+} rolling_stats_t;
+
+// Latest statistics per channel (updated with every published sample)
+extern rolling_stats_t vehicle_stats[ROLLING_CH_COUNT];
+
+// Function declarations
+void rolling_stats_init(void);
+void rolling_stats_push(rolling_channel_t channel, int32_t value);     // Hot path, any task
+void rolling_stats_get(rolling_channel_t channel, rolling_stats_t *out);   // Expires old samples first
+void rolling_stats_log(void);
+
+#endif // ROLLING_STATS_H 
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef SOAK_TEST_H
+#define SOAK_TEST_H
+
+#include <stdint.h>
+#include "histogram.h"
+
+// Long-running fault injection against the simulated adapter
+#ifndef SOAK_TEST_ENABLED
+#define SOAK_TEST_ENABLED           0       // Requires ELM327_SIM_ENABLED (test/host builds set it)
+#endif
+#define SOAK_TEST_SEED              0xC0FFEE01u
+
+// Fault schedule (uniformly random within each range)
+#define SOAK_HEALTHY_MIN_MS         20000   // Healthy time between faults
+#define SOAK_HEALTHY_MAX_MS         60000
+#define SOAK_LINK_DOWN_MIN_MS       500     // Link closed before reopening
+#define SOAK_LINK_DOWN_MAX_MS       10000
+#define SOAK_HANG_MIN_MS            500
+#define SOAK_HANG_MAX_MS            8000
+#define SOAK_NO_DATA_MIN_MS         500
+#define SOAK_NO_DATA_MAX_MS         10000
+
+// Recovery measurement
+#define SOAK_RECOVERY_TIMEOUT_MS    120000  // No sample by then = failed recovery
+#define SOAK_SETTLE_MS              5000    // After recovery, before resource check
+#define SOAK_RECOVERY_BUCKET_MS     1000    // Time-to-first-sample resolution (buckets cover the timeout)
+#define SOAK_MAX_SAMPLE_RATE_HZ     50      // Upper bound on the healthy sample rate
+
+// Longest outage that still counts as a recovery (every fault maximum is <= SOAK_LINK_DOWN_MAX_MS)
+#define SOAK_MAX_OUTAGE_MS          (SOAK_LINK_DOWN_MAX_MS + SOAK_RECOVERY_TIMEOUT_MS)
+
+// Lost-sample buckets sized so the worst recorded outage still fits in the histogram
+#define SOAK_LOST_BUCKET_SAMPLES    ((SOAK_MAX_OUTAGE_MS / 1000 * SOAK_MAX_SAMPLE_RATE_HZ + HISTOGRAM_BUCKETS - 2) / (HISTOGRAM_BUCKETS - 1))
+#define SOAK_REPORT_INTERVAL_MS     300000
+
+// Function declarations
+void soak_test_task(void *pv);
+
+// Parser hook: one decoded OBD sample
+void soak_test_on_sample(void);
+
+#endif // SOAK_TEST_H 
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef SPP_PROXY_H
+#define SPP_PROXY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "elm327.h"
+
+// SPP server that impersonates an ELM327 for a phone app. The phone must pair
+// first (authenticated, encrypted link); only read-only requests (Mode 01 and
+// Mode 09) reach the bus, anything else is answered "?"
+#ifndef SPP_PROXY_ENABLED
+#define SPP_PROXY_ENABLED           0
+#endif
+#define SPP_PROXY_SERVER_NAME       "OBDII"
+#define SPP_PROXY_DEVICE_NAME       "OBDII"
+#define SPP_PROXY_CACHE_MAX_AGE_MS  500     // Polled PIDs answered from cache when fresher
+#define SPP_PROXY_FORWARD_MIN_MS    60      // Slot time left needed to forward a request
+#define SPP_PROXY_SLOT_MARGIN_MS    10      // Kept free before our next own request
+#define SPP_PROXY_CMD_MAX           32
+#define SPP_PROXY_MAX_PIDS          6       // PIDs per forwarded Mode 01 request (ELM327 limit)
+#define SPP_PROXY_PIN               "1234"  // Legacy pairing PIN (phones without SSP)
+#define SPP_PROXY_REPLY_MAX         256
+
+// Function declarations
+void spp_proxy_start_server(void);
+
+// SPP events for the phone connection (BTC task)
+bool spp_proxy_owns(uint32_t handle);
+void spp_proxy_on_open(uint32_t handle);
+void spp_proxy_on_close(void);
+void spp_proxy_on_data(const uint8_t *data, uint16_t len);
+
+// Forwarding onto an adapter link in the idle part of a polling slot;
+// returns the ticks spent so the caller keeps its slot period
+TickType_t spp_proxy_service_slot(elm327_link_t *link, uint32_t budget_ms);
+bool spp_proxy_forward_pending(void);
+
+// Adapter replies to a forwarded request (receive path)
+void spp_proxy_on_adapter_line(const char *line);
+void spp_proxy_on_adapter_prompt(void);
+
+#endif // SPP_PROXY_H 
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef STRATEGY_BENCH_H
+#define STRATEGY_BENCH_H
+
+#include <stdint.h>
+
+// Acquisition strategy comparison (runs instead of obd_task, simulator only)
+#ifndef STRATEGY_BENCH_ENABLED
+#define STRATEGY_BENCH_ENABLED      0       // Requires ELM327_SIM_ENABLED (test/host builds set it)
+#endif
+#define STRATEGY_BENCH_RUN_MS       30000   // Measurement time per variant
+#define STRATEGY_BENCH_SETTLE_MS    500     // Drain replies between variants
+#define STRATEGY_BENCH_AGE_BUCKET_US 5000   // Value age histogram resolution
+
+// One polling variant under test
+typedef struct {
+    const char *name;
+    const char *const *commands;    // Request cycle
+    uint8_t length;
+    uint32_t slot_ms;               // Delay after each request (0 = next request on prompt)
+    const char *atst;               // AT ST value for the run
+} strategy_variant_t;
+
+// Function declarations
+void strategy_bench_task(void *pv);
+
+// Parser hook: one decoded PID value (no-op unless a run is active)
+void strategy_bench_on_pid(uint8_t pid);
+
+#endif // STRATEGY_BENCH_H 
\ No newline at end of file
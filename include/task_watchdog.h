@@ -0,0 +1,57 @@
+#ifndef TASK_WATCHDOG_H
+#define TASK_WATCHDOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Per-task heartbeat deadlines; each app task is a task watchdog (TWDT) user
+// that is only fed while the task keeps its own deadline. Not watched: the
+// test-only tasks (elm327_sim, strategy_bench, soak_test), which only exist
+// in builds against the simulated adapter
+#define TASK_WATCHDOG_ENABLED           1
+#define TASK_WATCHDOG_CHECK_MS          50      // Monitor period (deadline resolution)
+#define TASK_WATCHDOG_REPORT_INTERVAL_MS 60000
+#define TASK_WATCHDOG_USAGE_BUCKET_PCT  2       // Histogram of beat gap as % of deadline
+
+// Slack added to the wait a task announces with each beat
+#define TASK_WATCHDOG_SLACK_OBD_MS      250     // Command send, parsing, proxy forwarding
+#define TASK_WATCHDOG_SLACK_ANALOG_MS   100
+#define TASK_WATCHDOG_SLACK_FREEZE_MS   1000    // NVS write of a capture
+#define TASK_WATCHDOG_SLACK_LED_MS      200
+#define TASK_WATCHDOG_SLACK_STREAM_MS   200     // Notification / WebSocket queueing and reports
+#define TASK_WATCHDOG_SLACK_CONSOLE_MS  500     // Command handling (tuner requests, NVS clear)
+#define TASK_WATCHDOG_SLACK_INIT_MS     2500    // Command send: up to 2 s for the previous prompt
+#define TASK_WATCHDOG_SECTION_BTC_MS    100     // Longest acceptable Bluetooth callback
+
+// Watched tasks
+typedef enum {
+    WDT_TASK_OBD = 0,
+    WDT_TASK_OBD_SECONDARY,
+    WDT_TASK_ANALOG,
+    WDT_TASK_FREEZE,
+    WDT_TASK_LED,
+    WDT_TASK_BLE_STREAM,
+    WDT_TASK_DASHBOARD,
+    WDT_TASK_CONSOLE,
+    WDT_TASK_ELM327_INIT,       // One-shot initialization task per link
+    WDT_TASK_ELM327_INIT_SECONDARY,
+    WDT_TASK_BTC,               // SPP/GAP callbacks (Bluedroid's task, watched per callback)
+    WDT_TASK_COUNT
+} task_watchdog_id_t;
+
+// Function declarations
+void task_watchdog_init(void);
+void task_watchdog_task(void *pv);
+
+// Periodic tasks: heartbeat with the state being entered and the time until
+// the next beat (deadline = expect_ms + the task's slack)
+void task_watchdog_beat(task_watchdog_id_t id, const char *state, uint32_t expect_ms);
+
+// Callback sections: deadline only applies between enter and leave. A
+// one-shot task also calls leave before it deletes itself
+void task_watchdog_enter(task_watchdog_id_t id, const char *state, int32_t detail);
+void task_watchdog_leave(task_watchdog_id_t id);
+
+void task_watchdog_log_report(void);
+
+#endif // TASK_WATCHDOG_H 
\ No newline at end of file
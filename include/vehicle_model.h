@@ -0,0 +1,63 @@
+#ifndef VEHICLE_MODEL_H
+#define VEHICLE_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Parametric vehicle model driving the simulated ECU
+#define VEHICLE_MODEL_STEP_US         5000    // Fixed integration step (5 ms)
+
+// Engine
+#define VEHICLE_IDLE_RPM              800
+#define VEHICLE_REV_LIMIT_RPM         6800    // Fuel cut
+#define VEHICLE_REV_LIMIT_RESUME_RPM  6600    // Fuel restored below this
+#define VEHICLE_FREE_REV_TAU_MS       250     // Unloaded RPM time constant
+#define VEHICLE_THROTTLE_RATE_PCT_S   800     // Throttle body slew rate
+
+// Driveline
+#define VEHICLE_GEAR_COUNT            5
+#define VEHICLE_FINAL_DRIVE_X100      342
+#define VEHICLE_TIRE_CIRCUMFERENCE_MM 1950
+#define VEHICLE_MAX_ACCEL_MS2         9.0f    // First gear, full throttle, at the tires
+#define VEHICLE_DRAG_COEFF            0.0004f // Aero drag (m/s^2 per (m/s)^2)
+#define VEHICLE_BRAKE_DECEL_MS2       6.0f
+#define VEHICLE_CLUTCH_SLIP_MS        600     // Launch clutch engagement time
+
+// Driver script
+#define VEHICLE_IDLE_TIME_MS          8000
+#define VEHICLE_STAGE_TIME_MS         4000
+#define VEHICLE_STAGE_RPM             4500    // Two-step: held above the launch limit (LAUNCH_RPM_LIMIT) while staged
+#define VEHICLE_SHIFT_RPM             6500
+#define VEHICLE_SHIFT_TIME_MS         300     // Throttle lifted, clutch in
+#define VEHICLE_PULL_END_KMH          180
+#define VEHICLE_COAST_TIME_MS         6000
+
+// Driver phases
+typedef enum {
+    VEHICLE_PHASE_IDLE = 0,
+    VEHICLE_PHASE_STAGE,
+    VEHICLE_PHASE_LAUNCH,
+    VEHICLE_PHASE_SHIFT,
+    VEHICLE_PHASE_COAST,
+    VEHICLE_PHASE_BRAKE
+} vehicle_phase_t;
+
+// Instantaneous model state (ground truth)
+typedef struct {
+    int64_t time_us;
+    float rpm;
+    float speed_kmh;
+    float throttle_pct;
+    uint8_t gear;               // 0 = neutral / clutch in
+    vehicle_phase_t phase;
+} vehicle_model_state_t;
+
+// Function declarations
+void vehicle_model_init(int64_t start_us, uint32_t watch_rpm);
+void vehicle_model_advance_to(int64_t time_us);
+const vehicle_model_state_t *vehicle_model_state(void);
+
+// Ground truth: time of the most recent rising crossing of watch_rpm (0 = none yet)
+int64_t vehicle_model_last_crossing_us(void);
+
+#endif // VEHICLE_MODEL_H 
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef WIFI_DASHBOARD_H
+#define WIFI_DASHBOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Soft-AP with a static dashboard page and a WebSocket pushing channel deltas
+// (needs CONFIG_HTTPD_WS_SUPPORT=y; Wi-Fi plus Bluetooth outgrow the 1 MB app
+// partition, so select CONFIG_PARTITION_TABLE_SINGLE_APP_LARGE=y with it)
+#ifndef WIFI_DASHBOARD_ENABLED
+#define WIFI_DASHBOARD_ENABLED          0
+#endif
+#define WIFI_DASHBOARD_SSID             "RPM_TRIGGER"
+#define WIFI_DASHBOARD_PASSWORD         "launch1234"    // WPA2, at least 8 characters
+#define WIFI_DASHBOARD_CHANNEL          1
+#define WIFI_DASHBOARD_MAX_STATIONS     2
+#define WIFI_DASHBOARD_MAX_CLIENTS      2       // Open WebSocket sessions
+#define WIFI_DASHBOARD_PUSH_INTERVAL_MS 100     // Delta frame rate
+#define WIFI_DASHBOARD_KEYFRAME_EVERY   50      // Full frame every N frames (resync after drops)
+#define WIFI_DASHBOARD_MAX_INFLIGHT     2       // Queued frames per client before dropping
+#define WIFI_DASHBOARD_REPORT_INTERVAL_MS 30000
+
+// Dashboard channels
+typedef enum {
+    DASH_CH_RPM = 0,
+    DASH_CH_THROTTLE,
+    DASH_CH_SPEED,
+    DASH_CH_TIMING,
+    DASH_CH_COOLANT,
+    DASH_CH_BOTTLE_PSI,
+    DASH_CH_AFR_X10,
+    DASH_CH_INTERLOCK,
+    DASH_CH_LAUNCH_STATE,
+    DASH_CH_BATTERY_MV,
+    DASH_CH_COUNT
+} dash_channel_t;
+
+// Binary frame: header followed by count entries (little endian)
+#define DASH_FRAME_KEY      0   // Every channel
+#define DASH_FRAME_DELTA    1   // Only channels changed since the client's last queued frame
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;
+    uint8_t count;
+    uint16_t seq;
+} dash_frame_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t channel;
+    int32_t value;
+} dash_frame_entry_t;
+
+// Function declarations
+void wifi_dashboard_init(void);
+void wifi_dashboard_task(void *pv);
+
+// SPP round trip of the primary link (receive path, O(1)); split by Wi-Fi activity
+void wifi_dashboard_on_spp_rtt(uint32_t rtt_us);
+void wifi_dashboard_log_report(void);
+
+#endif // WIFI_DASHBOARD_H 
\ No newline at end of file
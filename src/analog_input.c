@@ -0,0 +1,181 @@
+#include "esp_log.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "logging_config.h"
+#include "analog_input.h"
+#include "obd_data.h"
+#include "launch_control.h"
+#include "task_watchdog.h"
+
+static const char *TAG = "ANALOG";
+
+static adc_continuous_handle_t adc_handle = NULL;
+static adc_cali_handle_t cali_handle = NULL;
+static TaskHandle_t analog_task_handle = NULL;
+static volatile bool sampling = false;
+static uint8_t frame_buffer[ANALOG_FRAME_BYTES];
+
+// DMA frame complete (ISR): wake the decimation task
+static bool IRAM_ATTR on_conv_done(adc_continuous_handle_t handle,
+                                   const adc_continuous_evt_data_t *edata, void *user_data) {
+    BaseType_t must_yield = pdFALSE;
+    if (analog_task_handle != NULL) {
+        vTaskNotifyGiveFromISR(analog_task_handle, &must_yield);
+    }
+    return must_yield == pdTRUE;
+}
+
+// Averaged raw reading -> sensor-side millivolts (before the divider)
+static int raw_to_sensor_mv(int raw) {
+    int adc_mv = 0;
+    if (cali_handle == NULL || adc_cali_raw_to_voltage(cali_handle, raw, &adc_mv) != ESP_OK) {
+        adc_mv = raw * 3100 / 4095;  // Uncalibrated approximation
+    }
+    return adc_mv * ANALOG_DIVIDER_RATIO_X1000 / 1000;
+}
+
+// Convert decimated channel values and evaluate the interlock (O(1) per sample)
+static void publish(int pressure_mv, int afr_mv) {
+    int span = pressure_mv - ANALOG_PRESSURE_MV_MIN;
+    if (span < 0) {
+        span = 0;
+    }
+    uint32_t psi = (uint32_t)span * ANALOG_PRESSURE_PSI_MAX /
+                   (ANALOG_PRESSURE_MV_MAX - ANALOG_PRESSURE_MV_MIN);
+    uint32_t afr_x10 = ANALOG_AFR_X10_AT_0V +
+        (uint32_t)afr_mv * (ANALOG_AFR_X10_AT_5V - ANALOG_AFR_X10_AT_0V) / 5000;
+    
+    bool sensors_ok = pressure_mv >= ANALOG_SENSOR_FAULT_MV && afr_mv >= ANALOG_SENSOR_FAULT_MV;
+    
+    vehicle_data.bottle_pressure_psi = (uint16_t)psi;
+    vehicle_data.afr_x10 = (uint16_t)afr_x10;
+    vehicle_data.analog_interlock_ok = sensors_ok &&
+        psi >= ANALOG_PRESSURE_MIN_PSI && psi <= ANALOG_PRESSURE_MAX_PSI &&
+        afr_x10 <= ANALOG_AFR_LEAN_LIMIT_X10;
+}
+
+// Initialize continuous ADC sampling on the analog interlock channels
+void analog_input_init(void) {
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = ANALOG_POOL_BYTES,
+        .conv_frame_size = ANALOG_FRAME_BYTES
+    };
+    esp_err_t ret = adc_continuous_new_handle(&handle_config, &adc_handle);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to create ADC handle: %s", esp_err_to_name(ret));
+        adc_handle = NULL;
+        return;
+    }
+    
+    adc_digi_pattern_config_t pattern[2] = {
+        {
+            .atten = ANALOG_ATTEN,
+            .channel = ANALOG_PRESSURE_CHANNEL,
+            .unit = ADC_UNIT_1,
+            .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH
+        },
+        {
+            .atten = ANALOG_ATTEN,
+            .channel = ANALOG_AFR_CHANNEL,
+            .unit = ADC_UNIT_1,
+            .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH
+        }
+    };
+    adc_continuous_config_t adc_config = {
+        .pattern_num = 2,
+        .adc_pattern = pattern,
+        .sample_freq_hz = ANALOG_SAMPLE_FREQ_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1
+    };
+    ret = adc_continuous_config(adc_handle, &adc_config);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to configure ADC: %s", esp_err_to_name(ret));
+        adc_handle = NULL;
+        return;
+    }
+    
+    adc_cali_line_fitting_config_t cali_config = {
+        .unit_id = ADC_UNIT_1,
+        .atten = ANALOG_ATTEN,
+        .bitwidth = ADC_BITWIDTH_12
+    };
+    if (adc_cali_create_scheme_line_fitting(&cali_config, &cali_handle) != ESP_OK) {
+        LOG_WARN(TAG, "ADC calibration unavailable - using uncalibrated readings");
+        cali_handle = NULL;
+    }
+    
+    adc_continuous_evt_cbs_t callbacks = {
+        .on_conv_done = on_conv_done
+    };
+    adc_continuous_register_event_callbacks(adc_handle, &callbacks, NULL);
+    
+    LOG_VERBOSE(TAG, "Analog inputs initialized (%d Hz, %d-byte frames)",
+                ANALOG_SAMPLE_FREQ_HZ, ANALOG_FRAME_BYTES);
+}
+
+// Decimation task: averages each DMA frame per channel and publishes one sample
+void analog_input_task(void *pv) {
+    if (adc_handle == NULL) {
+        LOG_WARN(TAG, "ADC not initialized - analog interlocks disabled");
+        vTaskDelete(NULL);
+        return;
+    }
+    
+    analog_task_handle = xTaskGetCurrentTaskHandle();
+    adc_continuous_start(adc_handle);
+    sampling = true;
+    
+    while (1) {
+        task_watchdog_beat(WDT_TASK_ANALOG, "adc_wait", ANALOG_READ_TIMEOUT_MS);
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ANALOG_READ_TIMEOUT_MS)) == 0) {
+            vehicle_data.analog_interlock_ok = false;  // No data: fail safe
+            launch_control_evaluate();
+            continue;
+        }
+        
+        // Drain every complete frame queued since the last wake-up
+        uint32_t length = 0;
+        while (adc_continuous_read(adc_handle, frame_buffer, sizeof(frame_buffer), &length, 0) == ESP_OK) {
+            uint32_t pressure_sum = 0, pressure_n = 0;
+            uint32_t afr_sum = 0, afr_n = 0;
+            
+            for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+                const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&frame_buffer[i];
+                if (p->type1.channel == ANALOG_PRESSURE_CHANNEL) {
+                    pressure_sum += p->type1.data;
+                    pressure_n++;
+                } else if (p->type1.channel == ANALOG_AFR_CHANNEL) {
+                    afr_sum += p->type1.data;
+                    afr_n++;
+                }
+            }
+            
+            if (pressure_n > 0 && afr_n > 0) {
+                publish(raw_to_sensor_mv(pressure_sum / pressure_n),
+                        raw_to_sensor_mv(afr_sum / afr_n));
+                launch_control_evaluate();  // Nitrous output follows the interlock
+            }
+        }
+    }
+}
+
+// Stop conversions while parked: the running ADC holds a PM lock that keeps
+// the chip out of light sleep (the interlock reads as off meanwhile)
+void analog_input_suspend(void) {
+    if (sampling) {
+        sampling = false;
+        adc_continuous_stop(adc_handle);
+    }
+}
+
+void analog_input_resume(void) {
+    if (!sampling && analog_task_handle != NULL) {
+        adc_continuous_start(adc_handle);
+        sampling = true;
+    }
+}
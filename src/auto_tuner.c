@@ -0,0 +1,376 @@
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "logging_config.h"
+#include "auto_tuner.h"
+#include "elm327.h"
+#include "obd_data.h"
+#include "power_manager.h"
+#include "task_watchdog.h"
+#include "can_discovery.h"
+
+static const char *TAG = "TUNER";
+
+// Candidate request cycles
+static const char *const alternate_cmds[] = { "010C11", "010D" };
+static const char *const batch_cmds[] = { "010C110D" };
+static const char *const rpm_biased_cmds[] = { "010C11", "010C11", "010C0D" };
+static const char *const single_cmds[] = { "010C", "0111", "010D" };
+
+// Candidates; the first is the built-in default
+static const tuner_strategy_t strategies[] = {
+    { "multi 010C11/010D @150",  alternate_cmds,  2, POWER_SLOT_RUNNING_MS, ELM327_ATST_VALUE, false },
+    { "multi @100",              alternate_cmds,  2, 100, ELM327_ATST_VALUE, false },
+    { "multi @50",               alternate_cmds,  2, 50,  ELM327_ATST_VALUE, false },
+    { "multi on prompt",         alternate_cmds,  2, 0,   ELM327_ATST_VALUE, false },
+    { "multi on prompt ATST 19", alternate_cmds,  2, 0,   "19",              false },
+    { "multi on prompt ATST 0A", alternate_cmds,  2, 0,   "0A",              false },
+    { "batch 010C110D on prompt", batch_cmds,     1, 0,   ELM327_ATST_VALUE, false },
+    { "rpm-biased on prompt",    rpm_biased_cmds, 3, 0,   ELM327_ATST_VALUE, false },
+    { "single PIDs @150",        single_cmds,     3, POWER_SLOT_RUNNING_MS, ELM327_ATST_VALUE, true },
+    { "single PIDs on prompt",   single_cmds,     3, 0,   ELM327_ATST_VALUE, true },
+};
+#define STRATEGY_COUNT (sizeof(strategies) / sizeof(strategies[0]))
+
+// Stored per vehicle
+typedef struct {
+    uint8_t table_version;
+    uint8_t strategy;
+    char vin[AUTO_TUNER_VIN_LEN + 1];
+    uint32_t score;
+} tuner_record_t;
+
+static const tuner_strategy_t *active = &strategies[0];
+static volatile bool tune_pending = false;
+static volatile bool clear_pending = false;
+
+// Current vehicle
+static char vin[AUTO_TUNER_VIN_LEN + 1];
+static uint8_t vin_len = 0;
+static volatile bool vin_complete = false;
+
+// Measurement window (written from the receive path)
+static volatile bool run_active = false;
+static volatile uint32_t rpm_samples = 0;
+static volatile uint32_t throttle_samples = 0;
+static volatile uint32_t speed_samples = 0;
+static volatile uint32_t errors = 0;
+
+void auto_tuner_init(void) {
+    active = &strategies[0];
+    tune_pending = false;
+    vin_len = 0;
+    vin_complete = false;
+    LOG_VERBOSE(TAG, "Auto tuner initialized (%d candidates)", (int)STRATEGY_COUNT);
+}
+
+const tuner_strategy_t *auto_tuner_active(void) {
+    return active;
+}
+
+bool auto_tuner_pending(void) {
+    return tune_pending;
+}
+
+void auto_tuner_request(void) {
+    tune_pending = true;
+}
+
+// Parser hooks
+void auto_tuner_on_pid(uint8_t source, uint8_t pid) {
+    if (!run_active || source != ELM327_LINK_PRIMARY) {
+        return;
+    }
+    switch (pid) {
+        case 0x0C: rpm_samples++; break;
+        case 0x11: throttle_samples++; break;
+        case 0x0D: speed_samples++; break;
+        default: break;
+    }
+}
+
+void auto_tuner_on_error(void) {
+    if (run_active) {
+        errors++;
+    }
+}
+
+// "49 02 <n> <bytes...>": one reassembled CAN reply or one line per 4 bytes
+// on older protocols; the VIN is the printable bytes in order
+void auto_tuner_on_vin_line(const char *line) {
+    const char *p = line + 6;   // Past "49 02 "
+    int token = 0;
+
+    while (*p && vin_len < AUTO_TUNER_VIN_LEN) {
+        while (*p == ' ') {
+            p++;
+        }
+        if (!p[0] || !p[1]) {
+            break;
+        }
+        char hex[3] = { p[0], p[1], '\0' };
+        char c = (char)strtol(hex, NULL, 16);
+        p += 2;
+        if (token++ == 0) {
+            continue;   // Message / line counter
+        }
+        if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z')) {
+            vin[vin_len++] = c;
+        }
+    }
+    vin[vin_len] = '\0';
+    if (vin_len == AUTO_TUNER_VIN_LEN) {
+        vin_complete = true;
+    }
+}
+
+// NVS key for a VIN (15 character limit): FNV-1a hash
+static void record_key(const char *id, char *key, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (const char *c = id; *c; c++) {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    snprintf(key, size, "v%08lx", hash);
+}
+
+static bool load_record(const char *id, tuner_record_t *record) {
+    char key[16];
+    nvs_handle_t nvs;
+    size_t size = sizeof(*record);
+
+    record_key(id, key, sizeof(key));
+    if (nvs_open(AUTO_TUNER_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(nvs, key, record, &size);
+    nvs_close(nvs);
+    return ret == ESP_OK && size == sizeof(*record) &&
+           record->table_version == AUTO_TUNER_TABLE_VERSION &&
+           record->strategy < STRATEGY_COUNT && strcmp(record->vin, id) == 0;
+}
+
+static void store_record(const tuner_record_t *record) {
+    char key[16];
+    nvs_handle_t nvs;
+
+    record_key(record->vin, key, sizeof(key));
+    esp_err_t ret = nvs_open(AUTO_TUNER_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "NVS open failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    ret = nvs_set_blob(nvs, key, record, sizeof(*record));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to store tuning for %s: %s", record->vin, esp_err_to_name(ret));
+    }
+}
+
+static void erase_record(const char *id) {
+    char key[16];
+    nvs_handle_t nvs;
+
+    record_key(id, key, sizeof(key));
+    if (nvs_open(AUTO_TUNER_NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_erase_key(nvs, key);
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+}
+
+// Switch strategy: the adapter timeout is the only adapter-side setting
+static void apply(const tuner_strategy_t *strategy) {
+    char atst_cmd[16];
+    snprintf(atst_cmd, sizeof(atst_cmd), "AT ST %s", strategy->atst);
+    elm327_send_command(atst_cmd);
+    active = strategy;
+}
+
+// Vehicle identity, "NOVIN" when the ECU does not report one
+static const char *vehicle_id(void) {
+    return vin_complete ? vin : "NOVIN";
+}
+
+const char *auto_tuner_vehicle_id(void) {
+    return vehicle_id();
+}
+
+// NVS key for the current vehicle (shared by modules storing per-vehicle results)
+void auto_tuner_vehicle_key(char *key, size_t size) {
+    record_key(vehicle_id(), key, size);
+}
+
+// New primary connection: identify the car (mode 09 PID 02)
+void auto_tuner_read_vin(void) {
+    vin_len = 0;
+    vin_complete = false;
+    elm327_send_command("0902");
+    task_watchdog_beat(WDT_TASK_OBD, "read_vin", AUTO_TUNER_VIN_TIMEOUT_MS);
+    TickType_t start = xTaskGetTickCount();
+    while (!vin_complete && (xTaskGetTickCount() - start) < pdMS_TO_TICKS(AUTO_TUNER_VIN_TIMEOUT_MS)) {
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    if (vin_complete) {
+        LOG_INFO(TAG, "VIN %s", vin);
+    } else {
+        LOG_WARN(TAG, "No VIN from ECU, using the shared NOVIN profile");
+    }
+}
+
+// Pick the stored strategy for the identified car
+void auto_tuner_on_connect(void) {
+    tuner_record_t record;
+
+    if (load_record(vehicle_id(), &record)) {
+        apply(&strategies[record.strategy]);
+        LOG_INFO(TAG, "Stored strategy for %s: %s (score %lu)", vehicle_id(), active->name, record.score);
+    } else {
+        apply(&strategies[0]);
+        if (AUTO_TUNER_ON_NEW_VIN) {
+            LOG_INFO(TAG, "No stored strategy for %s, tuning once the ECU is awake", vehicle_id());
+            tune_pending = true;
+        }
+    }
+}
+
+// Run one candidate; returns its score (0 = rejected)
+static uint32_t measure(const tuner_strategy_t *s) {
+    uint32_t requests = 0;
+    uint8_t phase = 0;
+
+    apply(s);
+    vTaskDelay(pdMS_TO_TICKS(AUTO_TUNER_SETTLE_MS));
+
+    rpm_samples = 0;
+    throttle_samples = 0;
+    speed_samples = 0;
+    errors = 0;
+    TickType_t start = xTaskGetTickCount();
+    run_active = true;
+
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(AUTO_TUNER_RUN_MS)) {
+        task_watchdog_beat(WDT_TASK_OBD, "tuning", s->slot_ms + 2000);  // Prompt wait bound
+        if (elm327_send_command(s->commands[phase]) == ESP_OK) {
+            requests++;
+        }
+        phase = (phase + 1) % s->length;
+        if (s->slot_ms > 0) {
+            vTaskDelay(pdMS_TO_TICKS(s->slot_ms));
+        }
+        if (obd_get_poll_profile() != OBD_PROFILE_NORMAL || !elm327_link_is_up(ELM327_LINK_PRIMARY)) {
+            break;
+        }
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(AUTO_TUNER_SETTLE_MS));
+    run_active = false;
+    uint32_t elapsed_ms = pdTICKS_TO_MS(xTaskGetTickCount() - start);
+
+    uint32_t rpm_x10 = rpm_samples * 10000 / elapsed_ms;
+    uint32_t thr_x10 = throttle_samples * 10000 / elapsed_ms;
+    uint32_t spd_x10 = speed_samples * 10000 / elapsed_ms;
+    uint32_t error_pct = requests > 0 ? errors * 100 / requests : 100;
+    uint32_t score = rpm_x10 * AUTO_TUNER_WEIGHT_RPM + thr_x10 * AUTO_TUNER_WEIGHT_THROTTLE +
+                     spd_x10 * AUTO_TUNER_WEIGHT_SPEED;
+    bool rejected = error_pct > AUTO_TUNER_MAX_ERROR_PCT;
+
+    LOG_INFO(TAG, "%-26s | rpm %3lu.%lu/s | thr %3lu.%lu/s | spd %3lu.%lu/s | err %2lu%% | score %5lu%s",
+             s->name, rpm_x10 / 10, rpm_x10 % 10, thr_x10 / 10, thr_x10 % 10,
+             spd_x10 / 10, spd_x10 % 10, error_pct, score, rejected ? " (rejected)" : "");
+    if (rejected || rpm_x10 < AUTO_TUNER_MIN_RPM_X10) {
+        return 0;
+    }
+    return score;
+}
+
+// Benchmark every candidate on the live link and keep the fastest
+// (obd_task context, normal profile only: aborts if the trigger arms)
+void auto_tuner_run(void) {
+    const tuner_strategy_t *previous = active;
+    uint32_t best_score = 0;
+    int best = -1;
+
+    tune_pending = false;
+    if (clear_pending) {
+        erase_record(vehicle_id());
+        clear_pending = false;
+    }
+    LOG_INFO(TAG, "Tuning %s: %d candidates x %d ms", vehicle_id(), (int)STRATEGY_COUNT, AUTO_TUNER_RUN_MS);
+
+    for (size_t i = 0; i < STRATEGY_COUNT; i++) {
+        uint32_t score = measure(&strategies[i]);
+        if (obd_get_poll_profile() != OBD_PROFILE_NORMAL || !elm327_link_is_up(ELM327_LINK_PRIMARY)) {
+            LOG_WARN(TAG, "Tuning aborted (trigger armed or link lost), keeping %s", previous->name);
+            apply(previous);
+            return;
+        }
+        if (score > best_score) {
+            best_score = score;
+            best = (int)i;
+        }
+    }
+
+    if (best < 0) {
+        LOG_WARN(TAG, "No candidate produced usable data, keeping %s", previous->name);
+        apply(previous);
+        return;
+    }
+
+    apply(&strategies[best]);
+    tuner_record_t record = {0};
+    record.table_version = AUTO_TUNER_TABLE_VERSION;
+    record.strategy = (uint8_t)best;
+    record.score = best_score;
+    snprintf(record.vin, sizeof(record.vin), "%s", vehicle_id());
+    store_record(&record);
+    LOG_INFO(TAG, "Best strategy for %s: %s (score %lu)", record.vin, active->name, best_score);
+}
+
+// Minimal line console on stdin
+void auto_tuner_console_task(void *pv) {
+    char line[32];
+    uint8_t len = 0;
+
+    while (1) {
+        task_watchdog_beat(WDT_TASK_CONSOLE, "stdin_poll", 100);
+        int c = fgetc(stdin);
+        if (c == EOF) {
+            clearerr(stdin);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        if (c != '\r' && c != '\n') {
+            if (len < sizeof(line) - 1) {
+                line[len++] = (char)c;
+            }
+            continue;
+        }
+        line[len] = '\0';
+        len = 0;
+
+        if (strcmp(line, "tune") == 0) {
+            LOG_INFO(TAG, "Tuning requested from console");
+            auto_tuner_request();
+        } else if (strcmp(line, "tune clear") == 0) {
+            LOG_INFO(TAG, "Forgetting stored strategy and re-tuning");
+            clear_pending = true;
+            auto_tuner_request();
+#if CAN_DISCOVERY_ENABLED
+        } else if (strcmp(line, "discover") == 0) {
+            LOG_INFO(TAG, "Broadcast RPM discovery requested from console");
+            can_discovery_request();
+#endif
+        } else if (line[0] != '\0') {
+            LOG_INFO(TAG, "Commands: tune, tune clear%s", CAN_DISCOVERY_ENABLED ? ", discover" : "");
+        }
+    }
+}
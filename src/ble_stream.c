@@ -0,0 +1,393 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_gap_ble_api.h"
+#include "esp_gatts_api.h"
+#include "esp_gatt_common_api.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+#include "logging_config.h"
+#include "ble_stream.h"
+#include "histogram.h"
+#include "obd_data.h"
+#include "task_watchdog.h"
+
+// sdkconfig.esp32dev ships BR/EDR only: with the stream enabled, replace
+// CONFIG_BTDM_CTRL_MODE_BR_EDR_ONLY=y by CONFIG_BTDM_CTRL_MODE_BTDM=y (menuconfig:
+// Component config > Bluetooth > Controller Options > Bluetooth controller mode)
+#if BLE_STREAM_ENABLED && !CONFIG_BTDM_CTRL_MODE_BTDM
+#error "BLE_STREAM_ENABLED needs the controller in dual mode (CONFIG_BTDM_CTRL_MODE_BTDM=y)"
+#endif
+
+static const char *TAG = "BLE_STREAM";
+
+#define BLE_STREAM_APP_ID   0x42
+// SPP RTT histogram: 128 x 5 ms covers 640 ms, past the adapter timeout
+// (AT ST 32 = 200 ms) plus a few BT retransmissions, so the p99 under
+// coexistence lands in a real bucket instead of the overflow bucket
+#define RTT_BUCKET_US       5000
+
+// Attribute table layout
+enum {
+    IDX_SVC,
+    IDX_BATCH_CHAR,
+    IDX_BATCH_VAL,
+    IDX_BATCH_CCCD,
+    IDX_COUNT
+};
+
+// SPP round trips split by what the BLE side was doing at the time
+typedef enum {
+    COEX_BLE_IDLE = 0,      // Advertising only
+    COEX_BLE_CONNECTED,     // Central connected, notifications off
+    COEX_BLE_STREAMING,     // Notifications flowing
+    COEX_STATE_COUNT
+} coex_state_t;
+
+static const char *coex_names[] = { "SPP RTT, BLE idle", "SPP RTT, BLE connected", "SPP RTT, BLE streaming" };
+
+static const uint16_t primary_service_uuid = ESP_GATT_UUID_PRI_SERVICE;
+static const uint16_t char_decl_uuid = ESP_GATT_UUID_CHAR_DECLARE;
+static const uint16_t cccd_uuid = ESP_GATT_UUID_CHAR_CLIENT_CONFIG;
+static const uint8_t char_prop_notify = ESP_GATT_CHAR_PROP_BIT_NOTIFY;
+static const uint8_t service_uuid[16] = BLE_STREAM_SERVICE_UUID;
+static const uint8_t batch_uuid[16] = BLE_STREAM_BATCH_UUID;
+static uint8_t cccd_value[2] = {0x00, 0x00};
+static uint8_t batch_value[1] = {0x00};
+
+static const esp_gatts_attr_db_t attr_table[IDX_COUNT] = {
+    [IDX_SVC] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&primary_service_uuid, ESP_GATT_PERM_READ,
+                  sizeof(service_uuid), sizeof(service_uuid), (uint8_t *)service_uuid}},
+    [IDX_BATCH_CHAR] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&char_decl_uuid, ESP_GATT_PERM_READ,
+                        sizeof(uint8_t), sizeof(uint8_t), (uint8_t *)&char_prop_notify}},
+    [IDX_BATCH_VAL] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_128, (uint8_t *)batch_uuid, ESP_GATT_PERM_READ,
+                       BLE_STREAM_LOCAL_MTU - 3, sizeof(batch_value), batch_value}},
+    [IDX_BATCH_CCCD] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&cccd_uuid,
+                        ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
+                        sizeof(cccd_value), sizeof(cccd_value), cccd_value}},
+};
+
+// Flags + complete 128-bit service UUID; the name goes in the scan response
+// (UUID and name are filled in at registration)
+static uint8_t adv_data[3 + 2 + 16] = {
+    0x02, ESP_BLE_AD_TYPE_FLAG, ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT,
+    0x11, ESP_BLE_AD_TYPE_128SRV_CMPL,
+};
+static uint8_t scan_rsp_data[2 + sizeof(BLE_STREAM_DEVICE_NAME) - 1] = {
+    sizeof(BLE_STREAM_DEVICE_NAME), ESP_BLE_AD_TYPE_NAME_CMPL,
+};
+
+// Slow advertising: the radio is shared with the SPP link
+static esp_ble_adv_params_t adv_params = {
+    .adv_int_min = 0x320,   // 500 ms
+    .adv_int_max = 0x640,   // 1 s
+    .adv_type = ADV_TYPE_IND,
+    .own_addr_type = BLE_ADDR_TYPE_PUBLIC,
+    .channel_map = ADV_CHNL_ALL,
+    .adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY,
+};
+static uint8_t adv_config_pending = 0;
+
+// Connection state (written from the BTC task)
+static esp_gatt_if_t stream_gatts_if = ESP_GATT_IF_NONE;
+static uint16_t handle_table[IDX_COUNT];
+static volatile bool connected = false;
+static volatile bool notify_enabled = false;
+static volatile bool congested = false;
+static uint16_t conn_id = 0;
+static volatile uint16_t peer_mtu = 23;
+
+// Counters
+static uint32_t notifications_sent = 0;
+static uint32_t samples_sent = 0;
+static uint32_t samples_dropped = 0;
+static uint32_t congested_ticks = 0;
+static uint32_t notify_errors = 0;
+
+// Coexistence histograms
+static portMUX_TYPE coex_lock = portMUX_INITIALIZER_UNLOCKED;
+static histogram_t spp_rtt[COEX_STATE_COUNT];
+
+static void start_advertising(void) {
+    esp_err_t ret = esp_ble_gap_start_advertising(&adv_params);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Advertising start failed: %s", esp_err_to_name(ret));
+    }
+}
+
+static void gap_ble_callback(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+    switch (event) {
+        case ESP_GAP_BLE_ADV_DATA_RAW_SET_COMPLETE_EVT:
+        case ESP_GAP_BLE_SCAN_RSP_DATA_RAW_SET_COMPLETE_EVT:
+            // Start once both payloads are configured
+            if (adv_config_pending > 0 && --adv_config_pending == 0) {
+                start_advertising();
+            }
+            break;
+
+        case ESP_GAP_BLE_ADV_START_COMPLETE_EVT:
+            if (param->adv_start_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+                LOG_ERROR(TAG, "Advertising failed to start: %d", param->adv_start_cmpl.status);
+            } else {
+                LOG_BT(TAG, "Advertising as %s", BLE_STREAM_DEVICE_NAME);
+            }
+            break;
+
+        case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT:
+            LOG_BT(TAG, "Connection params: interval=%d (1.25 ms) latency=%d timeout=%d",
+                   param->update_conn_params.conn_int, param->update_conn_params.latency,
+                   param->update_conn_params.timeout);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void gatts_callback(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param) {
+    switch (event) {
+        case ESP_GATTS_REG_EVT:
+            if (param->reg.status != ESP_GATT_OK) {
+                LOG_ERROR(TAG, "GATTS app register failed: %d", param->reg.status);
+                return;
+            }
+            stream_gatts_if = gatts_if;
+            memcpy(&adv_data[5], service_uuid, sizeof(service_uuid));
+            memcpy(&scan_rsp_data[2], BLE_STREAM_DEVICE_NAME, sizeof(BLE_STREAM_DEVICE_NAME) - 1);
+            adv_config_pending = 2;
+            esp_ble_gap_config_adv_data_raw(adv_data, sizeof(adv_data));
+            esp_ble_gap_config_scan_rsp_data_raw(scan_rsp_data, sizeof(scan_rsp_data));
+            esp_ble_gatts_create_attr_tab(attr_table, gatts_if, IDX_COUNT, 0);
+            break;
+
+        case ESP_GATTS_CREAT_ATTR_TAB_EVT:
+            if (param->add_attr_tab.status != ESP_GATT_OK || param->add_attr_tab.num_handle != IDX_COUNT) {
+                LOG_ERROR(TAG, "Attribute table create failed: %d", param->add_attr_tab.status);
+                return;
+            }
+            memcpy(handle_table, param->add_attr_tab.handles, sizeof(handle_table));
+            esp_ble_gatts_start_service(handle_table[IDX_SVC]);
+            break;
+
+        case ESP_GATTS_CONNECT_EVT: {
+            conn_id = param->connect.conn_id;
+            peer_mtu = 23;
+            congested = false;
+            connected = true;
+
+            // Long connection interval: batches make up for it, SPP keeps its airtime
+            esp_ble_conn_update_params_t conn_params = {0};
+            memcpy(conn_params.bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+            conn_params.min_int = BLE_STREAM_CONN_INTERVAL_MIN;
+            conn_params.max_int = BLE_STREAM_CONN_INTERVAL_MAX;
+            conn_params.latency = 0;
+            conn_params.timeout = 400;  // 4 s
+            esp_ble_gap_update_conn_params(&conn_params);
+            LOG_INFO(TAG, "Central connected (conn_id %d)", conn_id);
+            break;
+        }
+
+        case ESP_GATTS_DISCONNECT_EVT:
+            connected = false;
+            notify_enabled = false;
+            congested = false;
+            LOG_INFO(TAG, "Central disconnected (reason 0x%x)", param->disconnect.reason);
+            start_advertising();
+            break;
+
+        case ESP_GATTS_MTU_EVT:
+            peer_mtu = param->mtu.mtu;
+            LOG_INFO(TAG, "MTU %d: up to %d samples per notification", peer_mtu,
+                     (int)((peer_mtu - 3 - sizeof(ble_batch_header_t)) / sizeof(ble_batch_sample_t)));
+            break;
+
+        case ESP_GATTS_WRITE_EVT:
+            if (param->write.handle == handle_table[IDX_BATCH_CCCD] && param->write.len == 2) {
+                notify_enabled = (param->write.value[0] & 0x01) != 0;
+                LOG_INFO(TAG, "Batch notifications %s", notify_enabled ? "enabled" : "disabled");
+            }
+            break;
+
+        case ESP_GATTS_CONGEST_EVT:
+            congested = param->congest.congested;
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Register the GATT server (after Bluedroid is enabled)
+void ble_stream_init(void) {
+    for (int i = 0; i < COEX_STATE_COUNT; i++) {
+        histogram_init(&spp_rtt[i], RTT_BUCKET_US);
+    }
+
+    esp_err_t ret = esp_ble_gap_register_callback(gap_ble_callback);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "BLE GAP callback register failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    ret = esp_ble_gatts_register_callback(gatts_callback);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "GATTS callback register failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    ret = esp_ble_gatts_app_register(BLE_STREAM_APP_ID);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "GATTS app register failed: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    // Offered to the central; it decides whether to exchange MTU
+    ret = esp_ble_gatt_set_local_mtu(BLE_STREAM_LOCAL_MTU);
+    if (ret != ESP_OK) {
+        LOG_WARN(TAG, "Local MTU %d rejected: %s", BLE_STREAM_LOCAL_MTU, esp_err_to_name(ret));
+    }
+
+    LOG_VERBOSE(TAG, "BLE stream initialized");
+}
+
+// Record one SPP round trip under the current BLE activity
+void ble_stream_on_spp_rtt(uint32_t rtt_us) {
+    coex_state_t state = !connected ? COEX_BLE_IDLE :
+                         notify_enabled ? COEX_BLE_STREAMING : COEX_BLE_CONNECTED;
+    portENTER_CRITICAL(&coex_lock);
+    histogram_record(&spp_rtt[state], rtt_us);
+    portEXIT_CRITICAL(&coex_lock);
+}
+
+// Pack stream samples into one notification; returns the sample count
+static uint8_t build_batch(uint8_t *buffer, uint32_t *cursor, uint8_t max_samples,
+                           obd_sample_t *pending, bool *has_pending) {
+    ble_batch_header_t *header = (ble_batch_header_t *)buffer;
+    ble_batch_sample_t *samples = (ble_batch_sample_t *)(buffer + sizeof(ble_batch_header_t));
+    uint8_t count = 0;
+    uint32_t dropped = 0;
+    int64_t base_us = 0;
+
+    while (count < max_samples) {
+        obd_sample_t sample;
+        if (*has_pending) {
+            sample = *pending;
+            *has_pending = false;
+        } else {
+            uint32_t before = *cursor;
+            if (!obd_stream_read(cursor, &sample)) {
+                break;
+            }
+            dropped += *cursor - before - 1;
+        }
+
+        if (count == 0) {
+            base_us = sample.timestamp_us;
+        }
+        int64_t offset = (sample.timestamp_us - base_us) / 100;
+        if (offset > UINT16_MAX) {
+            // Too far from this batch's base: starts the next one
+            *pending = sample;
+            *has_pending = true;
+            break;
+        }
+
+        samples[count].offset_100us = (uint16_t)offset;
+        samples[count].pid = sample.pid;
+        samples[count].source = sample.source;
+        samples[count].value = sample.value;
+        count++;
+    }
+
+    samples_dropped += dropped;
+    header->count = count;
+    header->dropped = dropped > UINT8_MAX ? UINT8_MAX : (uint8_t)dropped;
+    header->base_us = (uint32_t)base_us;
+    return count;
+}
+
+// Coalesce stream samples and notify at a fixed rate
+void ble_stream_task(void *pv) {
+    uint8_t buffer[sizeof(ble_batch_header_t) + BLE_STREAM_MAX_SAMPLES * sizeof(ble_batch_sample_t)];
+    uint32_t cursor = 0;
+    obd_sample_t pending;
+    bool has_pending = false;
+    uint16_t seq = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t last_report = last_wake;
+
+    LOG_INFO(TAG, "BLE stream task started (notify every %d ms, up to %d samples per batch)",
+             BLE_STREAM_NOTIFY_INTERVAL_MS, (int)BLE_STREAM_MAX_SAMPLES);
+
+    while (1) {
+        task_watchdog_beat(WDT_TASK_BLE_STREAM, "notify_wait", BLE_STREAM_NOTIFY_INTERVAL_MS);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(BLE_STREAM_NOTIFY_INTERVAL_MS));
+
+        if (!connected || !notify_enabled) {
+            // Nobody listening: skip to the newest sample
+            obd_sample_t discard;
+            while (obd_stream_read(&cursor, &discard)) {
+            }
+            has_pending = false;
+        } else if (congested) {
+            // Stack buffers full: let the stream absorb it, drops are reported per batch
+            congested_ticks++;
+        } else {
+            uint16_t mtu = peer_mtu;
+            uint32_t fit = (mtu - 3 - sizeof(ble_batch_header_t)) / sizeof(ble_batch_sample_t);
+            uint8_t max_samples = fit < BLE_STREAM_MAX_SAMPLES ? (uint8_t)fit : (uint8_t)BLE_STREAM_MAX_SAMPLES;
+
+            for (int n = 0; n < BLE_STREAM_MAX_NOTIFY_PER_TICK && max_samples > 0; n++) {
+                uint8_t count = build_batch(buffer, &cursor, max_samples, &pending, &has_pending);
+                if (count == 0) {
+                    break;
+                }
+                ((ble_batch_header_t *)buffer)->seq = seq++;
+
+                uint16_t len = sizeof(ble_batch_header_t) + count * sizeof(ble_batch_sample_t);
+                esp_err_t ret = esp_ble_gatts_send_indicate(stream_gatts_if, conn_id, handle_table[IDX_BATCH_VAL],
+                                                            len, buffer, false);
+                if (ret != ESP_OK) {
+                    notify_errors++;
+                    break;
+                }
+                notifications_sent++;
+                samples_sent += count;
+                if (count < max_samples) {
+                    break;
+                }
+            }
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if ((now - last_report) >= pdMS_TO_TICKS(BLE_STREAM_REPORT_INTERVAL_MS)) {
+            ble_stream_log_report();
+            last_report = now;
+        }
+    }
+}
+
+// Notification counters and SPP RTT per BLE activity
+void ble_stream_log_report(void) {
+    static histogram_t snapshot[COEX_STATE_COUNT];
+
+    portENTER_CRITICAL(&coex_lock);
+    memcpy(snapshot, spp_rtt, sizeof(snapshot));
+    portEXIT_CRITICAL(&coex_lock);
+
+    LOG_INFO(TAG, "Notifications: %lu (%lu samples, %.1f/batch), dropped %lu, congested ticks %lu, errors %lu, MTU %d",
+             notifications_sent, samples_sent,
+             notifications_sent > 0 ? (float)samples_sent / notifications_sent : 0.0f,
+             samples_dropped, congested_ticks, notify_errors, peer_mtu);
+
+    histogram_log_header(TAG, "us");
+    for (int i = 0; i < COEX_STATE_COUNT; i++) {
+        if (snapshot[i].count > 0) {
+            histogram_log_row(TAG, coex_names[i], &snapshot[i]);
+        }
+    }
+
+    // Median shift of the SPP round trip caused by streaming
+    histogram_log_shift(TAG, "SPP RTT, streaming vs idle", &snapshot[COEX_BLE_IDLE],
+                        &snapshot[COEX_BLE_STREAMING], "us");
+}
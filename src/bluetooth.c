@@ -7,19 +7,91 @@
 #include "bluetooth.h"
 #include "elm327.h"
 #include "gpio_control.h"
+#include "link_policy.h"
+#include "spp_proxy.h"
+#include "ble_stream.h"
+#include "task_watchdog.h"
+#include "elm327_sim.h"
 
 static const char *TAG = "BLUETOOTH";
 
 // Global Bluetooth state variables
-bool is_connected = false;
-bool is_connecting = false;
 bool is_searching = false;
-uint32_t spp_handle = 0;
 uint8_t target_elm327_bda[6] = ELM327_BT_ADDR;
-static int connection_attempt = 0;
+uint8_t secondary_elm327_bda[6] = ELM327_BT_ADDR_2;
+static int connection_attempt[ELM327_LINK_COUNT] = { 0 };
+static volatile bool suspended = false;    // Radio off while parked (no reconnects)
+
+// Links with a connect issued but no CL_INIT yet, in call order (CL_INIT
+// events arrive in the same order; BTC task only, so no lock)
+static uint8_t pending_connect[ELM327_LINK_COUNT];
+static uint32_t pending_head = 0;
+static uint32_t pending_tail = 0;
+
+// Target address per adapter link
+static uint8_t *const link_bda[ELM327_LINK_COUNT] = { target_elm327_bda, secondary_elm327_bda };
+#define LINKS_WANTED (ELM327_SECONDARY_ENABLED ? ELM327_LINK_COUNT : 1)
+
+#if BLE_STREAM_ENABLED
+#define BT_CONTROLLER_MODE ESP_BT_MODE_BTDM
+#else
+#define BT_CONTROLLER_MODE ESP_BT_MODE_CLASSIC_BT
+#endif
+
+// Adapter link for a peer address (NULL = not one of ours)
+static elm327_link_t *link_by_bda(const uint8_t *bda) {
+    for (int i = 0; i < LINKS_WANTED; i++) {
+        if (memcmp(bda, link_bda[i], 6) == 0) {
+            return &elm327_links[i];
+        }
+    }
+    return NULL;
+}
+
+// Connect issued for a link: its CL_INIT event carries the handle
+static void connect_pending(elm327_link_t *link) {
+    link->handle = 0;   // Until CL_INIT, no close event is this attempt's
+    pending_connect[pending_head % ELM327_LINK_COUNT] = link->index;
+    pending_head++;
+}
+
+// Link the next CL_INIT event belongs to (NULL = none outstanding)
+static elm327_link_t *connect_initiated(void) {
+    if (pending_tail == pending_head) {
+        return NULL;
+    }
+    return &elm327_links[pending_connect[pending_tail++ % ELM327_LINK_COUNT]];
+}
+
+// Link a close event belongs to: open handle, else the handle of a pending
+// connect attempt
+static elm327_link_t *link_for_close(uint32_t handle) {
+    elm327_link_t *link = elm327_link_by_handle(handle);
+    if (link) {
+        return link;
+    }
+    for (int i = 0; i < LINKS_WANTED; i++) {
+        if (elm327_links[i].connecting && elm327_links[i].handle == handle) {
+            return &elm327_links[i];
+        }
+    }
+    return NULL;
+}
+
+// True while some wanted adapter still needs a connection
+static bool link_missing(void) {
+    for (int i = 0; i < LINKS_WANTED; i++) {
+        if (!elm327_links[i].connected && !elm327_links[i].connecting) {
+            return true;
+        }
+    }
+    return false;
+}
 
 // GAP callback for device discovery
 static void gap_callback(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *param) {
+    task_watchdog_enter(WDT_TASK_BTC, "gap_callback", event);
+    
     switch (event) {
         case ESP_BT_GAP_DISC_RES_EVT: {
             char addr_str[18];
@@ -27,17 +99,18 @@ static void gap_callback(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *par
                     param->disc_res.bda[0], param->disc_res.bda[1], param->disc_res.bda[2],
                     param->disc_res.bda[3], param->disc_res.bda[4], param->disc_res.bda[5]);
             
-            // Check if this is our target ELM327 device
-            if (memcmp(param->disc_res.bda, target_elm327_bda, 6) == 0) {
-                if (is_connecting) {
-                    ESP_LOGD(TAG, "🎯 Already connecting to ELM327, ignoring duplicate discovery");
+            // Check if this is one of our target ELM327 devices
+            elm327_link_t *link = link_by_bda(param->disc_res.bda);
+            if (link) {
+                if (link->connecting || link->connected) {
+                    ESP_LOGD(TAG, "🎯 Already connecting to ELM327 #%u, ignoring duplicate discovery", link->index);
                     break;
                 }
                 
-                LOG_INFO(TAG, "Found ELM327: %s", addr_str);
+                LOG_INFO(TAG, "Found ELM327 #%u: %s", link->index, addr_str);
                 LOG_BT(TAG, "Attempting connection to ELM327...");
                 
-                is_connecting = true;  // Mark as connecting to prevent multiple attempts
+                link->connecting = true;  // Mark as connecting to prevent multiple attempts
                 esp_bt_gap_cancel_discovery();
                 
                 // Give ELM327 time to be ready for connection
@@ -53,11 +126,13 @@ static void gap_callback(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *par
                     ret = esp_spp_connect(ESP_SPP_SEC_NONE, ESP_SPP_ROLE_MASTER, 1, param->disc_res.bda);
                     if (ret != ESP_OK) {
                         LOG_ERROR(TAG, "Both SCN 2 and SCN 1 failed: %s", esp_err_to_name(ret));
-                        is_connecting = false;
+                        link->connecting = false;
                     } else {
+                        connect_pending(link);
                         LOG_INFO(TAG, "SCN 1 fallback connection initiated");
                     }
                 } else {
+                    connect_pending(link);
                     LOG_INFO(TAG, "SCN 2 connection initiated");
                 }
             } else {
@@ -69,63 +144,132 @@ static void gap_callback(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *par
         case ESP_BT_GAP_DISC_STATE_CHANGED_EVT:
             if (param->disc_st_chg.state == ESP_BT_GAP_DISCOVERY_STOPPED) {
                 ESP_LOGI(TAG, "🔍 Device discovery stopped");
-                if (!is_connecting && !is_connected) {
+                if (link_missing()) {
                     ESP_LOGI(TAG, "⏳ Connection attempt in progress - waiting...");
                 }
             }
             break;
             
+        case ESP_BT_GAP_MODE_CHG_EVT:
+            // Link policy manages the primary adapter's ACL only
+            if (memcmp(param->mode_chg.bda, target_elm327_bda, 6) == 0) {
+                link_policy_on_mode_change(param->mode_chg.mode);
+            }
+            break;
+            
+        case ESP_BT_GAP_QOS_CMPL_EVT:
+            LOG_BT(TAG, "ACL poll interval set: %lu slots (status %d)",
+                   param->qos_cmpl.t_poll, param->qos_cmpl.stat);
+            break;
+            
         default:
             ESP_LOGD(TAG, "GAP event: %d", event);
             break;
     }
+    
+    task_watchdog_leave(WDT_TASK_BTC);
 }
 
 // SPP callback for connection events and data
 static void spp_callback(esp_spp_cb_event_t event, esp_spp_cb_param_t *param) {
+    task_watchdog_enter(WDT_TASK_BTC, "spp_callback", event);
+    
     switch (event) {
         case ESP_SPP_INIT_EVT:
             LOG_BT(TAG, "SPP initialized");
+#if SPP_PROXY_ENABLED
+            spp_proxy_start_server();
+#endif
             break;
             
         case ESP_SPP_START_EVT:
             LOG_BT(TAG, "SPP server started");
             break;
             
-        case ESP_SPP_CL_INIT_EVT:
-            LOG_BT(TAG, "SPP client initiated");
+        case ESP_SPP_CL_INIT_EVT: {
+            elm327_link_t *link = connect_initiated();
+            if (!link || !param) {
+                LOG_WARN(TAG, "SPP client initiated without a pending connect");
+                break;
+            }
+            if (param->cl_init.status != ESP_SPP_SUCCESS) {
+                // No close event follows a connect that never started
+                LOG_WARN(TAG, "SPP client init failed (ELM327 #%u, status %d)", link->index, param->cl_init.status);
+                link->connecting = false;
+                handle_connection_failure(link->index);
+                break;
+            }
+            link->handle = param->cl_init.handle;
+            LOG_BT(TAG, "SPP client initiated (ELM327 #%u, handle %lu)", link->index, param->cl_init.handle);
             break;
+        }
             
-        case ESP_SPP_OPEN_EVT:
-            LOG_INFO(TAG, "RFCOMM connection established");
-            is_connected = true;
-            is_connecting = false;
+        case ESP_SPP_OPEN_EVT: {
+            elm327_link_t *link = param ? link_by_bda(param->open.rem_bda) : NULL;
+            if (!link) {
+                LOG_WARN(TAG, "RFCOMM opened to an unknown peer, ignoring");
+                break;
+            }
+            LOG_INFO(TAG, "RFCOMM connection established (ELM327 #%u)", link->index);
+            elm327_link_opened(link, param->open.handle);  // Fresh per-connection state
             is_searching = false;
             
-            if (param) {
-                spp_handle = param->open.handle;
+            if (link->index == ELM327_LINK_PRIMARY) {
+                link_policy_on_connected(param->open.rem_bda);
+                led_set_connected(true);  // Turn on LED solid
             }
-            led_set_connected(true);  // Turn on LED solid
             
             // Create task for delayed ELM327 initialization to prevent immediate disconnection
-            LOG_VERBOSE(TAG, "Scheduling ELM327 initialization...");
-            xTaskCreate(initialize_elm327_task, "elm327_init", 4096, NULL, 5, NULL);
+            LOG_VERBOSE(TAG, "Scheduling ELM327 #%u initialization...", link->index);
+            xTaskCreate(initialize_elm327_task, "elm327_init", 4096, link, 5, NULL);
+            
+            // Keep looking for the other adapter
+            if (link_missing()) {
+                start_device_discovery();
+            }
+            break;
+        }
+            
+        case ESP_SPP_SRV_OPEN_EVT:
+            if (param) {
+                spp_proxy_on_open(param->srv_open.handle);
+            }
             break;
             
-        case ESP_SPP_CLOSE_EVT:
-            LOG_WARN(TAG, "Bluetooth connection closed");
-            is_connecting = false;   // Reset connection attempt state
-            is_connected = false;    // No longer connected
-            elm327_initialized = false;
-            led_set_connected(false);  // Turn off LED
+        case ESP_SPP_CLOSE_EVT: {
+            if (param && spp_proxy_owns(param->close.handle)) {
+                spp_proxy_on_close();
+                break;
+            }
+            elm327_link_t *link = param ? link_for_close(param->close.handle) : NULL;
+            if (!link) {
+                ESP_LOGD(TAG, "SPP close for unknown handle");
+                break;
+            }
+            LOG_WARN(TAG, "Bluetooth connection closed (ELM327 #%u)", link->index);
+            link->connecting = false;   // Reset connection attempt state
+            link->connected = false;    // No longer connected
+            link->initialized = false;
+            if (link->index == ELM327_LINK_PRIMARY) {
+                link_policy_on_disconnected();
+                led_set_connected(false);  // Turn off LED
+            }
             
-            handle_connection_failure();
+            if (!suspended) {
+                handle_connection_failure(link->index);
+            }
             break;
+        }
             
         case ESP_SPP_DATA_IND_EVT:
             if (param && param->data_ind.data && param->data_ind.len > 0) {
                 LOG_DEBUG(TAG, "Data received: %.*s", param->data_ind.len, param->data_ind.data);
-                process_received_data((const char *)param->data_ind.data, param->data_ind.len);
+                elm327_link_t *link = elm327_link_by_handle(param->data_ind.handle);
+                if (spp_proxy_owns(param->data_ind.handle)) {
+                    spp_proxy_on_data(param->data_ind.data, param->data_ind.len);
+                } else if (link) {
+                    elm327_link_receive(link, (const char *)param->data_ind.data, param->data_ind.len);
+                }
             }
             break;
             
@@ -137,36 +281,43 @@ static void spp_callback(esp_spp_cb_event_t event, esp_spp_cb_param_t *param) {
             ESP_LOGD(TAG, "SPP event: %d", event);
             break;
     }
+    
+    task_watchdog_leave(WDT_TASK_BTC);
 }
 
 // Handle connection failures with simple retry logic
-void handle_connection_failure(void) {
+void handle_connection_failure(uint8_t link_index) {
+    elm327_link_t *link = &elm327_links[link_index];
+    uint8_t *bda = link_bda[link_index];
+    
     // Simple retry: SCN 2 first, then SCN 1, then restart discovery
-    connection_attempt++;
-    ESP_LOGI(TAG, "🔄 Connection failed - retry attempt #%d...", connection_attempt);
+    connection_attempt[link_index]++;
+    ESP_LOGI(TAG, "🔄 ELM327 #%u connection failed - retry attempt #%d...", link_index, connection_attempt[link_index]);
     
     vTaskDelay(pdMS_TO_TICKS(2000));  // Wait before retry
     
-    if (connection_attempt % 3 == 1) {
+    if (connection_attempt[link_index] % 3 == 1) {
         // Try SCN 2 (known working channel)
         ESP_LOGI(TAG, "📡 Retry: SCN 2 (primary channel)...");
-        if (esp_spp_connect(ESP_SPP_SEC_NONE, ESP_SPP_ROLE_MASTER, 2, target_elm327_bda) == ESP_OK) {
-            is_connecting = true;
+        if (esp_spp_connect(ESP_SPP_SEC_NONE, ESP_SPP_ROLE_MASTER, 2, bda) == ESP_OK) {
+            link->connecting = true;
+            connect_pending(link);
             ESP_LOGI(TAG, "✅ SCN 2 retry connection initiated");
             return;
         }
-    } else if (connection_attempt % 3 == 2) {
+    } else if (connection_attempt[link_index] % 3 == 2) {
         // Try SCN 1 (fallback)
         ESP_LOGI(TAG, "📡 Retry: SCN 1 (fallback channel)...");
-        if (esp_spp_connect(ESP_SPP_SEC_NONE, ESP_SPP_ROLE_MASTER, 1, target_elm327_bda) == ESP_OK) {
-            is_connecting = true;
+        if (esp_spp_connect(ESP_SPP_SEC_NONE, ESP_SPP_ROLE_MASTER, 1, bda) == ESP_OK) {
+            link->connecting = true;
+            connect_pending(link);
             ESP_LOGI(TAG, "✅ SCN 1 retry connection initiated");
             return;
         }
     } else {
         // Reset counter and restart discovery
         ESP_LOGI(TAG, "🔄 Retries exhausted, restarting discovery...");
-        connection_attempt = 0;
+        connection_attempt[link_index] = 0;
     }
     
     // Restart discovery
@@ -177,7 +328,10 @@ void handle_connection_failure(void) {
 
 // Start device discovery
 void start_device_discovery(void) {
-    if (is_connecting || is_connected) {
+    if (suspended) {
+        return;
+    }
+    if (!link_missing()) {
         ESP_LOGD(TAG, "🔗 Already connecting/connected, skipping discovery");
         return;
     }
@@ -199,6 +353,23 @@ void start_device_discovery(void) {
 void bluetooth_init(void) {
     LOG_INFO(TAG, "Starting Bluetooth initialization...");
     
+#if BLE_STREAM_ENABLED
+    // Dual mode: Classic SPP client plus the BLE stream peripheral
+    LOG_VERBOSE(TAG, "Initializing BT controller (dual mode)...");
+    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+    bt_cfg.mode = ESP_BT_MODE_BTDM;
+    esp_err_t ret = esp_bt_controller_init(&bt_cfg);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "BT controller init failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    
+    ret = esp_bt_controller_enable(BT_CONTROLLER_MODE);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "BT controller enable failed: %s", esp_err_to_name(ret));
+        return;
+    }
+#else
     // Release BLE memory since we only use Classic BT
     LOG_VERBOSE(TAG, "Releasing BLE memory (using Classic BT only)...");
     esp_err_t ret = esp_bt_controller_mem_release(ESP_BT_MODE_BLE);
@@ -219,11 +390,12 @@ void bluetooth_init(void) {
     
     // Enable BT controller
     LOG_VERBOSE(TAG, "Enabling BT controller (Classic Bluetooth only)...");
-    ret = esp_bt_controller_enable(ESP_BT_MODE_CLASSIC_BT);
+    ret = esp_bt_controller_enable(BT_CONTROLLER_MODE);
     if (ret != ESP_OK) {
         LOG_ERROR(TAG, "BT controller enable failed: %s", esp_err_to_name(ret));
         return;
     }
+#endif
     
     // Initialize Bluedroid
     LOG_VERBOSE(TAG, "Initializing Bluedroid...");
@@ -268,5 +440,70 @@ void bluetooth_init(void) {
         return;
     }
     
+#if BLE_STREAM_ENABLED
+    ble_stream_init();
+#endif
+    
     LOG_INFO(TAG, "Bluetooth initialization complete!");
-} 
\ No newline at end of file
+} 
+
+// Radio off while parked: drop the adapter links and disable the stack. The
+// enabled BR/EDR controller holds a no-light-sleep PM lock, so automatic
+// light sleep only engages once it is disabled
+void bluetooth_suspend(void) {
+    if (suspended) {
+        return;
+    }
+    suspended = true;
+    LOG_INFO(TAG, "Bluetooth off (parked)");
+#if ELM327_SIM_ENABLED
+    elm327_sim_link_close();
+#else
+    esp_bt_gap_cancel_discovery();
+    esp_spp_deinit();           // Closes the RFCOMM links and the proxy server
+    esp_bluedroid_disable();
+    esp_bt_controller_disable();
+#endif
+    
+    // Close events may not arrive once the stack is down
+    for (int i = 0; i < ELM327_LINK_COUNT; i++) {
+        elm327_links[i].connecting = false;
+        elm327_links[i].connected = false;
+        elm327_links[i].initialized = false;
+        connection_attempt[i] = 0;
+    }
+    pending_tail = pending_head;
+    is_searching = false;
+    link_policy_on_disconnected();
+    led_set_searching(false);
+    led_set_connected(false);
+}
+
+// Radio back on after a parked sleep: restart the stack and look for the adapters
+void bluetooth_resume(void) {
+    if (!suspended) {
+        return;
+    }
+    LOG_INFO(TAG, "Bluetooth on (parked probe)");
+#if ELM327_SIM_ENABLED
+    suspended = false;
+    elm327_sim_link_reopen();
+#else
+    esp_err_t ret = esp_bt_controller_enable(BT_CONTROLLER_MODE);
+    if (ret == ESP_OK) {
+        ret = esp_bluedroid_enable();
+    }
+    if (ret == ESP_OK) {
+        ret = esp_spp_init(ESP_SPP_MODE_CB);    // INIT_EVT restarts the proxy server
+    }
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Bluetooth restart failed: %s", esp_err_to_name(ret));
+        return;                 // Still suspended: the next wake-up retries
+    }
+#if BLE_STREAM_ENABLED
+    ble_stream_init();          // GATT app registrations do not survive the disable
+#endif
+    suspended = false;
+    start_device_discovery();
+#endif
+}
\ No newline at end of file
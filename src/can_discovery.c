@@ -0,0 +1,561 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "logging_config.h"
+#include "can_discovery.h"
+#include "hybrid_monitor.h"
+#include "auto_tuner.h"
+#include "elm327.h"
+#include "obd_data.h"
+#include "task_watchdog.h"
+
+static const char *TAG = "CAN_DISC";
+
+#define PROMPT_WAIT_MS 2000     // elm327_link_send bound per command
+
+// Candidate fields per frame: 8-bit at bytes 0-7, 16-bit big-endian and
+// little-endian starting at bytes 0-6
+#define FIELD_COUNT 22
+
+// One CAN ID seen on the bus
+typedef struct {
+    uint32_t id;
+    uint32_t frames;
+    int64_t last_us;
+    uint8_t data[8];            // Latest payload
+    uint8_t len;
+    uint8_t changed;            // Bit per byte that changed during the survey
+    bool picked;
+} seen_id_t;
+
+// Linear regression sums for one field against polled RPM (exact integers)
+typedef struct {
+    uint32_t n;
+    int64_t sx, sy, sxx, sxy, syy;
+} fit_sums_t;
+
+typedef struct {
+    seen_id_t seen[CAN_DISCOVERY_MAX_IDS];
+    uint8_t seen_count;
+    uint8_t candidates[CAN_DISCOVERY_MAX_CANDIDATES];  // Indexes into seen
+    uint8_t candidate_count;
+    fit_sums_t sums[CAN_DISCOVERY_MAX_CANDIDATES][FIELD_COUNT];
+} discovery_t;
+
+// Fitted field
+typedef struct {
+    uint8_t candidate;
+    uint8_t field;
+    uint32_t n;
+    float r;
+    float scale;
+    float offset;
+    float rms;
+} fit_result_t;
+
+// Stored per vehicle
+typedef struct {
+    uint8_t version;
+    char vin[AUTO_TUNER_VIN_LEN + 1];
+    broadcast_signal_t signal;
+    uint16_t r_x1000;
+} discovery_record_t;
+
+typedef enum {
+    DISC_IDLE = 0,
+    DISC_SURVEY,                // Collect IDs and changing bytes
+    DISC_CORRELATE              // Pair fields with polled RPM
+} discovery_phase_t;
+
+static discovery_t *disc = NULL;        // Allocated for the duration of a run
+static volatile discovery_phase_t phase = DISC_IDLE;
+static volatile bool pending = false;
+
+// Receive path state
+static volatile bool monitoring = false;
+static volatile uint32_t overflows = 0;
+static volatile uint32_t ids_dropped = 0;
+static volatile uint32_t rpm_samples = 0;
+static volatile uint32_t rpm_min = UINT32_MAX;
+static volatile uint32_t rpm_max = 0;
+
+void can_discovery_init(void) {
+    pending = false;
+    phase = DISC_IDLE;
+    LOG_VERBOSE(TAG, "CAN discovery initialized (record %u bytes, run buffer %u bytes)",
+                (unsigned)sizeof(discovery_record_t), (unsigned)sizeof(discovery_t));
+}
+
+bool can_discovery_pending(void) {
+    return pending;
+}
+
+void can_discovery_request(void) {
+    pending = true;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// One space-separated hex token (up to 8 digits)
+static bool read_hex_token(const char **p, uint32_t *value, int *digits) {
+    uint32_t v = 0;
+    int n = 0;
+
+    while ((*p)[n] != '\0' && (*p)[n] != ' ') {
+        int h = hex_value((*p)[n]);
+        if (h < 0 || n == 8) {
+            return false;
+        }
+        v = v << 4 | (uint32_t)h;
+        n++;
+    }
+    if (n == 0) {
+        return false;
+    }
+    *p += n;
+    *value = v;
+    *digits = n;
+    return true;
+}
+
+// "<id> <data...>" with headers on: 11-bit ID as three digits ("1DC"),
+// 29-bit ID as four bytes ("18 FE F1 00")
+static bool parse_frame(const char *line, uint32_t *id, uint8_t *data, uint8_t *len) {
+    const char *p = line;
+    uint32_t v;
+    int digits;
+
+    if (!read_hex_token(&p, &v, &digits) || (digits != 3 && digits != 2)) {
+        return false;
+    }
+    *id = v;
+    for (int i = 0; digits == 2 && i < 3; i++) {
+        while (*p == ' ') {
+            p++;
+        }
+        if (!read_hex_token(&p, &v, &digits) || digits != 2) {
+            return false;
+        }
+        *id = *id << 8 | v;
+    }
+
+    *len = 0;
+    while (*p) {
+        if (*p == ' ') {
+            p++;
+            continue;
+        }
+        if (!read_hex_token(&p, &v, &digits) || digits != 2 || *len == 8) {
+            return false;
+        }
+        data[(*len)++] = (uint8_t)v;
+    }
+    return *len > 0;
+}
+
+// Field index to layout: 0-7 8-bit, 8-14 big-endian, 15-21 little-endian
+static void field_layout(uint8_t field, uint8_t *start, uint8_t *width, bool *little_endian) {
+    *width = field < 8 ? 8 : 16;
+    *little_endian = field >= 15;
+    *start = field < 8 ? field : field < 15 ? field - 8 : field - 15;
+}
+
+static bool field_value(const seen_id_t *s, uint8_t field, uint32_t *x) {
+    uint8_t start, width;
+    bool little_endian;
+
+    field_layout(field, &start, &width, &little_endian);
+    if (start + width / 8 > s->len) {
+        return false;
+    }
+    const uint8_t *b = &s->data[start];
+    if (width == 8) {
+        *x = b[0];
+    } else {
+        *x = little_endian ? (uint32_t)(b[0] | b[1] << 8) : (uint32_t)(b[0] << 8 | b[1]);
+    }
+    return true;
+}
+
+static seen_id_t *find_id(uint32_t id, bool add) {
+    for (int i = 0; i < disc->seen_count; i++) {
+        if (disc->seen[i].id == id) {
+            return &disc->seen[i];
+        }
+    }
+    if (!add || disc->seen_count == CAN_DISCOVERY_MAX_IDS) {
+        if (add) {
+            ids_dropped++;
+        }
+        return NULL;
+    }
+    seen_id_t *s = &disc->seen[disc->seen_count++];
+    s->id = id;
+    return s;
+}
+
+// Polled RPM: pair it with every candidate field that is fresh enough
+static void on_polled_rpm(uint32_t rpm, int64_t now_us) {
+    rpm_samples++;
+    if (rpm < rpm_min) {
+        rpm_min = rpm;
+    }
+    if (rpm > rpm_max) {
+        rpm_max = rpm;
+    }
+
+    for (int c = 0; c < disc->candidate_count; c++) {
+        const seen_id_t *s = &disc->seen[disc->candidates[c]];
+        if (now_us - s->last_us > (int64_t)CAN_DISCOVERY_MAX_FRAME_AGE_MS * 1000) {
+            continue;
+        }
+        for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+            uint32_t x;
+            if (!field_value(s, f, &x)) {
+                continue;
+            }
+            fit_sums_t *sum = &disc->sums[c][f];
+            sum->n++;
+            sum->sx += x;
+            sum->sy += rpm;
+            sum->sxx += (int64_t)x * x;
+            sum->sxy += (int64_t)x * rpm;
+            sum->syy += (int64_t)rpm * rpm;
+        }
+    }
+}
+
+// Receive path (BT callback context: no logging)
+bool can_discovery_on_line(const char *line) {
+    uint32_t id;
+    uint8_t data[8];
+    uint8_t len;
+
+    if (phase == DISC_IDLE) {
+        return false;
+    }
+    if (strstr(line, "STOPPED")) {
+        monitoring = false;
+        return true;
+    }
+    if (strstr(line, "BUFFER FULL")) {
+        overflows++;
+        monitoring = false;     // Adapter left monitor mode, prompt follows
+        return true;
+    }
+    if (!parse_frame(line, &id, data, &len)) {
+        return false;
+    }
+    int64_t now_us = esp_timer_get_time();
+
+    // Raw 010C reply between windows: "<id> <PCI> 41 0C <A> <B> ..."
+    if (!monitoring) {
+        if (phase == DISC_CORRELATE && len >= 5 && data[1] == 0x41 && data[2] == 0x0C) {
+            on_polled_rpm((uint32_t)(data[3] << 8 | data[4]) / 4, now_us);
+        }
+        return true;
+    }
+
+    seen_id_t *s = find_id(id, phase == DISC_SURVEY);
+    if (s == NULL) {
+        return true;
+    }
+    if (phase == DISC_SURVEY && s->frames > 0) {
+        for (uint8_t b = 0; b < len && b < s->len; b++) {
+            if (data[b] != s->data[b]) {
+                s->changed |= 1 << b;
+            }
+        }
+    }
+    memcpy(s->data, data, len);
+    s->len = len;
+    s->last_us = now_us;
+    s->frames++;
+    return true;
+}
+
+// Unfiltered monitor; the adapter gives no prompt until it is interrupted.
+// Flagged only once sent: the send waits out the previous poll reply.
+static void start_monitor(void) {
+    elm327_send_command("ATMA");
+    monitoring = true;
+    elm327_links[ELM327_LINK_PRIMARY].command_sent_us = 0;  // Not a round trip
+}
+
+// Any character stops the monitor; STOPPED and a prompt follow
+static void stop_monitor(elm327_link_t *link) {
+    if (!monitoring) {
+        return;     // Already out (BUFFER FULL): a bare CR now would repeat ATMA
+    }
+    elm327_link_abort(link);
+    elm327_link_wait_ready(link, pdMS_TO_TICKS(PROMPT_WAIT_MS));
+    monitoring = false;
+}
+
+static bool interrupted(void) {
+    return obd_get_poll_profile() != OBD_PROFILE_NORMAL || !elm327_link_is_up(ELM327_LINK_PRIMARY);
+}
+
+// Busiest IDs whose payload changes; static frames cannot carry RPM
+static void pick_candidates(void) {
+    uint8_t changing = 0;
+
+    for (int i = 0; i < disc->seen_count; i++) {
+        if (disc->seen[i].changed) {
+            changing++;
+        }
+    }
+    disc->candidate_count = 0;
+    while (disc->candidate_count < CAN_DISCOVERY_MAX_CANDIDATES) {
+        int best = -1;
+        for (int i = 0; i < disc->seen_count; i++) {
+            const seen_id_t *s = &disc->seen[i];
+            if (s->changed && !s->picked && (best < 0 || s->frames > disc->seen[best].frames)) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        disc->seen[best].picked = true;
+        disc->candidates[disc->candidate_count++] = (uint8_t)best;
+    }
+    LOG_INFO(TAG, "Survey: %u IDs (%lu not tracked), %u changing, correlating %u, %lu overflows",
+             disc->seen_count, ids_dropped, changing, disc->candidate_count, overflows);
+}
+
+// Least squares rpm = x * scale + offset, with correlation and residual
+static bool fit_field(const fit_sums_t *sum, fit_result_t *out) {
+    if (sum->n < CAN_DISCOVERY_MIN_SAMPLES / 2) {
+        return false;
+    }
+    double n = sum->n;
+    double sxx = n * sum->sxx - (double)sum->sx * sum->sx;
+    double sxy = n * sum->sxy - (double)sum->sx * sum->sy;
+    double syy = n * sum->syy - (double)sum->sy * sum->sy;
+    if (sxx <= 0.0 || syy <= 0.0) {
+        return false;   // Constant field, or constant RPM
+    }
+    double slope = sxy / sxx;
+    double residual = (syy - sxy * sxy / sxx) / (n * n);
+
+    out->n = sum->n;
+    out->r = (float)(sxy / sqrt(sxx * syy));
+    out->scale = (float)slope;
+    out->offset = (float)((sum->sy - slope * sum->sx) / n);
+    out->rms = residual > 0.0 ? (float)sqrt(residual) : 0.0f;
+    return true;
+}
+
+static void log_fit(const char *label, const fit_result_t *fit) {
+    uint8_t start, width;
+    bool little_endian;
+
+    field_layout(fit->field, &start, &width, &little_endian);
+    LOG_INFO(TAG, "%s ID %lX byte %u %2u-bit %s: r %.3f, rpm = raw x %.4f %+.0f, rms %.0f rpm (n %lu)",
+             label, disc->seen[disc->candidates[fit->candidate]].id, start, width,
+             width == 8 ? "  " : little_endian ? "LE" : "BE", fit->r, fit->scale, fit->offset,
+             fit->rms, fit->n);
+}
+
+static void store_record(const discovery_record_t *record) {
+    char key[16];
+    nvs_handle_t nvs;
+
+    auto_tuner_vehicle_key(key, sizeof(key));
+    esp_err_t ret = nvs_open(CAN_DISCOVERY_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "NVS open failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    ret = nvs_set_blob(nvs, key, record, sizeof(*record));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to store broadcast RPM for %s: %s", record->vin, esp_err_to_name(ret));
+    }
+}
+
+static bool load_record(discovery_record_t *record) {
+    char key[16];
+    nvs_handle_t nvs;
+    size_t size = sizeof(*record);
+
+    auto_tuner_vehicle_key(key, sizeof(key));
+    if (nvs_open(CAN_DISCOVERY_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    esp_err_t ret = nvs_get_blob(nvs, key, record, &size);
+    nvs_close(nvs);
+    return ret == ESP_OK && size == sizeof(*record) &&
+           record->version == CAN_DISCOVERY_RECORD_VERSION &&
+           strcmp(record->vin, auto_tuner_vehicle_id()) == 0;
+}
+
+// New primary connection (after the VIN read): use the stored frame for this car
+void can_discovery_on_connect(void) {
+    discovery_record_t record;
+
+    if (load_record(&record)) {
+        LOG_INFO(TAG, "Stored broadcast RPM for %s (r 0.%03u)", record.vin, record.r_x1000);
+        hybrid_monitor_set_signal(&record.signal);
+        return;
+    }
+    if (HYBRID_RPM_CAN_ID == 0) {
+        hybrid_monitor_set_signal(NULL);    // Nothing known for this car
+        if (CAN_DISCOVERY_ON_NEW_VEHICLE) {
+            LOG_INFO(TAG, "No broadcast RPM stored for %s, discovering with the engine running",
+                     auto_tuner_vehicle_id());
+            pending = true;
+        }
+    }
+}
+
+// Best field over all candidates
+static void evaluate(void) {
+    fit_result_t best = { 0 };
+    fit_result_t runner_up = { 0 };
+
+    for (uint8_t c = 0; c < disc->candidate_count; c++) {
+        for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+            fit_result_t fit;
+            if (!fit_field(&disc->sums[c][f], &fit)) {
+                continue;
+            }
+            fit.candidate = c;
+            fit.field = f;
+            if (fit.r > best.r) {
+                runner_up = best;
+                best = fit;
+            } else if (fit.r > runner_up.r) {
+                runner_up = fit;
+            }
+        }
+    }
+
+    if (best.r <= 0.0f) {
+        LOG_WARN(TAG, "No field follows the polled RPM");
+        return;
+    }
+    log_fit("Best:     ", &best);
+    if (runner_up.r > 0.0f) {
+        log_fit("Runner-up:", &runner_up);
+    }
+    if (best.r * 1000.0f < CAN_DISCOVERY_MIN_R_X1000) {
+        LOG_WARN(TAG, "Best correlation below 0.%03d, nothing stored", CAN_DISCOVERY_MIN_R_X1000);
+        return;
+    }
+
+    discovery_record_t record = {
+        .version = CAN_DISCOVERY_RECORD_VERSION,
+        .r_x1000 = (uint16_t)(best.r * 1000.0f),
+    };
+    snprintf(record.vin, sizeof(record.vin), "%s", auto_tuner_vehicle_id());
+    record.signal.can_id = disc->seen[disc->candidates[best.candidate]].id;
+    field_layout(best.field, &record.signal.start_byte, &record.signal.width, &record.signal.little_endian);
+    record.signal.scale = best.scale;
+    record.signal.offset = best.offset;
+    store_record(&record);
+    hybrid_monitor_set_signal(&record.signal);
+}
+
+// Survey the bus, then alternate monitor windows with 010C polls until the
+// RPM has covered enough range (obd_task context, engine running, normal profile)
+void can_discovery_run(void) {
+    elm327_link_t *link = &elm327_links[ELM327_LINK_PRIMARY];
+
+    pending = false;
+    disc = calloc(1, sizeof(*disc));
+    if (disc == NULL) {
+        LOG_ERROR(TAG, "No memory for discovery (%u bytes)", (unsigned)sizeof(*disc));
+        return;
+    }
+    overflows = 0;
+    ids_dropped = 0;
+    LOG_INFO(TAG, "Discovering broadcast RPM for %s: vary engine speed (up to %d s)",
+             auto_tuner_vehicle_id(), CAN_DISCOVERY_MAX_RUN_MS / 1000);
+
+    task_watchdog_beat(WDT_TASK_OBD, "discovery_setup", 3 * PROMPT_WAIT_MS);
+    elm327_send_command("AT CAF0");     // Whole payload, PCI included
+    elm327_send_command("ATH1");        // IDs in the monitor output
+    elm327_send_command("AT ST " CAN_DISCOVERY_ATST);
+
+    // Survey: which IDs are on the bus and which of their bytes change
+    phase = DISC_SURVEY;
+    TickType_t start = xTaskGetTickCount();
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(CAN_DISCOVERY_SNIFF_MS) && !interrupted()) {
+        if (!monitoring) {
+            start_monitor();    // First window, or restart after BUFFER FULL
+        }
+        task_watchdog_beat(WDT_TASK_OBD, "discovery_survey", CAN_DISCOVERY_WINDOW_MS + PROMPT_WAIT_MS);
+        vTaskDelay(pdMS_TO_TICKS(CAN_DISCOVERY_WINDOW_MS));
+    }
+    stop_monitor(link);
+    pick_candidates();
+
+    // Correlate: monitor window, then one polled RPM
+    rpm_samples = 0;
+    rpm_min = UINT32_MAX;
+    rpm_max = 0;
+    phase = DISC_CORRELATE;
+    start = xTaskGetTickCount();
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(CAN_DISCOVERY_MAX_RUN_MS) && !interrupted() &&
+           disc->candidate_count > 0) {
+        if (rpm_samples >= CAN_DISCOVERY_MIN_SAMPLES && rpm_max >= rpm_min &&
+            rpm_max - rpm_min >= CAN_DISCOVERY_MIN_RPM_SPAN) {
+            break;
+        }
+        task_watchdog_beat(WDT_TASK_OBD, "discovery_window", CAN_DISCOVERY_WINDOW_MS + 3 * PROMPT_WAIT_MS);
+        start_monitor();
+        vTaskDelay(pdMS_TO_TICKS(CAN_DISCOVERY_WINDOW_MS));
+        stop_monitor(link);
+        elm327_send_command("02010C0000000000");    // Raw single frame: 01 0C
+    }
+
+    // Restore polling settings (the first command also waits out the last reply)
+    bool aborted = interrupted();
+    if (elm327_link_is_up(ELM327_LINK_PRIMARY)) {
+        char atst_cmd[16];
+        snprintf(atst_cmd, sizeof(atst_cmd), "AT ST %s", auto_tuner_active()->atst);
+        task_watchdog_beat(WDT_TASK_OBD, "discovery_restore", 3 * PROMPT_WAIT_MS);
+        elm327_send_command("ATH0");
+        elm327_send_command("AT CAF1");
+        elm327_send_command(atst_cmd);
+    }
+    phase = DISC_IDLE;
+
+    uint32_t span = rpm_max >= rpm_min ? rpm_max - rpm_min : 0;
+    LOG_INFO(TAG, "Correlation: %lu polled RPM values, span %lu rpm, %lu overflows",
+             rpm_samples, span, overflows);
+    if (aborted) {
+        LOG_WARN(TAG, "Discovery aborted (trigger armed or link lost)");
+    } else if (rpm_samples < CAN_DISCOVERY_MIN_SAMPLES || span < CAN_DISCOVERY_MIN_RPM_SPAN) {
+        LOG_WARN(TAG, "RPM did not vary enough (need %d values over %d rpm), nothing stored",
+                 CAN_DISCOVERY_MIN_SAMPLES, CAN_DISCOVERY_MIN_RPM_SPAN);
+    } else {
+        evaluate();
+    }
+    free(disc);
+    disc = NULL;
+}
@@ -1,24 +1,109 @@
 #include "esp_log.h"
 #include "esp_spp_api.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "logging_config.h"
 #include "elm327.h"
 #include "bluetooth.h"
 #include "obd_data.h"
+#include "power_manager.h"
+#include "link_policy.h"
+#include "elm327_sim.h"
+#include "histogram.h"
+#include "spp_proxy.h"
+#include "ble_stream.h"
+#include "wifi_dashboard.h"
+#include "auto_tuner.h"
+#include "hybrid_monitor.h"
+#include "can_discovery.h"
+#include "task_watchdog.h"
 
 static const char *TAG = "ELM327";
 
 // ELM327 state variables
-bool elm327_initialized = false;
 SemaphoreHandle_t connection_semaphore;
-char rx_buffer[RX_BUFFER_SIZE];
-uint16_t rx_buffer_len = 0;
+elm327_link_t elm327_links[ELM327_LINK_COUNT];
 
-// Command pacing - wait for prompt before sending next command
-static volatile bool elm_ready = false;
-static uint8_t consecutive_fail = 0;
+// Receive path cost accounting (BT callback context, all links)
+static uint32_t overlong_lines = 0;
+static uint32_t budget_violations = 0;
+static histogram_t rx_cycles_per_byte;
+static uint32_t slowest_cycles_per_byte = 0;
+static uint16_t slowest_len = 0;
+static char slowest_chunk[ELM327_RX_SLOWEST_SAVE_BYTES];
+
+static void elm327_link_handle_response(elm327_link_t *link, const char *response);
+
+// Write raw bytes to the adapter link (RFCOMM, or the simulator when enabled)
+static esp_err_t link_write(elm327_link_t *link, const char *data, int len) {
+    log_trace_bytes("TX", (const uint8_t *)data, (uint16_t)len);
+    link->counters.tx_bytes += len;
+#if ELM327_SIM_ENABLED
+    return elm327_sim_write(link->index, (const uint8_t *)data, (uint16_t)len);
+#else
+    return esp_spp_write(link->handle, len, (uint8_t *)data);
+#endif
+}
+
+// Forget everything tied to a connection
+void elm327_link_reset(elm327_link_t *link) {
+    uint8_t index = link->index;
+    uint32_t generation = link->generation;
+    SemaphoreHandle_t prompt = link->prompt;
+    elm327_link_counters_t counters = link->counters;
+    memset(link, 0, sizeof(*link));
+    link->index = index;
+    link->generation = generation;
+    link->prompt = prompt;
+    link->counters = counters;
+}
+
+// Prompt seen: the next command may be sent (wakes elm327_link_wait_ready)
+static void link_set_ready(elm327_link_t *link) {
+    link->ready = true;
+    if (link->prompt != NULL) {
+        xSemaphoreGive(link->prompt);
+    }
+}
+
+// New RFCOMM connection: fresh state, new generation (stale init tasks abort)
+void elm327_link_opened(elm327_link_t *link, uint32_t handle) {
+    elm327_link_reset(link);
+    link->generation++;
+    link->handle = handle;
+    link->connected = true;
+}
+
+// Any byte interrupts a running request; the adapter answers STOPPED and a prompt
+void elm327_link_abort(elm327_link_t *link) {
+    link_write(link, "\r", 1);
+}
+
+// Consecutive failure backoff requested by the receive path (clears the request)
+bool elm327_link_take_backoff(elm327_link_t *link) {
+    if (!link->backoff_requested) {
+        return false;
+    }
+    link->backoff_requested = false;
+    return true;
+}
+
+elm327_link_t *elm327_link_by_handle(uint32_t handle) {
+    for (int i = 0; i < ELM327_LINK_COUNT; i++) {
+        if (elm327_links[i].connected && elm327_links[i].handle == handle) {
+            return &elm327_links[i];
+        }
+    }
+    return NULL;
+}
+
+bool elm327_link_is_up(uint8_t index) {
+    return index < ELM327_LINK_COUNT && elm327_links[index].connected && elm327_links[index].initialized;
+}
 
 // Initialize ELM327 system (semaphore, etc.)
 void elm327_init_system(void) {
@@ -29,21 +114,26 @@ void elm327_init_system(void) {
         return;
     }
     
-    // Initialize RX buffer
-    memset(rx_buffer, 0, RX_BUFFER_SIZE);
-    rx_buffer_len = 0;
+    // Initialize per-link state
+    for (int i = 0; i < ELM327_LINK_COUNT; i++) {
+        elm327_links[i].index = (uint8_t)i;
+        elm327_links[i].prompt = xSemaphoreCreateBinary();
+        elm327_link_reset(&elm327_links[i]);
+    }
+    histogram_init(&rx_cycles_per_byte, 10);
     
     LOG_VERBOSE(TAG, "ELM327 system initialized");
 }
 
-// Send OBD command to ELM327
+// Send OBD command to ELM327 (primary link, no prompt pacing)
 void send_obd_command(const char *cmd) {
-    if (is_connected && elm327_initialized && spp_handle) {
+    elm327_link_t *link = &elm327_links[ELM327_LINK_PRIMARY];
+    if (link->connected && link->initialized && link->handle) {
         // Format command with carriage return
         char formatted_cmd[32];
         snprintf(formatted_cmd, sizeof(formatted_cmd), "%s\r", cmd);
         
-        esp_err_t ret = esp_spp_write(spp_handle, strlen(formatted_cmd), (uint8_t *)formatted_cmd);
+        esp_err_t ret = link_write(link, formatted_cmd, strlen(formatted_cmd));
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "⚠️ Failed to send command: %s", esp_err_to_name(ret));
         }
@@ -52,32 +142,31 @@ void send_obd_command(const char *cmd) {
     }
 }
 
-// ELM327 specific command sending with error handling
+// ELM327 specific command sending with error handling (primary link)
 esp_err_t elm327_send_command(const char *cmd) {
-    if (!is_connected || !spp_handle) {
-        ESP_LOGW(TAG, "⚠️ Not connected to ELM327");
+    return elm327_link_send(&elm327_links[ELM327_LINK_PRIMARY], cmd);
+}
+
+// Send one command on a link once its prompt has been seen
+esp_err_t elm327_link_send(elm327_link_t *link, const char *cmd) {
+    if (!link->connected || !link->handle) {
+        ESP_LOGW(TAG, "⚠️ Not connected to ELM327 #%u", link->index);
         return ESP_ERR_INVALID_STATE;
     }
     
     // Wait for ELM327 to be ready (prompt detected) with timeout
-    TickType_t start_time = xTaskGetTickCount();
-    TickType_t timeout = pdMS_TO_TICKS(2000);  // 2 second timeout
-    
-    while (!elm_ready) {
-        vTaskDelay(pdMS_TO_TICKS(5));  // Wait in 5ms slots
-        
-        // Check for timeout to prevent watchdog issues
-        if ((xTaskGetTickCount() - start_time) > timeout) {
-            ESP_LOGW(TAG, "⚠️ Timeout waiting for ELM327 prompt, sending anyway");
-            break;
-        }
+    if (!elm327_link_wait_ready(link, pdMS_TO_TICKS(ELM327_PROMPT_TIMEOUT_MS))) {
+        ESP_LOGW(TAG, "⚠️ Timeout waiting for ELM327 prompt, sending anyway");
     }
-    elm_ready = false;  // Clear flag before sending
+    link->ready = false;  // Clear flag before sending
     
     char formatted_cmd[32];
     int len = snprintf(formatted_cmd, sizeof(formatted_cmd), "%s\r", cmd);
+    strncpy(link->last_command, cmd, sizeof(link->last_command) - 1);
+    link->last_command[sizeof(link->last_command) - 1] = '\0';
     
-    esp_err_t ret = esp_spp_write(spp_handle, len, (uint8_t *)formatted_cmd);
+    link->command_sent_us = esp_timer_get_time();
+    esp_err_t ret = link_write(link, formatted_cmd, len);
     if (ret == ESP_OK) {
         ESP_LOGD(TAG, "📤 Sent: %s", cmd);
     } else {
@@ -87,89 +176,358 @@ esp_err_t elm327_send_command(const char *cmd) {
     return ret;
 }
 
-// Handle ELM327 responses
+// Block until the receive path has seen the prompt; false on timeout.
+// A stale give from an earlier prompt only costs one extra loop.
+bool elm327_link_wait_ready(elm327_link_t *link, TickType_t timeout) {
+    TickType_t start = xTaskGetTickCount();
+    while (!link->ready) {
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (waited >= timeout || link->prompt == NULL) {
+            return link->ready;
+        }
+        xSemaphoreTake(link->prompt, timeout - waited);
+    }
+    return true;
+}
+
+// Parse an AT RV reply such as "12.6V" into millivolts
+static bool parse_voltage_response(const char *response, uint32_t *millivolts) {
+    size_t len = strlen(response);
+    if (len < 2 || len > 6 || response[len - 1] != 'V' || response[0] < '0' || response[0] > '9') {
+        return false;
+    }
+    
+    char *end;
+    float volts = strtof(response, &end);
+    if (end != &response[len - 1]) {
+        return false;
+    }
+    
+    *millivolts = (uint32_t)(volts * 1000.0f + 0.5f);
+    return true;
+}
+
+static bool is_hex_char(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
+// Parse the reassembled multi-frame payload and reset the assembler
+static void flush_segments(elm327_link_t *link) {
+    if (link->segment_bytes > 0) {
+        LOG_DEBUG(TAG, "Reassembled %u bytes: %s", link->segment_bytes, link->segment_buffer);
+        obd_data_parse_line(link->index, link->segment_buffer);
+    }
+    link->segment_buffer_len = 0;
+    link->segment_bytes = 0;
+    link->segment_expected = 0;
+    link->segment_buffer[0] = '\0';
+}
+
+// Collect ISO-TP segment lines; returns true if the line was consumed
+static bool assemble_segment(elm327_link_t *link, const char *line) {
+    size_t len = strlen(line);
+    
+    // Length line: exactly three hex digits ("00A" = 10 payload bytes). Only
+    // first frames announce a length, and they carry more than 7 bytes
+    if (len == 3 && is_hex_char(line[0]) && is_hex_char(line[1]) && is_hex_char(line[2])) {
+        uint16_t expected = (uint16_t)strtol(line, NULL, 16);
+        if (expected < 8) {
+            return false;
+        }
+        flush_segments(link);
+        link->segment_expected = expected;
+        return true;
+    }
+    
+    // Segment line: "<hex digit>:" followed by data bytes, only after a length line
+    if (len < 2 || !is_hex_char(line[0]) || line[1] != ':' || link->segment_expected == 0) {
+        return false;
+    }
+    if (line[0] == '0') {
+        uint16_t expected = link->segment_expected;
+        flush_segments(link);
+        link->segment_expected = expected;
+    }
+    
+    // Append byte tokens, dropping padding beyond the announced length
+    const char *p = line + 2;
+    while (*p) {
+        while (*p == ' ') {
+            p++;
+        }
+        if (!is_hex_char(p[0]) || !is_hex_char(p[1])) {
+            break;
+        }
+        if (link->segment_expected > 0 && link->segment_bytes >= link->segment_expected) {
+            break;
+        }
+        if (link->segment_buffer_len + 4 > SEGMENT_BUFFER_SIZE) {
+            break;
+        }
+        link->segment_buffer_len += snprintf(link->segment_buffer + link->segment_buffer_len,
+                                       SEGMENT_BUFFER_SIZE - link->segment_buffer_len,
+                                       link->segment_bytes ? " %c%c" : "%c%c", p[0], p[1]);
+        link->segment_bytes++;
+        p += 2;
+    }
+    
+    if (link->segment_expected > 0 && link->segment_bytes >= link->segment_expected) {
+        flush_segments(link);
+    }
+    return true;
+}
+
+// Expand a compact Mode 01 reply ("410C1AF8", adapters with ATS0) into spaced bytes
+static bool normalize_compact_hex(const char *line, char *out, size_t size) {
+    size_t len = strlen(line);
+    if (len < 4 || (len % 2) != 0 || len * 3 / 2 >= size || line[0] != '4' || line[1] != '1') {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (!is_hex_char(line[i])) {
+            return false;
+        }
+    }
+    
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 2) {
+        if (i > 0) {
+            out[o++] = ' ';
+        }
+        out[o++] = line[i];
+        out[o++] = line[i + 1];
+    }
+    out[o] = '\0';
+    return true;
+}
+
+// Handle ELM327 responses (primary link)
 void elm327_handle_response(const char *response) {
+    elm327_link_handle_response(&elm327_links[ELM327_LINK_PRIMARY], response);
+}
+
+// Handle one complete response line from a link
+static void elm327_link_handle_response(elm327_link_t *link, const char *response) {
+    uint32_t millivolts;
+    
     if (!response || strlen(response) == 0) {
         return;
     }
     
-    ESP_LOGI(TAG, "📥 ELM327 RAW response: '%s'", response);
+    LOG_ELM(TAG, "📥 ELM327 RAW response: '%s'", response);
+    
+    // Echoed command (clone adapters that ignore ATE0)
+    if (link->last_command[0] != '\0' && strcmp(response, link->last_command) == 0) {
+        return;
+    }
+    
+#if CAN_DISCOVERY_ENABLED
+    // Sniffed frames and raw RPM polls while discovering a broadcast signal
+    if (link->index == ELM327_LINK_PRIMARY && can_discovery_on_line(response)) {
+        return;
+    }
+#endif
+    
+#if HYBRID_MONITOR_ENABLED
+    // Monitor frames and raw poll replies belong to the hybrid scheduler
+    if (link->index == ELM327_LINK_PRIMARY && hybrid_monitor_on_line(response)) {
+        return;
+    }
+#endif
+    
+    // Multi-frame segment lines are reassembled before parsing
+    if (assemble_segment(link, response)) {
+        link->consecutive_fail = 0;
+        return;
+    }
     
     // Check for common ELM327 responses
     if (strstr(response, "ELM327")) {
         ESP_LOGI(TAG, "🔧 ELM327 device identified: %s", response);
+    } else if (parse_voltage_response(response, &millivolts)) {
+        ESP_LOGD(TAG, "🔋 Battery voltage: %lu mV", millivolts);
+        power_manager_update_voltage(millivolts);
     } else if (strstr(response, "OK")) {
         ESP_LOGD(TAG, "✅ Command acknowledged");
     } else if (strstr(response, "CAN ERROR") || strstr(response, "NO DATA")) {
         ESP_LOGW(TAG, "⚠️ CAN/ECU error: %s", response);
-        if (++consecutive_fail >= 3) {
-            ESP_LOGW(TAG, "⚠️ 3 consecutive failures, backing off...");
-            consecutive_fail = 0;
-            // Slow-down: pause for 300ms
-            vTaskDelay(pdMS_TO_TICKS(300));
+        if (link->index == ELM327_LINK_PRIMARY) {
+            auto_tuner_on_error();
+        }
+        // The BT callback never blocks: the polling task takes the pause
+        if (++link->consecutive_fail >= ELM327_BACKOFF_FAILURES) {
+            link->consecutive_fail = 0;
+            link->backoff_requested = true;
         }
         return;
     } else if (strstr(response, "ERROR")) {
         ESP_LOGW(TAG, "⚠️ ELM327 error: %s", response);
+        if (link->index == ELM327_LINK_PRIMARY) {
+            auto_tuner_on_error();
+        }
     } else if (strstr(response, "UNABLE TO CONNECT")) {
         ESP_LOGD(TAG, "🔌 ELM327 cannot connect to ECU (normal when not in car)");
     } else if (strstr(response, "SEARCHING")) {
         ESP_LOGD(TAG, "🔍 ELM327 searching for ECU...");
     } else {
         // Successfully received data - reset failure counter
-        consecutive_fail = 0;
+        link->consecutive_fail = 0;
         
         // Process as potential OBD data
         /* Handle possible multi-PID payload */
         char response_copy[256];
-        strncpy(response_copy, response, sizeof(response_copy) - 1);
-        response_copy[sizeof(response_copy) - 1] = '\0';
-        parse_multi_pid_line(response_copy);
+        if (!normalize_compact_hex(response, response_copy, sizeof(response_copy))) {
+            strncpy(response_copy, response, sizeof(response_copy) - 1);
+            response_copy[sizeof(response_copy) - 1] = '\0';
+        }
+        obd_data_parse_line(link->index, response_copy);
     }
 }
 
-// Process received data from Bluetooth
+// Timing of the response currently being handled on a link
+void elm327_link_get_sample_times(const elm327_link_t *link, int64_t *request_us, int64_t *rx_us) {
+    *request_us = link->response_request_us;
+    *rx_us = link->response_rx_us;
+}
+
+// Process received data from Bluetooth (primary link)
 void process_received_data(const char *data, uint16_t len) {
+    elm327_link_receive(&elm327_links[ELM327_LINK_PRIMARY], data, len);
+}
+
+// Assemble lines from one link's byte stream and dispatch them
+void elm327_link_receive(elm327_link_t *link, const char *data, uint16_t len) {
     if (!data || len == 0) {
         return;
     }
     
+    esp_cpu_cycle_count_t start_cycles = esp_cpu_get_cycle_count();
+    log_trace_bytes("RX", (const uint8_t *)data, len);
+    
     // Add received data to buffer
-    for (uint16_t i = 0; i < len && rx_buffer_len < (RX_BUFFER_SIZE - 1); i++) {
+    for (uint16_t i = 0; i < len; i++) {
         char c = data[i];
         
         // Check for end of response (carriage return or newline)
         if (c == '\r' || c == '\n') {
-            if (rx_buffer_len > 0) {
-                rx_buffer[rx_buffer_len] = '\0';  // Null terminate
-                
-                ESP_LOGD(TAG, "Processing response: %s", rx_buffer);
-                elm327_handle_response(rx_buffer);
+            if (link->discarding_line) {
+                link->discarding_line = false;  // Resynchronized on the terminator
+            } else if (link->rx_len > 0) {
+                link->rx_buffer[link->rx_len] = '\0';  // Null terminate
+                link->response_rx_us = esp_timer_get_time();
+                link->response_request_us = link->command_sent_us;
                 
-                // Clear buffer for next response
-                rx_buffer_len = 0;
-                memset(rx_buffer, 0, RX_BUFFER_SIZE);
+                ESP_LOGD(TAG, "Processing response: %s", link->rx_buffer);
+                if (link->forwarding) {
+                    spp_proxy_on_adapter_line(link->rx_buffer);
+                } else {
+                    elm327_link_handle_response(link, link->rx_buffer);
+                }
             }
+            
+            // Clear buffer for next response
+            link->rx_len = 0;
+            link->rx_buffer[0] = '\0';
+        } else if (c == '>' && link->forwarding) {
+            // Proxied request complete: reply goes to the phone, not the parser
+            spp_proxy_on_adapter_prompt();
+            link->command_sent_us = 0;
+            link->forwarding = false;
+            link_set_ready(link);
         } else if (c == '>') {
+            // Reply complete: parse any multi-frame payload still being assembled
+            flush_segments(link);
+            
             // Prompt detected - ELM327 is ready for next command
-            elm_ready = true;
-        } else if (c >= 32 && c <= 126) {  // Printable ASCII characters
-            rx_buffer[rx_buffer_len++] = c;
+            link_set_ready(link);
+            
+            // Command round trip complete (link policy applies to the primary link)
+            if (link->command_sent_us != 0) {
+                if (link->index == ELM327_LINK_PRIMARY) {
+                    uint32_t rtt_us = (uint32_t)(esp_timer_get_time() - link->command_sent_us);
+                    link_policy_record_rtt(rtt_us);
+#if BLE_STREAM_ENABLED
+                    ble_stream_on_spp_rtt(rtt_us);
+#endif
+#if WIFI_DASHBOARD_ENABLED
+                    wifi_dashboard_on_spp_rtt(rtt_us);
+#endif
+                }
+                link->command_sent_us = 0;
+            }
+        } else if (c >= 32 && c <= 126 && !link->discarding_line) {  // Printable ASCII characters
+            if (link->rx_len < (RX_BUFFER_SIZE - 1)) {
+                link->rx_buffer[link->rx_len++] = c;
+            } else {
+                // No terminator within RX_BUFFER_SIZE: drop the line, never rescan it
+                link->discarding_line = true;
+                overlong_lines++;
+                link->rx_len = 0;
+            }
         }
     }
+    
+    // Cost accounting against the documented budget
+    uint32_t cycles = esp_cpu_get_cycle_count() - start_cycles;
+    uint32_t per_byte = cycles / len;
+    link->counters.rx_bytes += len;
+    link->counters.rx_cycles += cycles;
+    histogram_record(&rx_cycles_per_byte, per_byte);
+    if (cycles > ELM327_RX_BUDGET_BASE_CYCLES + (uint32_t)ELM327_RX_BUDGET_CYCLES_PER_BYTE * len) {
+        budget_violations++;
+    }
+    if (per_byte > slowest_cycles_per_byte && len >= 4) {
+        slowest_cycles_per_byte = per_byte;
+        slowest_len = len < ELM327_RX_SLOWEST_SAVE_BYTES ? len : ELM327_RX_SLOWEST_SAVE_BYTES;
+        memcpy(slowest_chunk, data, slowest_len);
+    }
+}
+
+void elm327_link_get_counters(const elm327_link_t *link, elm327_link_counters_t *out) {
+    *out = link->counters;
+}
+
+// Report receive path cost (task context)
+void elm327_log_rx_stats(void) {
+    char printable[ELM327_RX_SLOWEST_SAVE_BYTES + 1];
+    for (uint16_t i = 0; i < slowest_len; i++) {
+        char c = slowest_chunk[i];
+        printable[i] = (c >= 32 && c <= 126) ? c : '.';
+    }
+    printable[slowest_len] = '\0';
+    
+    histogram_log_header(TAG, "cycles/byte");
+    histogram_log_row(TAG, "RX chunk", &rx_cycles_per_byte);
+    LOG_INFO(TAG, "RX budget violations: %lu, overlong lines: %lu, slowest: %lu cycles/byte '%s'",
+             budget_violations, overlong_lines, slowest_cycles_per_byte, printable);
+}
+
+// Pause between init steps; false once the link dropped or was reopened, so a
+// stale init task stops before it talks to the next connection
+static bool init_delay(elm327_link_t *link, uint32_t generation, uint32_t ms) {
+    task_watchdog_beat(WDT_TASK_ELM327_INIT + link->index, "init_wait", ms);
+    vTaskDelay(pdMS_TO_TICKS(ms));
+    if (!link->connected || link->generation != generation) {
+        LOG_WARN(TAG, "ELM327 #%u closed during initialization", link->index);
+        return false;
+    }
+    return true;
 }
 
 // Gentle ELM327 initialization to prevent disconnection
-void initialize_elm327(void) {
-    LOG_ELM(TAG, "Starting GENTLE ELM327 initialization...");
+void initialize_elm327(elm327_link_t *link) {
+    uint32_t generation = link->generation;
+    LOG_ELM(TAG, "Starting GENTLE ELM327 #%u initialization...", link->index);
     
     // Wait for ELM327 to settle after connection
     LOG_ELM(TAG, "Waiting 3 seconds for ELM327 to settle...");
-    vTaskDelay(pdMS_TO_TICKS(3000));
+    if (!init_delay(link, generation, 3000)) {
+        return;
+    }
     
     // Send reset command
     LOG_ELM(TAG, "Sending gentle ATZ (Reset)...");
-    esp_err_t ret = elm327_send_command("ATZ");
+    esp_err_t ret = elm327_link_send(link, "ATZ");
     if (ret != ESP_OK) {
         LOG_WARN(TAG, "Failed to send ATZ");
         return;
@@ -177,64 +535,86 @@ void initialize_elm327(void) {
     
     // Wait for reset to complete
     LOG_ELM(TAG, "Waiting for ELM327 reset response...");
-    vTaskDelay(pdMS_TO_TICKS(3000));
+    if (!init_delay(link, generation, 3000)) {
+        return;
+    }
     
     // Configure ELM327 for Honda Civic (ISO 15765-4 29-bit, 500k)
     LOG_ELM(TAG, "Configuring protocol for Honda Civic...");
     
     // Turn off echo
     LOG_ELM(TAG, "Sending ATE0 (Echo OFF)...");
-    ret = elm327_send_command("ATE0");
+    ret = elm327_link_send(link, "ATE0");
     if (ret != ESP_OK) {
         LOG_WARN(TAG, "Failed to send ATE0");
         return;
     }
-    vTaskDelay(pdMS_TO_TICKS(500));
+    if (!init_delay(link, generation, 500)) {
+        return;
+    }
     
     // Try automatic protocol detection first
     LOG_ELM(TAG, "Sending AT SP 0 (Auto protocol detection)...");
-    elm327_send_command("AT SP 0");
-    vTaskDelay(pdMS_TO_TICKS(500));
+    elm327_link_send(link, "AT SP 0");
+    if (!init_delay(link, generation, 500)) {
+        return;
+    }
     
     // Allow long frames (>7 bytes)
     LOG_ELM(TAG, "Sending AT AL (Allow Long frames)...");
-    elm327_send_command("AT AL");
-    vTaskDelay(pdMS_TO_TICKS(500));
+    elm327_link_send(link, "AT AL");
+    if (!init_delay(link, generation, 500)) {
+        return;
+    }
     
     // Try broadcast first (more compatible)
     LOG_ELM(TAG, "Sending AT SH 7DF (Broadcast address)...");
-    elm327_send_command("AT SH 7DF");
-    vTaskDelay(pdMS_TO_TICKS(500));
+    elm327_link_send(link, "AT SH 7DF");
+    if (!init_delay(link, generation, 500)) {
+        return;
+    }
     
     // Enable ELM auto-formatting for ISO-TP
     LOG_ELM(TAG, "Sending AT CAF1 (Auto-format ISO-TP)...");
-    elm327_send_command("AT CAF1");
-    vTaskDelay(pdMS_TO_TICKS(500));
+    elm327_link_send(link, "AT CAF1");
+    if (!init_delay(link, generation, 500)) {
+        return;
+    }
     
     // Set shorter timeout (50ms instead of 100ms default)
-    LOG_ELM(TAG, "Sending AT ST 32 (50ms timeout)...");
-    elm327_send_command("AT ST 32");
-    vTaskDelay(pdMS_TO_TICKS(500));
+    LOG_ELM(TAG, "Sending AT ST %s (50ms timeout)...", ELM327_ATST_VALUE);
+    elm327_link_send(link, "AT ST " ELM327_ATST_VALUE);
+    if (!init_delay(link, generation, 500)) {
+        return;
+    }
     
     // Headers off for shorter replies
     LOG_ELM(TAG, "Sending ATH0 (Headers OFF)...");
-    elm327_send_command("ATH0");
-    vTaskDelay(pdMS_TO_TICKS(500));
+    elm327_link_send(link, "ATH0");
+    if (!init_delay(link, generation, 500)) {
+        return;
+    }
     
     // Test basic connectivity with a simple command
     LOG_ELM(TAG, "Testing connectivity with AT RV (voltage check)...");
-    elm327_send_command("AT RV");
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    elm327_link_send(link, "AT RV");
+    if (!init_delay(link, generation, 1000)) {
+        return;
+    }
     
     // Check what protocol was detected
     LOG_ELM(TAG, "Checking detected protocol with AT DPN...");
-    elm327_send_command("AT DPN");
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    elm327_link_send(link, "AT DPN");
+    if (!init_delay(link, generation, 1000)) {
+        return;
+    }
     
     // Try a basic OBD test
     LOG_ELM(TAG, "Testing basic OBD with 0100 (Supported PIDs)...");
-    elm327_send_command("0100");
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    elm327_link_send(link, "0100");
+    if (!init_delay(link, generation, 2000)) {
+        return;
+    }
     
     LOG_ELM(TAG, "If above shows CAN ERROR, check:");
     LOG_ELM(TAG, "1. Car ignition is ON");
@@ -242,12 +622,14 @@ void initialize_elm327(void) {
     LOG_ELM(TAG, "3. OBD port connection is secure");
     
     // Mark as initialized
-    elm327_initialized = true;
-    elm_ready = true;  // Ready to accept commands
-    LOG_INFO(TAG, "ELM327 initialization complete - diagnostics above show readiness!");
+    link->initialized = true;
+    link_set_ready(link);  // Ready to accept commands
+    LOG_INFO(TAG, "ELM327 #%u initialization complete - diagnostics above show readiness!", link->index);
     
-    // Signal that connection is ready
-    xSemaphoreGive(connection_semaphore);
+    // Signal that the primary connection is ready
+    if (link->index == ELM327_LINK_PRIMARY) {
+        xSemaphoreGive(connection_semaphore);
+    }
 }
 
 // ELM327 initialization task (runs in separate thread)
@@ -255,8 +637,10 @@ void initialize_elm327_task(void *pv) {
     LOG_ELM(TAG, "ELM327 initialization task started...");
     
     // Perform gentle initialization
-    initialize_elm327();
+    elm327_link_t *link = pv ? (elm327_link_t *)pv : &elm327_links[ELM327_LINK_PRIMARY];
+    initialize_elm327(link);
     
-    // Delete this task when done
+    // Delete this task when done (its watch ends with it)
+    task_watchdog_leave(WDT_TASK_ELM327_INIT + link->index);
     vTaskDelete(NULL);
 } 
\ No newline at end of file
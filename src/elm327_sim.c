@@ -0,0 +1,525 @@
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "logging_config.h"
+#include "elm327_sim.h"
+#include "elm327.h"
+#include "bluetooth.h"
+#include "vehicle_model.h"
+#include "launch_control.h"
+#include "link_policy.h"
+
+static const char *TAG = "ELM327_SIM";
+
+#define SIM_CMD_MAX     32
+#define SIM_QUEUE_LEN   4
+#define SIM_REPLY_MAX   96
+#define SIM_FRAME_LINE_MAX  28      // "3D9 " plus 8 bytes and CR
+#define SIM_MONITOR_CHUNK   128     // Every broadcast frame due in one tick
+
+// Command written by the host side
+typedef struct {
+    char text[SIM_CMD_MAX];
+} sim_command_t;
+
+// One simulated adapter per link; all of them sit on the same car
+typedef struct {
+    uint8_t index;                       // Adapter link it answers on
+    QueueHandle_t command_queue;
+    volatile bool link_open;
+    uint32_t prng_state;
+    uint32_t st_timeout_ms;
+    uint8_t adaptive_mode;               // AT AT0/1/2
+    uint32_t learned_response_ms;
+    
+    // CAN formatting and filter state (AT H, AT CAF, AT CRA / AT AR)
+    bool headers;
+    bool auto_format;
+    uint32_t receive_filter;             // 0 = every ID passes
+    bool monitor_requested;              // ATMA: set by build_reply, run by the task
+} sim_adapter_t;
+
+#define SIM_ADAPTER_COUNT (ELM327_SECONDARY_ENABLED ? ELM327_LINK_COUNT : 1)
+
+static sim_adapter_t adapters[SIM_ADAPTER_COUNT];
+static int64_t last_sample_us = 0;       // Model time the last primary reply was sampled at
+static int64_t tick_base_us = 0;         // esp_timer time of tick 0, fixed at start
+static uint8_t frame_counter = 0;
+
+// Broadcast traffic; payloads are filled from the vehicle model
+typedef struct {
+    uint32_t id;
+    uint32_t period_ms;
+} sim_broadcast_t;
+
+static const sim_broadcast_t broadcasts[] = {
+    { 0x1A0, 10 },                                      // Wheel speed, rolling counter
+    { ELM327_SIM_RPM_CAN_ID, ELM327_SIM_RPM_PERIOD_MS },
+    { 0x2C4, 50 },                                      // Throttle
+    { 0x4F1, 100 },                                     // Static status frame
+};
+#define BROADCAST_COUNT (sizeof(broadcasts) / sizeof(broadcasts[0]))
+
+// Injected fault state (primary adapter)
+static volatile elm327_sim_fault_t active_fault = ELM327_SIM_FAULT_NONE;
+static volatile int64_t fault_until_us = 0;
+
+// Adapter clock: the model only ever sees scheduler tick boundaries, never the
+// wall time a task happened to read, so replies depend on the request sequence
+static int64_t sim_time_us(TickType_t tick) {
+    return tick_base_us + (int64_t)tick * portTICK_PERIOD_MS * 1000;
+}
+
+// xorshift32: deterministic jitter source
+static uint32_t prng_next(sim_adapter_t *a) {
+    a->prng_state ^= a->prng_state << 13;
+    a->prng_state ^= a->prng_state >> 17;
+    a->prng_state ^= a->prng_state << 5;
+    return a->prng_state;
+}
+
+// Build a Mode 01 reply for the requested PIDs ("010C11" -> "41 0C xx xx 11 xx")
+static void build_mode01_reply(const char *pids, char *reply, size_t size) {
+    const vehicle_model_state_t *state = vehicle_model_state();
+    uint8_t speed = state->speed_kmh > 255.0f ? 255 : (uint8_t)state->speed_kmh;
+    size_t used = snprintf(reply, size, "41");
+    bool any = false;
+    
+    for (const char *p = pids; p[0] && p[1] && used < size; p += 2) {
+        char hex[3] = { p[0], p[1], '\0' };
+        uint8_t pid = (uint8_t)strtol(hex, NULL, 16);
+        
+        switch (pid) {
+            case 0x00:
+                used += snprintf(reply + used, size - used, " 00 BE 3F A8 13");
+                break;
+            case 0x05:
+                used += snprintf(reply + used, size - used, " 05 %02X", 90 + 40);
+                break;
+            case 0x0C: {
+                uint16_t raw = (uint16_t)(state->rpm * 4.0f);
+                used += snprintf(reply + used, size - used, " 0C %02X %02X", raw >> 8, raw & 0xFF);
+                break;
+            }
+            case 0x0D:
+                used += snprintf(reply + used, size - used, " 0D %02X", speed);
+                break;
+            case 0x0E:
+                used += snprintf(reply + used, size - used, " 0E %02X", (15 + 64) * 2);
+                break;
+            case 0x11:
+                used += snprintf(reply + used, size - used, " 11 %02X", (unsigned)(state->throttle_pct * 255.0f / 100.0f));
+                break;
+            default:
+                continue;
+        }
+        any = true;
+    }
+    
+    if (!any) {
+        snprintf(reply, size, "NO DATA");
+    }
+}
+
+// Payload of one broadcast frame at the current model state
+static void broadcast_payload(uint32_t id, uint8_t *data) {
+    const vehicle_model_state_t *state = vehicle_model_state();
+    uint16_t rpm_raw = (uint16_t)(state->rpm * 4.0f);
+    uint16_t speed_raw = (uint16_t)(state->speed_kmh * 100.0f);
+    
+    memset(data, 0, 8);
+    switch (id) {
+        case 0x1A0:
+            data[0] = speed_raw >> 8;
+            data[1] = speed_raw & 0xFF;
+            data[7] = frame_counter++;
+            break;
+        case ELM327_SIM_RPM_CAN_ID:
+            data[0] = rpm_raw >> 8;
+            data[1] = rpm_raw & 0xFF;
+            data[2] = 0x40;
+            break;
+        case 0x2C4:
+            data[3] = (uint8_t)(state->throttle_pct * 2.0f);
+            break;
+        default:
+            data[0] = 0x12;
+            data[1] = 0x34;
+            break;
+    }
+}
+
+// One frame line as the adapter prints it ("3D9 1A F8 ..." with headers on)
+static int format_frame(const sim_adapter_t *a, uint32_t id, const uint8_t *data, int len,
+                        char *out, size_t size) {
+    int used = a->headers ? snprintf(out, size, "%03lX ", (unsigned long)id) : 0;
+    for (int i = 0; i < len; i++) {
+        used += snprintf(out + used, size - used, i > 0 ? " %02X" : "%02X", data[i]);
+    }
+    return used;
+}
+
+// ECU single frame as formatted under the current settings: CAF1 with headers
+// off shows the payload only, otherwise the PCI byte comes first, and CAF0
+// also shows the padding up to 8 bytes
+static void format_ecu_reply(const sim_adapter_t *a, char *reply, size_t size) {
+    uint8_t data[8];
+    int len = 1;
+    
+    if (strcmp(reply, "NO DATA") == 0 || strncmp(reply, "41", 2) != 0) {
+        return;
+    }
+    if (a->receive_filter != 0 && a->receive_filter != ELM327_SIM_ECU_CAN_ID) {
+        snprintf(reply, size, "NO DATA");
+        return;
+    }
+    if (a->auto_format && !a->headers) {
+        return;
+    }
+    for (const char *p = reply; p[0] && p[1] && len < 8; p += 3) {
+        char hex[3] = { p[0], p[1], '\0' };
+        data[len++] = (uint8_t)strtol(hex, NULL, 16);
+        if (p[2] == '\0') {
+            break;
+        }
+    }
+    data[0] = (uint8_t)(len - 1);
+    while (!a->auto_format && len < 8) {
+        data[len++] = 0x00;
+    }
+    format_frame(a, ELM327_SIM_ECU_CAN_ID, data, len, reply, size);
+}
+
+// Raw request with CAF0 ("02010C0000000000"): PCI byte, then mode and PIDs
+static void build_raw_reply(const char *cmd, char *reply, size_t size) {
+    char pids[16] = "";
+    int pci = 0;
+    
+    if (strlen(cmd) != 16 || sscanf(cmd, "%2x", &pci) != 1 || pci < 2 || pci > 7 ||
+        strncmp(cmd + 2, "01", 2) != 0) {
+        snprintf(reply, size, "NO DATA");
+        return;
+    }
+    memcpy(pids, cmd + 4, (size_t)(pci - 1) * 2);
+    pids[(pci - 1) * 2] = '\0';
+    build_mode01_reply(pids, reply, size);
+}
+
+// Mode 09 PID 02 as an ISO 15765-4 multi-frame reply with CAF1 and headers off:
+// length line, then "0:" with 6 payload bytes and "1:", "2:" with 7 each
+static void build_vin_reply(char *reply, size_t size) {
+    uint8_t payload[3 + sizeof(ELM327_SIM_VIN) - 1] = { 0x49, 0x02, 0x01 };
+    memcpy(payload + 3, ELM327_SIM_VIN, sizeof(ELM327_SIM_VIN) - 1);
+    size_t used = snprintf(reply, size, "%03X", (unsigned)sizeof(payload));
+    uint8_t segment = 0;
+    
+    for (size_t i = 0; i < sizeof(payload) && used < size; i++) {
+        if (i == 0 || (i >= 6 && (i - 6) % 7 == 0)) {
+            used += snprintf(reply + used, size - used, "\r%X:", segment++);
+        }
+        used += snprintf(reply + used, size - used, " %02X", payload[i]);
+    }
+}
+
+// Answer one command like an ELM327 with echo off
+static void build_reply(sim_adapter_t *a, const char *cmd, char *reply, size_t size) {
+    if (strncmp(cmd, "ATZ", 3) == 0) {
+        a->headers = false;
+        a->auto_format = true;
+        a->receive_filter = 0;
+        snprintf(reply, size, "ELM327 v1.5");
+    } else if (strcmp(cmd, "ATMA") == 0 || strcmp(cmd, "AT MA") == 0) {
+        a->monitor_requested = true;
+        reply[0] = '\0';
+    } else if (strcmp(cmd, "ATH0") == 0 || strcmp(cmd, "ATH1") == 0 ||
+               strcmp(cmd, "AT H0") == 0 || strcmp(cmd, "AT H1") == 0) {
+        a->headers = cmd[strlen(cmd) - 1] == '1';
+        snprintf(reply, size, "OK");
+    } else if (strcmp(cmd, "AT CAF0") == 0 || strcmp(cmd, "AT CAF1") == 0 ||
+               strcmp(cmd, "ATCAF0") == 0 || strcmp(cmd, "ATCAF1") == 0) {
+        a->auto_format = cmd[strlen(cmd) - 1] == '1';
+        snprintf(reply, size, "OK");
+    } else if (strncmp(cmd, "AT CRA", 6) == 0) {
+        a->receive_filter = (uint32_t)strtoul(cmd + 6, NULL, 16);
+        snprintf(reply, size, "OK");
+    } else if (strcmp(cmd, "AT AR") == 0 || strcmp(cmd, "ATAR") == 0) {
+        a->receive_filter = 0;
+        snprintf(reply, size, "OK");
+    } else if (strcmp(cmd, "AT RV") == 0 || strcmp(cmd, "ATRV") == 0) {
+        snprintf(reply, size, "%s", vehicle_model_state()->rpm > 0.0f ? "14.1V" : "12.4V");
+    } else if (strcmp(cmd, "AT DPN") == 0 || strcmp(cmd, "ATDPN") == 0) {
+        snprintf(reply, size, "A6");
+    } else if (strncmp(cmd, "AT ST ", 6) == 0) {
+        a->st_timeout_ms = (uint32_t)strtol(cmd + 6, NULL, 16) * 4;
+        snprintf(reply, size, "OK");
+    } else if (strncmp(cmd, "AT AT", 5) == 0 || strncmp(cmd, "ATAT", 4) == 0) {
+        char mode = cmd[strlen(cmd) - 1];
+        if (mode < '0' || mode > '2') {
+            snprintf(reply, size, "?");
+            return;
+        }
+        a->adaptive_mode = (uint8_t)(mode - '0');
+        snprintf(reply, size, "OK");
+    } else if (strncmp(cmd, "AT", 2) == 0) {
+        snprintf(reply, size, "OK");
+    } else if (!a->auto_format && strlen(cmd) == 16) {
+        build_raw_reply(cmd, reply, size);
+        format_ecu_reply(a, reply, size);
+    } else if (strncmp(cmd, "01", 2) == 0) {
+        build_mode01_reply(cmd + 2, reply, size);
+        format_ecu_reply(a, reply, size);
+    } else if (strcmp(cmd, "0902") == 0) {
+        build_vin_reply(reply, size);
+    } else {
+        snprintf(reply, size, "?");
+    }
+}
+
+// How long the adapter keeps listening after the last ECU frame of a Mode 01 reply
+static uint32_t listen_window_ms(sim_adapter_t *a, const char *cmd, uint32_t response_ms, bool answered) {
+    if (!answered) {
+        return a->st_timeout_ms;    // Nothing arrived: the full timeout runs out
+    }
+    if (strlen(cmd + 2) % 2 == 1) {
+        return 0;                   // Response-count digit: done after the expected frame
+    }
+    if (a->adaptive_mode == 0) {
+        return a->st_timeout_ms;
+    }
+    
+    // Learn the ECU response time (1/8 EWMA), start from AT ST like the adapter
+    a->learned_response_ms = (a->learned_response_ms * 7 + response_ms) / 8;
+    uint32_t pct = a->adaptive_mode == 2 ? ELM327_SIM_AT2_WAIT_PCT : ELM327_SIM_AT1_WAIT_PCT;
+    uint32_t window = a->learned_response_ms * pct / 100;
+    if (window < ELM327_SIM_AT_MIN_WAIT_MS) {
+        window = ELM327_SIM_AT_MIN_WAIT_MS;
+    }
+    return window < a->st_timeout_ms ? window : a->st_timeout_ms;
+}
+
+// Adapter -> host bytes (stand-in for ESP_SPP_DATA_IND_EVT)
+static void deliver(const sim_adapter_t *a, const char *data, int len) {
+    elm327_link_receive(&elm327_links[a->index], data, (uint16_t)len);
+}
+
+// Monitor mode: print the broadcast frames passing the filter each tick until
+// any input arrives (the interrupting characters are dropped), then STOPPED
+static void run_monitor(sim_adapter_t *a, TickType_t wake) {
+    char chunk[SIM_MONITOR_CHUNK];
+    sim_command_t input;
+    
+    a->monitor_requested = false;
+    while (a->link_open) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t next = wake + 1;
+        if (xQueueReceive(a->command_queue, &input, next > now ? next - now : 0) == pdTRUE) {
+            vTaskDelay(pdMS_TO_TICKS(ELM327_SIM_STOP_MS));
+            if (a->link_open) {
+                deliver(a, chunk, snprintf(chunk, sizeof(chunk), "STOPPED\r\r>"));
+            }
+            return;
+        }
+        wake = next;
+        
+        int64_t time_us = sim_time_us(wake);
+        uint32_t time_ms = (uint32_t)((time_us - tick_base_us) / 1000);
+        int used = 0;
+        vehicle_model_advance_to(time_us);
+        for (size_t i = 0; i < BROADCAST_COUNT; i++) {
+            const sim_broadcast_t *b = &broadcasts[i];
+            if (time_ms % b->period_ms != 0 || (a->receive_filter != 0 && a->receive_filter != b->id) ||
+                used + SIM_FRAME_LINE_MAX > (int)sizeof(chunk)) {
+                continue;
+            }
+            uint8_t data[8];
+            broadcast_payload(b->id, data);
+            used += format_frame(a, b->id, data, 8, chunk + used, sizeof(chunk) - used);
+            chunk[used++] = '\r';
+        }
+        if (used > 0 && a->link_open) {
+            deliver(a, chunk, used);
+        }
+    }
+}
+
+// Simulated adapter: one request at a time, reply after modeled latency
+static void elm327_sim_task(void *pv) {
+    sim_adapter_t *a = (sim_adapter_t *)pv;
+    bool primary = a->index == ELM327_LINK_PRIMARY;
+    sim_command_t cmd;
+    char reply[SIM_REPLY_MAX];
+    char frame[SIM_REPLY_MAX + 4];
+    
+    while (1) {
+        if (xQueueReceive(a->command_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        
+        TickType_t wake = xTaskGetTickCount();
+        elm327_sim_fault_t fault = primary ? active_fault : ELM327_SIM_FAULT_NONE;
+        
+        // Timed faults expire on their own
+        if (fault != ELM327_SIM_FAULT_NONE && fault != ELM327_SIM_FAULT_LINK_CLOSE &&
+            sim_time_us(wake) >= fault_until_us) {
+            active_fault = ELM327_SIM_FAULT_NONE;
+            fault = ELM327_SIM_FAULT_NONE;
+        }
+        if (fault == ELM327_SIM_FAULT_HANG) {
+            continue;   // Request lost, host waits for a prompt that never comes
+        }
+        
+        uint32_t latency_ms = ELM327_SIM_LATENCY_MS + prng_next(a) % (ELM327_SIM_JITTER_MS + 1);
+        uint32_t request_ms = latency_ms * ELM327_SIM_ECU_SHARE_PCT / 100;
+        
+        // ECU answers from the model state at the tick the request reaches it
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(request_ms));
+        vehicle_model_advance_to(sim_time_us(wake));
+        if (fault == ELM327_SIM_FAULT_NO_DATA && strncmp(cmd.text, "01", 2) == 0) {
+            snprintf(reply, sizeof(reply), "NO DATA");
+        } else {
+            build_reply(a, cmd.text, reply, sizeof(reply));
+            if (primary) {
+                last_sample_us = vehicle_model_state()->time_us;
+            }
+        }
+        
+        uint32_t reply_ms = latency_ms - request_ms;
+        if (strncmp(cmd.text, "01", 2) == 0) {
+            reply_ms += listen_window_ms(a, cmd.text, latency_ms, strcmp(reply, "NO DATA") != 0);
+        }
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(reply_ms));
+        
+        if (!a->link_open) {
+            continue;   // Link dropped while the reply was in flight
+        }
+        if (a->monitor_requested) {
+            run_monitor(a, wake);
+            continue;
+        }
+        int len = snprintf(frame, sizeof(frame), "%s\r\r>", reply);
+        LOG_DEBUG(TAG, "#%u %s -> %s (%lu ms)", a->index, cmd.text, reply, request_ms + reply_ms);
+        deliver(a, frame, len);
+    }
+}
+
+// Host -> adapter write (replaces esp_spp_write while simulated)
+esp_err_t elm327_sim_write(uint8_t index, const uint8_t *data, uint16_t len) {
+    if (index >= SIM_ADAPTER_COUNT || adapters[index].command_queue == NULL || !adapters[index].link_open) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    sim_command_t cmd;
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < len && n < SIM_CMD_MAX - 1; i++) {
+        if (data[i] != '\r' && data[i] != '\n') {
+            cmd.text[n++] = (char)data[i];
+        }
+    }
+    cmd.text[n] = '\0';
+    
+    return xQueueSend(adapters[index].command_queue, &cmd, 0) == pdTRUE ? ESP_OK : ESP_FAIL;
+}
+
+// Ground truth accessors (called from the simulator task via the parser)
+int64_t elm327_sim_last_sample_us(void) {
+    return last_sample_us;
+}
+
+int64_t elm327_sim_crossing_us(void) {
+    return vehicle_model_last_crossing_us();
+}
+
+// Mirror ESP_SPP_OPEN_EVT: mark connected and schedule adapter initialization
+static void sim_link_open(sim_adapter_t *a) {
+    elm327_link_t *link = &elm327_links[a->index];
+    a->link_open = true;
+    elm327_link_opened(link, ELM327_SIM_HANDLE + a->index);
+    is_searching = false;
+    xTaskCreate(initialize_elm327_task, "elm327_init", 4096, link, 5, NULL);
+}
+
+// Mirror ESP_SPP_CLOSE_EVT (without the reconnect logic, the caller reopens)
+static void sim_link_close(sim_adapter_t *a) {
+    elm327_link_t *link = &elm327_links[a->index];
+    a->link_open = false;
+    link->connecting = false;
+    link->connected = false;
+    link->initialized = false;
+    if (a->index == ELM327_LINK_PRIMARY) {
+        link_policy_on_disconnected();
+    }
+    xQueueReset(a->command_queue);
+}
+
+void elm327_sim_inject_fault(elm327_sim_fault_t fault, uint32_t duration_ms) {
+    LOG_WARN(TAG, "Injecting fault %d for %lu ms", (int)fault, duration_ms);
+    fault_until_us = sim_time_us(xTaskGetTickCount()) + (int64_t)duration_ms * 1000;
+    active_fault = fault;
+    if (fault == ELM327_SIM_FAULT_LINK_CLOSE) {
+        sim_link_close(&adapters[ELM327_LINK_PRIMARY]);
+    }
+}
+
+// Called between bench runs so every run sees the same drive and jitter
+void elm327_sim_reset_model(void) {
+    for (int i = 0; i < SIM_ADAPTER_COUNT; i++) {
+        adapters[i].prng_state = ELM327_SIM_SEED + i;
+        adapters[i].learned_response_ms = adapters[i].st_timeout_ms;
+    }
+    last_sample_us = 0;
+    vehicle_model_init(sim_time_us(xTaskGetTickCount()), LAUNCH_RPM_LIMIT);
+}
+
+// Links closed from the host side (radio off); stay closed until reopened
+void elm327_sim_link_close(void) {
+    for (int i = 0; i < SIM_ADAPTER_COUNT; i++) {
+        if (adapters[i].link_open) {
+            LOG_WARN(TAG, "Simulated link #%d closed", i);
+            sim_link_close(&adapters[i]);
+        }
+    }
+}
+
+void elm327_sim_link_reopen(void) {
+    active_fault = ELM327_SIM_FAULT_NONE;
+    for (int i = 0; i < SIM_ADAPTER_COUNT; i++) {
+        if (!adapters[i].link_open) {
+            LOG_WARN(TAG, "Simulated link #%d reopened", i);
+            sim_link_open(&adapters[i]);
+        }
+    }
+}
+
+// Bring up the simulated links exactly like RFCOMM open events
+void elm327_sim_start(void) {
+    for (int i = 0; i < SIM_ADAPTER_COUNT; i++) {
+        sim_adapter_t *a = &adapters[i];
+        a->index = (uint8_t)i;
+        a->command_queue = xQueueCreate(SIM_QUEUE_LEN, sizeof(sim_command_t));
+        if (a->command_queue == NULL) {
+            LOG_ERROR(TAG, "Failed to create simulator queue #%d", i);
+            return;
+        }
+        a->st_timeout_ms = ELM327_SIM_DEFAULT_ST_MS;
+        a->adaptive_mode = 1;
+        a->auto_format = true;
+    }
+    tick_base_us = esp_timer_get_time() - (int64_t)xTaskGetTickCount() * portTICK_PERIOD_MS * 1000;
+    elm327_sim_reset_model();
+    
+    for (int i = 0; i < SIM_ADAPTER_COUNT; i++) {
+        xTaskCreate(elm327_sim_task, "elm327_sim", 3072, &adapters[i], 6, NULL);
+    }
+    
+    LOG_WARN(TAG, "Running against SIMULATED ELM327 x%d (seed 0x%08lX)", SIM_ADAPTER_COUNT,
+             (unsigned long)ELM327_SIM_SEED);
+    for (int i = 0; i < SIM_ADAPTER_COUNT; i++) {
+        sim_link_open(&adapters[i]);
+    }
+}
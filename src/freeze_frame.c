@@ -0,0 +1,194 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "logging_config.h"
+#include "freeze_frame.h"
+#include "obd_data.h"
+#include "launch_control.h"
+#include "task_watchdog.h"
+
+static const char *TAG = "FREEZE";
+
+// Capture state machine
+typedef enum {
+    CAPTURE_IDLE = 0,    // Waiting for an output activation
+    CAPTURE_POST,        // Trigger marked, recording the post-window
+    CAPTURE_READY        // Post-window complete, waiting for the flush task
+} capture_state_t;
+
+// Rolling sample ring (head only ever increments; index with & mask)
+static freeze_sample_t sample_ring[FREEZE_RING_SIZE];
+static uint32_t ring_head = 0;
+
+// Pending capture (indices into the ring, no copies)
+static portMUX_TYPE freeze_lock = portMUX_INITIALIZER_UNLOCKED;
+static capture_state_t capture_state = CAPTURE_IDLE;
+static uint32_t trigger_index = 0;
+static uint32_t trigger_ms = 0;
+static uint32_t end_index = 0;
+static uint32_t dropped_triggers = 0;
+
+// Flush task and its copy buffer
+static TaskHandle_t flush_task_handle = NULL;
+static uint32_t capture_count = 0;
+static struct {
+    freeze_capture_header_t header;
+    freeze_sample_t samples[FREEZE_MAX_CAPTURE_SAMPLES];
+} flush_buffer;
+
+#define RING_MASK (FREEZE_RING_SIZE - 1)
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// Initialize freeze-frame capture
+void freeze_frame_init(void) {
+    memset(sample_ring, 0, sizeof(sample_ring));
+    ring_head = 0;
+    capture_state = CAPTURE_IDLE;
+    dropped_triggers = 0;
+    
+    // Continue capture numbering from flash
+    nvs_handle_t nvs;
+    if (nvs_open(FREEZE_NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK) {
+        nvs_get_u32(nvs, "count", &capture_count);
+        nvs_close(nvs);
+    }
+    
+    LOG_VERBOSE(TAG, "Freeze-frame capture initialized (%lu captures stored)", capture_count);
+}
+
+// Append the current vehicle data to the ring (called for every decoded sample)
+void freeze_frame_record_sample(void) {
+    uint32_t t = now_ms();
+    bool notify = false;
+    
+    portENTER_CRITICAL(&freeze_lock);
+    freeze_sample_t *s = &sample_ring[ring_head & RING_MASK];
+    s->time_ms = t;
+    s->rpm = (uint16_t)vehicle_data.rpm;
+    s->throttle_position = vehicle_data.throttle_position;
+    s->vehicle_speed = vehicle_data.vehicle_speed;
+    s->timing_advance = vehicle_data.timing_advance;
+    s->launch_state = (uint8_t)launch_control_get_state();
+    s->coolant_temp = vehicle_data.coolant_temp;
+    ring_head++;
+    
+    // Close the post-window by time or by capture size
+    if (capture_state == CAPTURE_POST &&
+        ((t - trigger_ms) >= FREEZE_POST_MS ||
+         (ring_head - trigger_index) >= FREEZE_MAX_CAPTURE_SAMPLES / 2)) {
+        end_index = ring_head;
+        capture_state = CAPTURE_READY;
+        notify = true;
+    }
+    portEXIT_CRITICAL(&freeze_lock);
+    
+    if (notify && flush_task_handle != NULL) {
+        xTaskNotifyGive(flush_task_handle);
+    }
+}
+
+// Mark an output activation (safe inside other critical sections: indices only)
+void freeze_frame_trigger(void) {
+    portENTER_CRITICAL(&freeze_lock);
+    if (capture_state == CAPTURE_IDLE) {
+        trigger_index = ring_head;
+        trigger_ms = now_ms();
+        capture_state = CAPTURE_POST;
+    } else {
+        dropped_triggers++;
+    }
+    portEXIT_CRITICAL(&freeze_lock);
+}
+
+// Copy the pre/post window out of the ring and store it in NVS
+static void flush_capture(void) {
+    uint32_t start, end, trig, trig_ms;
+    
+    portENTER_CRITICAL(&freeze_lock);
+    end = end_index;
+    trig = trigger_index;
+    trig_ms = trigger_ms;
+    portEXIT_CRITICAL(&freeze_lock);
+    
+    // Walk back from the trigger over the pre-window, leaving room for the post-window.
+    // The writer needs FREEZE_RING_SIZE - FREEZE_MAX_CAPTURE_SAMPLES more samples
+    // before it can reach 'start', so the copy below never races it.
+    start = trig;
+    while (start > 0 && (end - start) < FREEZE_MAX_CAPTURE_SAMPLES &&
+           (trig_ms - sample_ring[(start - 1) & RING_MASK].time_ms) <= FREEZE_PRE_MS) {
+        start--;
+    }
+    
+    uint16_t count = 0;
+    for (uint32_t i = start; i != end; i++) {
+        flush_buffer.samples[count++] = sample_ring[i & RING_MASK];
+    }
+    
+    flush_buffer.header.capture_id = capture_count;
+    flush_buffer.header.trigger_ms = trig_ms;
+    flush_buffer.header.sample_count = count;
+    flush_buffer.header.trigger_offset = (uint16_t)(trig - start);
+    
+    // Ring is free for the next trigger as soon as the copy is done
+    portENTER_CRITICAL(&freeze_lock);
+    capture_state = CAPTURE_IDLE;
+    portEXIT_CRITICAL(&freeze_lock);
+    
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(FREEZE_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return;
+    }
+    
+    char key[8];
+    snprintf(key, sizeof(key), "ff%lu", capture_count % FREEZE_NVS_SLOTS);
+    size_t size = sizeof(freeze_capture_header_t) + count * sizeof(freeze_sample_t);
+    ret = nvs_set_blob(nvs, key, &flush_buffer, size);
+    if (ret == ESP_OK) {
+        capture_count++;
+        nvs_set_u32(nvs, "count", capture_count);
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    
+    if (ret == ESP_OK) {
+        LOG_INFO(TAG, "Capture #%lu stored in '%s': %u samples (%u pre-trigger, %lu dropped triggers)",
+                 flush_buffer.header.capture_id, key, count,
+                 flush_buffer.header.trigger_offset, dropped_triggers);
+    } else {
+        LOG_ERROR(TAG, "Failed to store capture: %s", esp_err_to_name(ret));
+    }
+}
+
+// Background flush task (low priority, off the trigger path)
+void freeze_frame_task(void *pv) {
+    flush_task_handle = xTaskGetCurrentTaskHandle();
+    LOG_VERBOSE(TAG, "Freeze-frame flush task started");
+    
+    while (1) {
+        task_watchdog_beat(WDT_TASK_FREEZE, "flush_wait", 1000);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        
+        // Close the window by time if samples stopped arriving
+        portENTER_CRITICAL(&freeze_lock);
+        if (capture_state == CAPTURE_POST && (now_ms() - trigger_ms) >= FREEZE_POST_MS) {
+            end_index = ring_head;
+            capture_state = CAPTURE_READY;
+        }
+        bool ready = (capture_state == CAPTURE_READY);
+        portEXIT_CRITICAL(&freeze_lock);
+        
+        if (ready) {
+            flush_capture();
+        }
+    }
+}
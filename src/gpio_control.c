@@ -3,12 +3,18 @@
 #include "logging_config.h"
 #include "gpio_control.h"
 #include "bluetooth.h"
+#include "elm327.h"
+#include "freeze_frame.h"
+#include "task_watchdog.h"
 
 static const char *TAG = "GPIO";
 
 // GPIO state
 bool gpio_status = false;
 
+// Current level of pins driven through gpio_output_set (bit per pin)
+static uint64_t output_levels = 0;
+
 // Initialize GPIO system
 void gpio_init_system(void) {
     LOG_VERBOSE(TAG, "Initializing GPIO...");
@@ -44,6 +50,58 @@ void led_off(void) {
     gpio_status = false;
 }
 
+// Configure a pin as a push-pull output, initially inactive (LOW)
+void gpio_output_init(gpio_num_t pin) {
+    gpio_config_t io_conf = {};
+    io_conf.intr_type = GPIO_INTR_DISABLE;
+    io_conf.mode = GPIO_MODE_OUTPUT;
+    io_conf.pin_bit_mask = (1ULL << pin);
+    io_conf.pull_down_en = 0;
+    io_conf.pull_up_en = 0;
+
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret == ESP_OK) {
+        gpio_set_level(pin, 0);
+        LOG_VERBOSE(TAG, "Output configured on pin %d", pin);
+    } else {
+        LOG_ERROR(TAG, "Failed to configure output pin %d: %s", pin, esp_err_to_name(ret));
+    }
+}
+
+// Configure a pin as a digital input (optionally with internal pull-up)
+void gpio_input_init(gpio_num_t pin, bool pull_up) {
+    gpio_config_t io_conf = {};
+    io_conf.intr_type = GPIO_INTR_DISABLE;
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pin_bit_mask = (1ULL << pin);
+    io_conf.pull_down_en = 0;
+    io_conf.pull_up_en = pull_up ? 1 : 0;
+
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret == ESP_OK) {
+        LOG_VERBOSE(TAG, "Input configured on pin %d", pin);
+    } else {
+        LOG_ERROR(TAG, "Failed to configure input pin %d: %s", pin, esp_err_to_name(ret));
+    }
+}
+
+// Drive an output pin (safe to call from critical sections)
+void gpio_output_set(gpio_num_t pin, bool active) {
+    uint64_t bit = 1ULL << pin;
+    bool was_active = (output_levels & bit) != 0;
+    
+    gpio_set_level(pin, active ? 1 : 0);
+    
+    if (active) {
+        output_levels |= bit;
+        if (!was_active) {
+            freeze_frame_trigger();  // Mark capture window on every activation
+        }
+    } else {
+        output_levels &= ~bit;
+    }
+}
+
 // Pulse LED for specified duration
 void led_pulse(int duration_ms) {
     led_on();
@@ -77,15 +135,19 @@ void led_set_connected(bool connected) {
 void led_search_task(void *pv) {
     LOG_VERBOSE(TAG, "LED search indicator task started");
     
+    const elm327_link_t *primary = &elm327_links[ELM327_LINK_PRIMARY];
+    
     while (1) {
+        task_watchdog_beat(WDT_TASK_LED, "led_cycle", 1000);
+        
         // Only pulse LED when searching and not connected
-        if (is_searching && !is_connected && !is_connecting) {
+        if (is_searching && !primary->connected && !primary->connecting) {
             // Pulse LED to indicate searching
             led_on();
             vTaskDelay(pdMS_TO_TICKS(200));  // On for 200ms
             led_off();
             vTaskDelay(pdMS_TO_TICKS(800));  // Off for 800ms (1 second total cycle)
-        } else if (is_connected) {
+        } else if (primary->connected) {
             // Keep LED solid on when connected
             if (!gpio_status) {
                 led_on();
@@ -0,0 +1,69 @@
+#include "esp_log.h"
+#include <string.h>
+
+#include "logging_config.h"
+#include "histogram.h"
+
+// Reset a histogram
+void histogram_init(histogram_t *h, uint32_t bucket_width) {
+    memset(h, 0, sizeof(*h));
+    h->bucket_width = bucket_width > 0 ? bucket_width : 1;
+}
+
+// Record one value (O(1))
+void histogram_record(histogram_t *h, uint32_t value) {
+    uint32_t index = value / h->bucket_width;
+    if (index >= HISTOGRAM_BUCKETS) {
+        index = HISTOGRAM_BUCKETS - 1;
+    }
+    h->buckets[index]++;
+    h->count++;
+    h->total += value;
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+// Upper edge of the bucket holding the given percentile (capped at the true max)
+uint32_t histogram_percentile(const histogram_t *h, uint32_t percent) {
+    if (h->count == 0) {
+        return 0;
+    }
+    
+    uint64_t target = ((uint64_t)h->count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= target) {
+            uint32_t edge = (i + 1) * h->bucket_width;
+            return edge < h->max ? edge : h->max;
+        }
+    }
+    return h->max;
+}
+
+void histogram_log_header(const char *tag, const char *unit) {
+    LOG_INFO(tag, "%-24s | %7s | %8s | %8s | %8s | %8s  (%s)",
+             "", "n", "p50", "p95", "p99", "max", unit);
+}
+
+void histogram_log_row(const char *tag, const char *label, const histogram_t *h) {
+    LOG_INFO(tag, "%-24s | %7lu | %8lu | %8lu | %8lu | %8lu",
+             label, h->count,
+             histogram_percentile(h, 50), histogram_percentile(h, 95),
+             histogram_percentile(h, 99), h->max);
+}
+
+void histogram_log_shift(const char *tag, const char *label, const histogram_t *base,
+                         const histogram_t *loaded, const char *unit) {
+    if (base->count == 0 || loaded->count == 0) {
+        return;
+    }
+    int32_t delta50 = (int32_t)histogram_percentile(loaded, 50) - (int32_t)histogram_percentile(base, 50);
+    int32_t delta99 = (int32_t)histogram_percentile(loaded, 99) - (int32_t)histogram_percentile(base, 99);
+    if (delta50 > (int32_t)base->bucket_width) {
+        LOG_WARN(tag, "%s: p50 %+ld %s, p99 %+ld %s (median shifted)", label, delta50, unit, delta99, unit);
+    } else {
+        LOG_INFO(tag, "%s: p50 %+ld %s, p99 %+ld %s", label, delta50, unit, delta99, unit);
+    }
+}
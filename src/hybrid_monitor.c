@@ -0,0 +1,385 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "logging_config.h"
+#include "hybrid_monitor.h"
+#include "elm327.h"
+#include "obd_data.h"
+#include "auto_tuner.h"
+#include "spp_proxy.h"
+#include "histogram.h"
+#include "task_watchdog.h"
+
+static const char *TAG = "HYBRID";
+
+#define PROMPT_WAIT_MS 2000     // elm327_link_send bound per command
+
+// Slow channels, one single-frame request per gap. Written as raw CAN data
+// (PCI byte, padding) because the adapter stays in CAF0 while hybrid.
+static const char *const poll_batches[] = {
+    "0401110D0E000000",     // Throttle, speed, timing advance
+    "0301110500000000",     // Throttle, coolant
+};
+#define POLL_BATCH_COUNT (sizeof(poll_batches) / sizeof(poll_batches[0]))
+
+static broadcast_signal_t rpm_signal;
+static bool signal_set = false;
+
+// Session state (obd_task)
+static bool engaged = false;
+static uint32_t engaged_generation = 0;
+static bool disabled = false;               // Frame absent on this connection
+static uint32_t disabled_generation = 0;
+static uint8_t batch_phase = 0;
+static uint8_t silent_windows = 0;
+static uint32_t window_ms = HYBRID_MONITOR_WINDOW_MS;
+static uint32_t blackout_avg_ms = 0;
+
+// Gap waiting for the first frame after the restart
+static bool gap_open = false;
+static int64_t gap_off_us = 0;              // Last frame before the interrupt
+static int64_t gap_restart_us = 0;          // ATMA sent
+
+// Receive path state
+static volatile bool monitoring = false;
+static volatile bool stopped = false;
+static volatile int64_t stopped_us = 0;
+static volatile int64_t last_frame_us = 0;
+static volatile int64_t first_frame_us = 0; // First frame since the last restart (0 = none yet)
+static volatile uint32_t frames = 0;
+static volatile uint32_t overflows = 0;
+
+// Gap statistics (obd_task)
+static histogram_t stop_hist;               // Interrupt character to STOPPED
+static histogram_t poll_hist;               // STOPPED to ATMA sent (polls, filter swap)
+static histogram_t restart_hist;            // ATMA sent to first frame
+static histogram_t blackout_hist;           // Last frame before to first frame after
+static uint64_t off_ms_total = 0;
+static uint64_t cycle_ms_total = 0;
+static uint32_t report_frames = 0;
+static int64_t report_start_us = 0;
+
+void hybrid_monitor_init(void) {
+    histogram_init(&stop_hist, HYBRID_MONITOR_BUCKET_MS);
+    histogram_init(&poll_hist, HYBRID_MONITOR_BUCKET_MS);
+    histogram_init(&restart_hist, HYBRID_MONITOR_BUCKET_MS);
+    histogram_init(&blackout_hist, HYBRID_MONITOR_BUCKET_MS);
+    report_start_us = esp_timer_get_time();
+
+    if (HYBRID_RPM_CAN_ID != 0) {
+        broadcast_signal_t configured = {
+            .can_id = HYBRID_RPM_CAN_ID,
+            .start_byte = HYBRID_RPM_START_BYTE,
+            .width = HYBRID_RPM_WIDTH,
+            .little_endian = HYBRID_RPM_LITTLE_ENDIAN,
+            .scale = HYBRID_RPM_SCALE,
+            .offset = HYBRID_RPM_OFFSET,
+        };
+        hybrid_monitor_set_signal(&configured);
+    }
+    LOG_VERBOSE(TAG, "Hybrid monitor initialized");
+}
+
+void hybrid_monitor_set_signal(const broadcast_signal_t *signal) {
+    disabled = false;
+    if (signal == NULL) {
+        signal_set = false;
+        return;
+    }
+    rpm_signal = *signal;
+    signal_set = true;
+    LOG_INFO(TAG, "Broadcast RPM: ID %lX byte %u, %u bit %s, x%.4f %+.1f",
+             rpm_signal.can_id, rpm_signal.start_byte, rpm_signal.width,
+             rpm_signal.little_endian ? "LE" : "BE", rpm_signal.scale, rpm_signal.offset);
+}
+
+// Broadcast RPM only pays off with the engine running and no second adapter
+bool hybrid_monitor_wanted(power_state_t power_state) {
+    const elm327_link_t *link = &elm327_links[ELM327_LINK_PRIMARY];
+    if (disabled && disabled_generation != link->generation) {
+        disabled = false;   // New connection: try the frame again
+    }
+    return signal_set && !disabled && power_state == POWER_STATE_ENGINE_RUNNING &&
+           !elm327_link_is_up(ELM327_LINK_SECONDARY);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// Data bytes of a frame line ("1A F8 00" or "1AF800"); -1 if not a frame
+static int parse_frame(const char *line, uint8_t *bytes) {
+    int count = 0;
+    for (const char *p = line; *p; ) {
+        if (*p == ' ') {
+            p++;
+            continue;
+        }
+        int hi = hex_value(p[0]);
+        int lo = hi < 0 ? -1 : hex_value(p[1]);
+        if (lo < 0 || count == 8) {
+            return -1;
+        }
+        bytes[count++] = (uint8_t)(hi << 4 | lo);
+        p += 2;
+    }
+    return count;
+}
+
+static bool decode_rpm(const uint8_t *bytes, int count, uint32_t *rpm) {
+    if (count < rpm_signal.start_byte + rpm_signal.width / 8) {
+        return false;
+    }
+    const uint8_t *b = &bytes[rpm_signal.start_byte];
+    uint32_t raw = b[0];
+    if (rpm_signal.width == 16) {
+        raw = rpm_signal.little_endian ? (uint32_t)(b[0] | b[1] << 8) : (uint32_t)(b[0] << 8 | b[1]);
+    }
+    float value = raw * rpm_signal.scale + rpm_signal.offset;
+    *rpm = value > 0.0f ? (uint32_t)(value + 0.5f) : 0;
+    return true;
+}
+
+// Receive path (BT callback context: no logging)
+bool hybrid_monitor_on_line(const char *line) {
+    uint8_t bytes[8];
+    uint32_t rpm;
+
+    if (!engaged) {
+        return false;
+    }
+    int count = parse_frame(line, bytes);
+    int64_t now_us = esp_timer_get_time();
+
+    if (strstr(line, "STOPPED")) {
+        stopped_us = now_us;
+        stopped = true;
+        monitoring = false;
+        return true;
+    }
+    if (monitoring) {
+        if (count > 0) {
+            if (first_frame_us == 0) {
+                first_frame_us = now_us;
+            }
+            last_frame_us = now_us;
+            frames++;
+            if (decode_rpm(bytes, count, &rpm)) {
+                obd_data_on_broadcast_rpm(rpm, now_us);
+            }
+            return true;
+        }
+        if (strstr(line, "BUFFER FULL")) {
+            overflows++;
+            monitoring = false;     // Adapter left monitor mode, prompt follows
+            return true;
+        }
+        return false;
+    }
+
+    // Raw poll reply "<PCI> 41 <pid> <data>...": trim padding, parse from "41"
+    if (count >= 3 && bytes[0] >= 2 && bytes[0] < count && bytes[1] == 0x41) {
+        char reply[32];
+        int len = 0;
+        for (int i = 1; i <= bytes[0]; i++) {
+            len += snprintf(reply + len, sizeof(reply) - len, i > 1 ? " %02X" : "%02X", bytes[i]);
+        }
+        obd_data_parse_line(ELM327_LINK_PRIMARY, reply);
+        return true;
+    }
+    return false;
+}
+
+// Only frames from the signal's ID reach the monitor output
+static void send_filter(void) {
+    char cmd[24];
+    snprintf(cmd, sizeof(cmd), rpm_signal.can_id > 0x7FF ? "AT CRA %08lX" : "AT CRA %03lX", rpm_signal.can_id);
+    elm327_send_command(cmd);
+}
+
+// Start monitoring; the adapter gives no prompt until it is interrupted
+static void start_monitor(void) {
+    first_frame_us = 0;
+    stopped = false;
+    monitoring = true;
+    elm327_send_command("ATMA");
+    gap_restart_us = esp_timer_get_time();
+    elm327_links[ELM327_LINK_PRIMARY].command_sent_us = 0;  // Not a round trip
+}
+
+// Any character stops the monitor; STOPPED and a prompt follow
+static void stop_monitor(elm327_link_t *link) {
+    if (!monitoring) {
+        return;     // Already out (BUFFER FULL): a bare CR now would repeat ATMA
+    }
+    int64_t abort_us = esp_timer_get_time();
+    elm327_link_abort(link);
+
+    elm327_link_wait_ready(link, pdMS_TO_TICKS(HYBRID_MONITOR_STOP_TIMEOUT_MS));
+    monitoring = false;
+    if (stopped || link->ready) {
+        int64_t end_us = stopped ? stopped_us : esp_timer_get_time();
+        histogram_record(&stop_hist, (uint32_t)((end_us - abort_us) / 1000));
+    } else {
+        LOG_WARN(TAG, "No STOPPED within %d ms of the interrupt", HYBRID_MONITOR_STOP_TIMEOUT_MS);
+    }
+}
+
+// Raw frames, short poll timeout, filtered monitor
+static void engage(elm327_link_t *link) {
+    LOG_INFO(TAG, "Hybrid acquisition on: RPM from broadcast ID %lX, polled channels in monitor gaps",
+             rpm_signal.can_id);
+    task_watchdog_beat(WDT_TASK_OBD, "hybrid_setup", 4 * PROMPT_WAIT_MS);
+    elm327_send_command("AT CAF0");     // Broadcast data is not ISO-TP formatted
+    elm327_send_command("AT ST " HYBRID_MONITOR_ATST);
+    send_filter();
+    start_monitor();
+
+    engaged = true;
+    engaged_generation = link->generation;
+    gap_open = false;
+    silent_windows = 0;
+    blackout_avg_ms = 0;
+    window_ms = HYBRID_MONITOR_WINDOW_MS;
+}
+
+void hybrid_monitor_disengage(void) {
+    elm327_link_t *link = &elm327_links[ELM327_LINK_PRIMARY];
+
+    if (!engaged) {
+        return;
+    }
+    if (link->generation != engaged_generation || !elm327_link_is_up(ELM327_LINK_PRIMARY)) {
+        engaged = false;        // Adapter settings went with the connection
+        monitoring = false;
+        return;
+    }
+
+    task_watchdog_beat(WDT_TASK_OBD, "hybrid_exit", HYBRID_MONITOR_STOP_TIMEOUT_MS + 3 * PROMPT_WAIT_MS);
+    stop_monitor(link);
+    engaged = false;
+    char atst_cmd[16];
+    snprintf(atst_cmd, sizeof(atst_cmd), "AT ST %s", auto_tuner_active()->atst);
+    elm327_send_command("AT AR");
+    elm327_send_command("AT CAF1");
+    elm327_send_command(atst_cmd);
+    LOG_INFO(TAG, "Hybrid acquisition off, back to polling");
+}
+
+// The previous gap ends with the first frame of this window
+static void close_gap(void) {
+    if (!gap_open) {
+        return;
+    }
+    gap_open = false;
+    int64_t first_us = first_frame_us;
+    if (first_us == 0) {
+        return;     // Nothing received (counted as a silent window)
+    }
+
+    uint32_t blackout_ms = (uint32_t)((first_us - gap_off_us) / 1000);
+    histogram_record(&restart_hist, (uint32_t)((first_us - gap_restart_us) / 1000));
+    histogram_record(&blackout_hist, blackout_ms);
+    off_ms_total += blackout_ms;
+    blackout_avg_ms = blackout_avg_ms ? (blackout_avg_ms * 7 + blackout_ms) / 8 : blackout_ms;
+
+    // Longer windows until the gaps stay below their share of the time
+    uint32_t needed_ms = blackout_avg_ms * (100 - HYBRID_MONITOR_MAX_OFF_PCT) / HYBRID_MONITOR_MAX_OFF_PCT;
+    window_ms = needed_ms < HYBRID_MONITOR_WINDOW_MS ? HYBRID_MONITOR_WINDOW_MS :
+                needed_ms > HYBRID_MONITOR_WINDOW_MAX_MS ? HYBRID_MONITOR_WINDOW_MAX_MS : needed_ms;
+}
+
+// One monitor window, then one gap: stop, poll, restart
+void hybrid_monitor_cycle(bool voltage_due) {
+    elm327_link_t *link = &elm327_links[ELM327_LINK_PRIMARY];
+    int64_t cycle_start_us = esp_timer_get_time();
+
+    if (!engaged || engaged_generation != link->generation) {
+        engage(link);
+    }
+
+    // RPM arrives through the receive path at the broadcast rate meanwhile
+    uint32_t frames_before = frames;
+    task_watchdog_beat(WDT_TASK_OBD, "monitoring", window_ms);
+    vTaskDelay(pdMS_TO_TICKS(window_ms));
+    close_gap();
+
+    if (frames == frames_before) {
+        if (++silent_windows >= HYBRID_MONITOR_SILENT_WINDOWS) {
+            LOG_WARN(TAG, "No frames from ID %lX in %d windows, falling back to polling",
+                     rpm_signal.can_id, HYBRID_MONITOR_SILENT_WINDOWS);
+            hybrid_monitor_disengage();
+            disabled = true;
+            disabled_generation = link->generation;
+            return;
+        }
+    } else {
+        silent_windows = 0;
+    }
+
+    int64_t off_us = monitoring && last_frame_us > 0 ? last_frame_us : esp_timer_get_time();
+    task_watchdog_beat(WDT_TASK_OBD, "monitor_gap", HYBRID_MONITOR_STOP_TIMEOUT_MS + 6 * PROMPT_WAIT_MS);
+    stop_monitor(link);
+    int64_t poll_start_us = esp_timer_get_time();
+
+    if (voltage_due) {
+        elm327_send_command("AT RV");   // No CAN traffic: the filter can stay
+    } else {
+        elm327_send_command("AT AR");   // Let the ECU reply through
+        elm327_send_command(poll_batches[batch_phase]);
+        batch_phase = (batch_phase + 1) % POLL_BATCH_COUNT;
+
+        // Phone requests are formatted by the adapter, so only when one waits
+        if (obd_get_poll_profile() == OBD_PROFILE_NORMAL && spp_proxy_forward_pending()) {
+            elm327_send_command("AT CAF1");
+            spp_proxy_service_slot(link, HYBRID_MONITOR_PROXY_BUDGET_MS);
+            elm327_send_command("AT CAF0");
+        }
+        send_filter();
+    }
+    start_monitor();
+
+    histogram_record(&poll_hist, (uint32_t)((gap_restart_us - poll_start_us) / 1000));
+    gap_off_us = off_us;
+    gap_open = true;
+    cycle_ms_total += (uint64_t)(esp_timer_get_time() - cycle_start_us) / 1000;
+}
+
+// Gap phases and the resulting RPM blackout (obd_task context)
+void hybrid_monitor_log_report(void) {
+    int64_t now_us = esp_timer_get_time();
+    uint32_t elapsed_ms = (uint32_t)((now_us - report_start_us) / 1000);
+    uint32_t new_frames = frames - report_frames;
+
+    if (blackout_hist.count == 0 || elapsed_ms == 0) {
+        return;
+    }
+    uint32_t rate_x10 = (uint32_t)((uint64_t)new_frames * 10000 / elapsed_ms);
+    uint32_t off_pct = cycle_ms_total > 0 ? (uint32_t)(off_ms_total * 100 / cycle_ms_total) : 0;
+
+    LOG_INFO(TAG, "Broadcast frames %lu.%lu/s, monitor off %lu%% of hybrid time, window %lu ms, %lu overflows",
+             rate_x10 / 10, rate_x10 % 10, off_pct, window_ms, overflows);
+    histogram_log_header(TAG, "ms");
+    histogram_log_row(TAG, "stop", &stop_hist);
+    histogram_log_row(TAG, "poll+filter", &poll_hist);
+    histogram_log_row(TAG, "restart", &restart_hist);
+    histogram_log_row(TAG, "RPM blackout", &blackout_hist);
+
+    report_start_us = now_us;
+    report_frames = frames;
+    off_ms_total = 0;
+    cycle_ms_total = 0;
+}
@@ -0,0 +1,179 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "logging_config.h"
+#include "launch_control.h"
+#include "gpio_control.h"
+#include "obd_data.h"
+
+static const char *TAG = "LAUNCH";
+
+// State machine state (guarded by launch_lock)
+static portMUX_TYPE launch_lock = portMUX_INITIALIZER_UNLOCKED;
+static launch_state_t launch_state = LAUNCH_STATE_IDLE;
+static int64_t armed_since_us = 0;
+static bool rearm_blocked = false;   // Inputs must be released before re-arming
+static bool nitrous_active = false;
+
+// Transition ring buffer: written under launch_lock, drained by obd_task
+static launch_transition_t transition_log[LAUNCH_TRANSITION_LOG_SIZE];
+static uint32_t transition_head = 0;   // Next slot to write
+static uint32_t transition_tail = 0;   // Next slot to log
+
+static const char *state_names[] = { "IDLE", "ARMED", "LIMITING" };
+static const char *reason_names[] = { "arm input", "rpm high", "rpm low", "speed", "timeout", "reset" };
+
+// Record a transition and drive the output (called with launch_lock held)
+static void transition_to(launch_state_t next, launch_reason_t reason, int64_t now_us,
+                          uint32_t rpm, uint8_t speed) {
+    launch_transition_t *t = &transition_log[transition_head % LAUNCH_TRANSITION_LOG_SIZE];
+    t->timestamp_us = now_us;
+    t->from = launch_state;
+    t->to = next;
+    t->reason = reason;
+    t->rpm = rpm;
+    t->speed = speed;
+    transition_head++;
+    if (transition_head - transition_tail > LAUNCH_TRANSITION_LOG_SIZE) {
+        transition_tail = transition_head - LAUNCH_TRANSITION_LOG_SIZE;  // Drop oldest
+    }
+
+    if (next == LAUNCH_STATE_ARMED && launch_state == LAUNCH_STATE_IDLE) {
+        armed_since_us = now_us;
+    }
+    launch_state = next;
+    gpio_output_set(LAUNCH_OUTPUT_PIN, next == LAUNCH_STATE_LIMITING);
+    
+    // Staged: shift link bandwidth to RPM/throttle/safety PIDs
+    obd_set_poll_profile(next == LAUNCH_STATE_IDLE ? OBD_PROFILE_NORMAL : OBD_PROFILE_ARMED);
+}
+
+// Drive the nitrous output (called with launch_lock held). Never while the
+// rev limiter cuts, and only while the analog interlock holds
+static void nitrous_update(uint32_t rpm, uint8_t throttle, bool interlock_ok) {
+    bool spray = interlock_ok && launch_state != LAUNCH_STATE_LIMITING &&
+                 rpm >= NITROUS_MIN_RPM && throttle >= NITROUS_MIN_THROTTLE;
+    if (spray != nitrous_active) {
+        nitrous_active = spray;
+        gpio_output_set(LAUNCH_NITROUS_PIN, spray);
+    }
+}
+
+// Clutch or button held (both inputs are active LOW)
+static bool arm_input_active(void) {
+    return gpio_get_level(LAUNCH_CLUTCH_PIN) == 0 || gpio_get_level(LAUNCH_BUTTON_PIN) == 0;
+}
+
+// Initialize launch control pins and state
+void launch_control_init(void) {
+    gpio_output_init(LAUNCH_OUTPUT_PIN);
+    gpio_output_init(LAUNCH_NITROUS_PIN);
+    gpio_input_init(LAUNCH_CLUTCH_PIN, true);
+    gpio_input_init(LAUNCH_BUTTON_PIN, true);
+
+    portENTER_CRITICAL(&launch_lock);
+    launch_state = LAUNCH_STATE_IDLE;
+    rearm_blocked = false;
+    transition_head = 0;
+    transition_tail = 0;
+    nitrous_active = false;
+    gpio_output_set(LAUNCH_OUTPUT_PIN, false);
+    gpio_output_set(LAUNCH_NITROUS_PIN, false);
+    portEXIT_CRITICAL(&launch_lock);
+
+    LOG_VERBOSE(TAG, "Launch control initialized (limit %d RPM, hysteresis %d RPM)",
+                LAUNCH_RPM_LIMIT, LAUNCH_RPM_HYSTERESIS);
+}
+
+// Evaluate the state machine and the nitrous output against the latest
+// decoded sample. Called for every decoded OBD and analog sample, so the
+// outputs follow the RPM window and the interlock within the same sample.
+// Constant time, no blocking, no logging.
+void launch_control_evaluate(void) {
+    int64_t now_us = esp_timer_get_time();
+    uint32_t rpm = vehicle_data.rpm;
+    uint8_t speed = vehicle_data.vehicle_speed;
+    bool arm_input = arm_input_active();
+
+    portENTER_CRITICAL(&launch_lock);
+
+    if (!arm_input) {
+        rearm_blocked = false;
+    }
+
+    switch (launch_state) {
+        case LAUNCH_STATE_IDLE:
+            if (arm_input && !rearm_blocked && speed == 0) {
+                transition_to(LAUNCH_STATE_ARMED, LAUNCH_REASON_ARM_INPUT, now_us, rpm, speed);
+                // Fall through to the RPM check on the same sample
+                if (rpm >= LAUNCH_RPM_LIMIT) {
+                    transition_to(LAUNCH_STATE_LIMITING, LAUNCH_REASON_RPM_HIGH, now_us, rpm, speed);
+                }
+            }
+            break;
+
+        case LAUNCH_STATE_ARMED:
+        case LAUNCH_STATE_LIMITING:
+            if (speed > LAUNCH_DISARM_SPEED_KMH) {
+                transition_to(LAUNCH_STATE_IDLE, LAUNCH_REASON_SPEED, now_us, rpm, speed);
+                rearm_blocked = true;
+            } else if ((now_us - armed_since_us) > (int64_t)LAUNCH_ARMED_TIMEOUT_MS * 1000) {
+                transition_to(LAUNCH_STATE_IDLE, LAUNCH_REASON_TIMEOUT, now_us, rpm, speed);
+                rearm_blocked = true;
+            } else if (launch_state == LAUNCH_STATE_ARMED && rpm >= LAUNCH_RPM_LIMIT) {
+                transition_to(LAUNCH_STATE_LIMITING, LAUNCH_REASON_RPM_HIGH, now_us, rpm, speed);
+            } else if (launch_state == LAUNCH_STATE_LIMITING &&
+                       rpm < (LAUNCH_RPM_LIMIT - LAUNCH_RPM_HYSTERESIS)) {
+                transition_to(LAUNCH_STATE_ARMED, LAUNCH_REASON_RPM_LOW, now_us, rpm, speed);
+            }
+            break;
+    }
+    nitrous_update(rpm, vehicle_data.throttle_position, vehicle_data.analog_interlock_ok);
+
+    portEXIT_CRITICAL(&launch_lock);
+}
+
+// Force the output off and return to IDLE (e.g. on link loss)
+void launch_control_reset(void) {
+    portENTER_CRITICAL(&launch_lock);
+    if (launch_state != LAUNCH_STATE_IDLE) {
+        transition_to(LAUNCH_STATE_IDLE, LAUNCH_REASON_RESET, esp_timer_get_time(),
+                      vehicle_data.rpm, vehicle_data.vehicle_speed);
+        rearm_blocked = true;
+    }
+    nitrous_update(0, 0, false);
+    portEXIT_CRITICAL(&launch_lock);
+}
+
+launch_state_t launch_control_get_state(void) {
+    return launch_state;
+}
+
+bool launch_control_is_armed(void) {
+    return launch_state != LAUNCH_STATE_IDLE;
+}
+
+bool launch_control_nitrous_active(void) {
+    return nitrous_active;
+}
+
+// Log pending transitions (called from task context, never from the hot path)
+void launch_control_log_transitions(void) {
+    while (1) {
+        launch_transition_t t;
+
+        portENTER_CRITICAL(&launch_lock);
+        if (transition_tail == transition_head) {
+            portEXIT_CRITICAL(&launch_lock);
+            break;
+        }
+        t = transition_log[transition_tail % LAUNCH_TRANSITION_LOG_SIZE];
+        transition_tail++;
+        portEXIT_CRITICAL(&launch_lock);
+
+        LOG_INFO(TAG, "[%lld us] %s -> %s (%s) RPM=%lu Speed=%d",
+                 t.timestamp_us, state_names[t.from], state_names[t.to],
+                 reason_names[t.reason], t.rpm, t.speed);
+    }
+}
@@ -0,0 +1,124 @@
+#include "esp_log.h"
+#include "esp_bt.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+#include "logging_config.h"
+#include "link_policy.h"
+
+static const char *TAG = "LINK_POLICY";
+
+// Link state
+static link_policy_t current_policy = LINK_POLICY_POWER_SAVE;
+static bool link_up = false;
+static esp_bd_addr_t peer_bda;
+static uint32_t sniff_entries = 0;
+
+// Per-policy RTT statistics (written from the BT callback, read by obd_task)
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static link_rtt_stats_t rtt_stats[LINK_POLICY_COUNT];
+
+static const char *policy_names[] = { "POWER_SAVE", "LOW_LATENCY" };
+
+// Push the current policy to the controller and the active ACL link
+static void apply_policy(void) {
+    esp_err_t ret;
+    
+    if (current_policy == LINK_POLICY_LOW_LATENCY) {
+        ret = esp_bt_sleep_disable();
+    } else {
+        ret = esp_bt_sleep_enable();
+    }
+    if (ret != ESP_OK) {
+        LOG_BT(TAG, "Modem sleep change not applied: %s", esp_err_to_name(ret));
+    }
+    
+    if (link_up) {
+        uint32_t t_poll = (current_policy == LINK_POLICY_LOW_LATENCY) ?
+            LINK_TPOLL_LOW_LATENCY : LINK_TPOLL_POWER_SAVE;
+        ret = esp_bt_gap_set_qos(peer_bda, t_poll);
+        if (ret != ESP_OK) {
+            LOG_WARN(TAG, "Failed to set ACL poll interval: %s", esp_err_to_name(ret));
+        }
+    }
+}
+
+// Initialize link policy manager
+void link_policy_init(void) {
+    current_policy = LINK_POLICY_POWER_SAVE;
+    link_up = false;
+    sniff_entries = 0;
+    memset(rtt_stats, 0, sizeof(rtt_stats));
+    LOG_VERBOSE(TAG, "Link policy manager initialized");
+}
+
+// Select link policy (no-op if unchanged)
+void link_policy_set(link_policy_t policy) {
+    if (policy == current_policy) {
+        return;
+    }
+    LOG_INFO(TAG, "Link policy: %s -> %s", policy_names[current_policy], policy_names[policy]);
+    current_policy = policy;
+    apply_policy();
+}
+
+link_policy_t link_policy_get(void) {
+    return current_policy;
+}
+
+// ACL link to the adapter is up: apply the policy to it
+void link_policy_on_connected(const uint8_t *bda) {
+    memcpy(peer_bda, bda, sizeof(peer_bda));
+    link_up = true;
+    apply_policy();
+}
+
+void link_policy_on_disconnected(void) {
+    link_up = false;
+}
+
+// Power mode change reported by the stack (sniff adds latency to every exchange)
+void link_policy_on_mode_change(esp_bt_pm_mode_t mode) {
+    if (mode == ESP_BT_PM_MD_SNIFF) {
+        sniff_entries++;
+        if (current_policy == LINK_POLICY_LOW_LATENCY) {
+            LOG_WARN(TAG, "Link entered sniff mode while polling (#%lu)", sniff_entries);
+        }
+    } else {
+        LOG_BT(TAG, "Link power mode: %d", mode);
+    }
+}
+
+// Record one command round trip under the active policy
+void link_policy_record_rtt(uint32_t rtt_us) {
+    portENTER_CRITICAL(&stats_lock);
+    link_rtt_stats_t *s = &rtt_stats[current_policy];
+    if (s->count == 0 || rtt_us < s->min_us) {
+        s->min_us = rtt_us;
+    }
+    if (rtt_us > s->max_us) {
+        s->max_us = rtt_us;
+    }
+    s->total_us += rtt_us;
+    s->count++;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+// Log RTT statistics for every policy that has samples
+void link_policy_log_stats(void) {
+    link_rtt_stats_t snapshot[LINK_POLICY_COUNT];
+    
+    portENTER_CRITICAL(&stats_lock);
+    memcpy(snapshot, rtt_stats, sizeof(snapshot));
+    portEXIT_CRITICAL(&stats_lock);
+    
+    for (int i = 0; i < LINK_POLICY_COUNT; i++) {
+        if (snapshot[i].count == 0) {
+            continue;
+        }
+        LOG_INFO(TAG, "RTT %-11s: n=%lu avg=%llu us min=%lu us max=%lu us (sniff entries: %lu)",
+                 policy_names[i], snapshot[i].count,
+                 snapshot[i].total_us / snapshot[i].count,
+                 snapshot[i].min_us, snapshot[i].max_us, sniff_entries);
+    }
+}
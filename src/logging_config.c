@@ -1,5 +1,6 @@
 #include "logging_config.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 // Configure ESP-IDF Bluetooth stack logging levels
 void configure_esp_bt_logging(void) {
@@ -32,4 +33,27 @@ void configure_esp_bt_logging(void) {
     
     ESP_LOGI("LOGGING", "ESP-IDF Bluetooth stack logs enabled (DEBUG level)");
 #endif
-} 
\ No newline at end of file
+}
+
+// Log raw adapter bytes as one replayable trace line per chunk
+void log_trace_bytes(const char *direction, const uint8_t *data, uint16_t len) {
+#if ENABLE_ELM327_TRACE
+    static const char hex_digits[] = "0123456789ABCDEF";
+    char line[2 * 128 + 1];
+    
+    // Long chunks are split so each line stays bounded
+    for (uint16_t offset = 0; offset < len; offset += 128) {
+        uint16_t n = (len - offset) < 128 ? (len - offset) : 128;
+        for (uint16_t i = 0; i < n; i++) {
+            line[2 * i] = hex_digits[data[offset + i] >> 4];
+            line[2 * i + 1] = hex_digits[data[offset + i] & 0x0F];
+        }
+        line[2 * n] = '\0';
+        ESP_LOGI("TRACE", "%lld %s %s", esp_timer_get_time() / 1000, direction, line);
+    }
+#else
+    (void)direction;
+    (void)data;
+    (void)len;
+#endif
+}
\ No newline at end of file
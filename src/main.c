@@ -11,6 +11,24 @@
 #include "elm327.h"
 #include "obd_data.h"
 #include "gpio_control.h"
+#include "launch_control.h"
+#include "power_manager.h"
+#include "link_policy.h"
+#include "freeze_frame.h"
+#include "pulse_input.h"
+#include "analog_input.h"
+#include "elm327_sim.h"
+#include "strategy_bench.h"
+#include "soak_test.h"
+#include "ble_stream.h"
+#include "wifi_dashboard.h"
+#include "task_watchdog.h"
+#include "auto_tuner.h"
+#include "hybrid_monitor.h"
+#include "can_discovery.h"
+#include "rolling_stats.h"
+#include "publish_policy.h"
+#include "spp_proxy.h"
 
 static const char *TAG = "OBD_CONTROLLER";
 
@@ -31,18 +49,76 @@ void app_main(void) {
     // Configure ESP-IDF logging levels (suppress noisy BT stack logs)
     configure_esp_bt_logging();
     
+    // Initialize power management (DFS, light sleep, engine-run PM lock)
+    power_manager_init();
+    
     // Initialize all modules
     LOG_VERBOSE(TAG, "Initializing system modules...");
     
     // Initialize GPIO and LED system
     gpio_init_system();
     
+    // Initialize freeze-frame capture (before any output can activate)
+    freeze_frame_init();
+    
+    // Initialize launch control output state machine
+    launch_control_init();
+    
     // Initialize ELM327 system (semaphores, buffers)
     elm327_init_system();
     
     // Initialize OBD data system
     obd_data_init();
     
+#if ROLLING_STATS_ENABLED
+    // Windowed min/max/mean per published channel
+    rolling_stats_init();
+#endif
+    
+#if PUBLISH_POLICY_ENABLED
+    // Change/deadband filtering between decoders and stream consumers
+    publish_policy_init();
+#endif
+    
+    // Initialize PCNT tach/VSS inputs (fused with OBD RPM/speed)
+    pulse_input_init();
+    
+    // Initialize continuous ADC for analog interlocks (bottle pressure, AFR)
+    analog_input_init();
+    
+    // Initialize link policy manager (sniff/modem sleep, ACL poll interval)
+    link_policy_init();
+    
+#if AUTO_TUNER_ENABLED
+    // Per-vehicle acquisition strategy (tuned live, stored by VIN)
+    auto_tuner_init();
+#endif
+    
+#if HYBRID_MONITOR_ENABLED
+    // Broadcast RPM in monitor mode with polled gaps (needs a configured frame)
+    hybrid_monitor_init();
+#endif
+    
+#if CAN_DISCOVERY_ENABLED
+    // Finds the broadcast RPM frame per vehicle (feeds the hybrid monitor)
+    can_discovery_init();
+#endif
+    
+#if TASK_WATCHDOG_ENABLED
+    // Per-task heartbeat deadlines (before any watched task starts)
+    task_watchdog_init();
+#endif
+    
+#if ELM327_SIM_ENABLED
+    // Simulated adapter replaces Bluetooth entirely
+    elm327_sim_start();
+#if BLE_STREAM_ENABLED
+    ble_stream_init();          // Done by bluetooth_init otherwise
+#endif
+#if SPP_PROXY_ENABLED
+    spp_proxy_start_server();   // Done on ESP_SPP_INIT_EVT otherwise
+#endif
+#else
     // Initialize Bluetooth system
     bluetooth_init();
     
@@ -53,14 +129,75 @@ void app_main(void) {
     LOG_VERBOSE(TAG, "Starting device search...");
     vTaskDelay(pdMS_TO_TICKS(100));  // Brief delay for system stability
     start_device_discovery();
+#endif
+    
+#if WIFI_DASHBOARD_ENABLED
+    // Soft-AP dashboard (after Bluetooth so the controller owns the radio first)
+    wifi_dashboard_init();
+#endif
     
     // Create LED search indicator task
     LOG_VERBOSE(TAG, "Creating LED search task...");
     xTaskCreate(led_search_task, "led_search", 2048, NULL, 4, NULL);
     
+#if STRATEGY_BENCH_ENABLED
+#if !ELM327_SIM_ENABLED
+#error "STRATEGY_BENCH_ENABLED requires ELM327_SIM_ENABLED"
+#endif
+    // Strategy comparison harness takes the place of the polling task
+    LOG_VERBOSE(TAG, "Creating strategy bench task...");
+    xTaskCreate(strategy_bench_task, "strategy_bench", 4096, NULL, 5, NULL);
+#else
     // Create OBD data polling task
     LOG_VERBOSE(TAG, "Creating OBD task...");
     xTaskCreate(obd_task, "obd_task", 4096, NULL, 5, NULL);
+#endif
+    
+#if ELM327_SECONDARY_ENABLED
+    // Second adapter polls the slow channels on its own link
+    LOG_VERBOSE(TAG, "Creating secondary OBD task...");
+    xTaskCreate(obd_secondary_task, "obd_secondary", 3072, NULL, 5, NULL);
+#endif
+    
+#if SOAK_TEST_ENABLED
+#if !ELM327_SIM_ENABLED
+#error "SOAK_TEST_ENABLED requires ELM327_SIM_ENABLED"
+#endif
+    // Fault injection and recovery statistics against the simulated adapter
+    LOG_VERBOSE(TAG, "Creating soak test task...");
+    xTaskCreate(soak_test_task, "soak_test", 4096, NULL, 3, NULL);
+#endif
+    
+#if BLE_STREAM_ENABLED
+    // Batched sample notifications to a BLE central (below the polling priority)
+    LOG_VERBOSE(TAG, "Creating BLE stream task...");
+    xTaskCreate(ble_stream_task, "ble_stream", 3072, NULL, 3, NULL);
+#endif
+    
+#if WIFI_DASHBOARD_ENABLED
+    // Delta frames to dashboard WebSocket clients (below the polling priority)
+    LOG_VERBOSE(TAG, "Creating dashboard push task...");
+    xTaskCreate(wifi_dashboard_task, "dashboard", 3072, NULL, 3, NULL);
+#endif
+    
+    // Create analog decimation task (publishes interlock channels)
+    LOG_VERBOSE(TAG, "Creating analog input task...");
+    xTaskCreate(analog_input_task, "analog_input", 3072, NULL, 6, NULL);
+    
+    // Create freeze-frame flush task (low priority, writes captures to flash)
+    LOG_VERBOSE(TAG, "Creating freeze-frame task...");
+    xTaskCreate(freeze_frame_task, "freeze_frame", 3072, NULL, 2, NULL);
+    
+#if AUTO_TUNER_ENABLED
+    // Console commands for the tuner (lowest priority, polls stdin)
+    xTaskCreate(auto_tuner_console_task, "tuner_console", 3072, NULL, 1, NULL);
+#endif
+    
+#if TASK_WATCHDOG_ENABLED
+    // Deadline monitor (above the watched tasks so it is never starved by them)
+    LOG_VERBOSE(TAG, "Creating task watchdog monitor...");
+    xTaskCreate(task_watchdog_task, "task_wdt_mon", 3072, NULL, 7, NULL);
+#endif
     
     LOG_INFO(TAG, "System initialization complete. Searching for ELM327...");
     
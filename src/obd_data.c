@@ -1,4 +1,5 @@
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -8,6 +9,21 @@
 #include "elm327.h"
 #include "bluetooth.h"
 #include "gpio_control.h"
+#include "launch_control.h"
+#include "power_manager.h"
+#include "link_policy.h"
+#include "freeze_frame.h"
+#include "pulse_input.h"
+#include "strategy_bench.h"
+#include "soak_test.h"
+#include "spp_proxy.h"
+#include "task_watchdog.h"
+#include "auto_tuner.h"
+#include "hybrid_monitor.h"
+#include "can_discovery.h"
+#include "rolling_stats.h"
+#include "publish_policy.h"
+#include "analog_input.h"
 
 static const char *TAG = "OBD_DATA";
 
@@ -17,28 +33,164 @@ static const char *TAG = "OBD_DATA";
 vehicle_data_t vehicle_data = {
     .rpm = 0,
     .throttle_position = 0,
-    .vehicle_speed = 0
+    .vehicle_speed = 0,
+    .timing_advance = 0,
+    .coolant_temp = 0,
+    .bottle_pressure_psi = 0,
+    .afr_x10 = 0,
+    .analog_interlock_ok = false
 };
 
 // Timestamp tracking for data freshness (in FreeRTOS ticks)
 static TickType_t rpm_last_update = 0;
 static TickType_t throttle_last_update = 0;
 static TickType_t speed_last_update = 0;
+static TickType_t timing_last_update = 0;
+static TickType_t coolant_last_update = 0;
 
 #define DATA_TIMEOUT_MS 500
 #define DATA_TIMEOUT_TICKS pdMS_TO_TICKS(DATA_TIMEOUT_MS)
 
-// Check for stale data and reset values older than timeout
-static void check_and_reset_stale_data(bool using_individual_pids) {
-    TickType_t current_time = xTaskGetTickCount();
+// Requested polling profile (single word, written by output logic, read once per slot)
+static volatile obd_poll_profile_t poll_profile = OBD_PROFILE_NORMAL;
+
+// Request schedule for one polling profile (one command per 150ms slot).
+// Stale timeouts are about twice each channel's polling period
+typedef struct {
+    const char *const *commands;
+    uint8_t length;
+    const char *speed_cmd;          // Speed at LAUNCH_SPEED_POLL_MS (NULL = listed)
+    uint32_t rpm_timeout_ms;
+    uint32_t throttle_timeout_ms;
+    uint32_t speed_timeout_ms;
+    uint32_t safety_timeout_ms;     // Timing advance and coolant
+} poll_schedule_t;
+
+// Multi-PID: RPM + Throttle, then Speed (500ms cycle)
+static const char *const multi_normal_cmds[] = { "010C11", "010D" };
+
+// Multi-PID armed: RPM + throttle every slot, timing advance and coolant
+// in every other one; speed rides along at its floor rate ("010C110D")
+static const char *const multi_armed_cmds[] = { "010C11", "010C110E", "010C11", "010C1105" };
+
+// Individual PIDs: RPM, Throttle, Speed (750ms cycle)
+static const char *const single_normal_cmds[] = { "010C", "0111", "010D" };
+
+// Individual PIDs armed: RPM and throttle alternate, timing advance and
+// coolant take one throttle slot each; speed slots in at its floor rate
+static const char *const single_armed_cmds[] = {
+    "010C", "0111", "010C", "0111", "010C", "010E",
+    "010C", "0111", "010C", "0111", "010C", "0105"
+};
+
+// [individual][profile]
+static const poll_schedule_t poll_schedules[2][2] = {
+    {
+        { multi_normal_cmds, 2, NULL, 600, 600, 600, 2400 },
+        { multi_armed_cmds, 4, "010C110D", 600, 600, 1500, 2400 }
+    },
+    {
+        { single_normal_cmds, 3, NULL, 1000, 1000, 1000, 2400 },
+        { single_armed_cmds, 12, "010D", 900, 1800, 1500, 6000 }
+    }
+};
+
+// Two adapters: the primary polls only RPM + throttle (every slot), the
+// secondary polls the slow channels on its own link. Armed, the secondary
+// alternates timing advance and coolant and takes speed at its floor rate
+static const char *const split_primary_cmds[] = { "010C11" };
+static const poll_schedule_t split_primary_schedules[2] = {
+    { split_primary_cmds, 1, NULL, 600, 600, 1500, 1500 },
+    { split_primary_cmds, 1, NULL, 600, 600, 1500, 1200 }
+};
+static const char *const secondary_cmds[] = { "010D", "010E", "0105" };
+static const char *const secondary_armed_cmds[] = { "010E", "0105" };
+
+// Hybrid acquisition: RPM at the broadcast rate, polled channels once or
+// twice per monitor window (no request cycle of its own)
+static const poll_schedule_t hybrid_schedule = { NULL, 0, NULL, 1000, 1000, 2000, 2000 };
+
+// Merged channel stream (all links), guarded against concurrent readers
+static portMUX_TYPE stream_lock = portMUX_INITIALIZER_UNLOCKED;
+static obd_sample_t stream[OBD_STREAM_LEN];
+static uint32_t stream_head = 0;    // Total samples written
+
+// Append one decoded channel value to the merged stream (if its publish policy admits it)
+static void stream_push(uint8_t source, uint8_t pid, int32_t value, int64_t timestamp_us) {
+#if PUBLISH_POLICY_ENABLED
+    if (!publish_policy_admit(pid, value, timestamp_us)) {
+        return;
+    }
+#endif
+    portENTER_CRITICAL(&stream_lock);
+    obd_sample_t *sample = &stream[stream_head % OBD_STREAM_LEN];
+    sample->timestamp_us = timestamp_us;
+    sample->value = value;
+    sample->pid = pid;
+    sample->source = source;
+    stream_head++;
+    portEXIT_CRITICAL(&stream_lock);
+}
+
+// Read the next sample after *cursor; readers that fall behind skip to the oldest kept
+bool obd_stream_read(uint32_t *cursor, obd_sample_t *out) {
+    bool available = false;
     
-    // Adjust timeout based on polling strategy
-    TickType_t timeout = using_individual_pids ? 
-        pdMS_TO_TICKS(1000) :  // 1 second for individual PIDs (750ms cycle + margin)
-        pdMS_TO_TICKS(600);    // 600ms for multi-PID (500ms cycle + margin)
+    portENTER_CRITICAL(&stream_lock);
+    if (stream_head - *cursor > OBD_STREAM_LEN) {
+        *cursor = stream_head - OBD_STREAM_LEN;
+    }
+    if (*cursor != stream_head) {
+        *out = stream[*cursor % OBD_STREAM_LEN];
+        (*cursor)++;
+        available = true;
+    }
+    portEXIT_CRITICAL(&stream_lock);
+    return available;
+}
+
+// When the radio last came back on after a parked sleep
+static TickType_t radio_on_since = 0;
+
+// Parked: Bluetooth and the ADC off so automatic light sleep can engage, a
+// tick-timer wake-up for the next probe, then the radio on to reconnect
+static void park_until_next_probe(void) {
+    ESP_LOGI(TAG, "🅿️ Parked: radio off, next probe in %d s", POWER_SLOT_IGNITION_OFF_MS / 1000);
+    launch_control_reset();
+    bluetooth_suspend();
+    analog_input_suspend();
+    task_watchdog_beat(WDT_TASK_OBD, "parked", POWER_SLOT_IGNITION_OFF_MS);
+    vTaskDelay(pdMS_TO_TICKS(POWER_SLOT_IGNITION_OFF_MS));
+    analog_input_resume();
+    bluetooth_resume();
+    radio_on_since = xTaskGetTickCount();
+}
+
+// Switch polling profile; takes effect on the next request slot
+void obd_set_poll_profile(obd_poll_profile_t profile) {
+    poll_profile = profile;
+}
+
+obd_poll_profile_t obd_get_poll_profile(void) {
+    return poll_profile;
+}
+
+// A channel is stale once it has gone a whole timeout without an update,
+// counting from the schedule switch at the latest (the new schedule gets one
+// full timeout to poll it)
+static bool is_stale(TickType_t now, TickType_t last_update, TickType_t schedule_since, uint32_t timeout_ms) {
+    TickType_t age = now - last_update;
+    TickType_t in_schedule = now - schedule_since;
+    return (age < in_schedule ? age : in_schedule) > pdMS_TO_TICKS(timeout_ms);
+}
+
+// Check for stale data and reset values older than their schedule's timeout
+// (scaled with the slot period)
+static void check_and_reset_stale_data(const poll_schedule_t *schedule, uint32_t scale, TickType_t since) {
+    TickType_t current_time = xTaskGetTickCount();
     
     // Check RPM freshness
-    if ((current_time - rpm_last_update) > timeout) {
+    if (is_stale(current_time, rpm_last_update, since, schedule->rpm_timeout_ms * scale)) {
         if (vehicle_data.rpm != 0) {
             vehicle_data.rpm = 0;
             ESP_LOGW(TAG, "⚠️ RPM data stale, reset to 0");
@@ -46,7 +198,7 @@ static void check_and_reset_stale_data(bool using_individual_pids) {
     }
     
     // Check throttle freshness  
-    if ((current_time - throttle_last_update) > timeout) {
+    if (is_stale(current_time, throttle_last_update, since, schedule->throttle_timeout_ms * scale)) {
         if (vehicle_data.throttle_position != 0) {
             vehicle_data.throttle_position = 0;
             ESP_LOGW(TAG, "⚠️ Throttle data stale, reset to 0");
@@ -54,20 +206,100 @@ static void check_and_reset_stale_data(bool using_individual_pids) {
     }
     
     // Check speed freshness
-    if ((current_time - speed_last_update) > timeout) {
+    if (is_stale(current_time, speed_last_update, since, schedule->speed_timeout_ms * scale)) {
         if (vehicle_data.vehicle_speed != 0) {
             vehicle_data.vehicle_speed = 0;
             ESP_LOGW(TAG, "⚠️ Speed data stale, reset to 0");
         }
     }
+    
+    // Safety channels: a stale reading must not pass for a current one
+    if (is_stale(current_time, timing_last_update, since, schedule->safety_timeout_ms * scale)) {
+        if (vehicle_data.timing_advance != 0) {
+            vehicle_data.timing_advance = 0;
+            ESP_LOGW(TAG, "⚠️ Timing advance data stale, reset to 0");
+        }
+    }
+    if (is_stale(current_time, coolant_last_update, since, schedule->safety_timeout_ms * scale)) {
+        if (vehicle_data.coolant_temp != 0) {
+            vehicle_data.coolant_temp = 0;
+            ESP_LOGW(TAG, "⚠️ Coolant data stale, reset to 0");
+        }
+    }
+}
+
+// Publish RPM from any source (OBD or pulse input) and mark it fresh
+void vehicle_data_publish_rpm(uint32_t rpm) {
+    vehicle_data.rpm = rpm;
+    rpm_last_update = xTaskGetTickCount();
+#if ROLLING_STATS_ENABLED
+    rolling_stats_push(ROLLING_CH_RPM, (int32_t)rpm);
+#endif
+}
+
+// Publish throttle position (%) and mark it fresh
+void vehicle_data_publish_throttle(uint8_t throttle) {
+    vehicle_data.throttle_position = throttle;
+    throttle_last_update = xTaskGetTickCount();
+#if ROLLING_STATS_ENABLED
+    rolling_stats_push(ROLLING_CH_THROTTLE, throttle);
+#endif
+}
+
+// Time since a polled channel was last published
+uint32_t vehicle_data_age_ms(uint8_t pid) {
+    TickType_t updated;
+    switch (pid) {
+        case 0x0C: updated = rpm_last_update; break;
+        case 0x0D: updated = speed_last_update; break;
+        case 0x11: updated = throttle_last_update; break;
+        case 0x0E: updated = timing_last_update; break;
+        case 0x05: updated = coolant_last_update; break;
+        default: return UINT32_MAX;
+    }
+    return pdTICKS_TO_MS(xTaskGetTickCount() - updated);
+}
+
+// Publish vehicle speed from any source (OBD or pulse input) and mark it fresh
+void vehicle_data_publish_speed(uint8_t speed) {
+    vehicle_data.vehicle_speed = speed;
+    speed_last_update = xTaskGetTickCount();
+#if ROLLING_STATS_ENABLED
+    rolling_stats_push(ROLLING_CH_SPEED, speed);
+#endif
+}
+
+// Publish timing advance (degrees) and mark it fresh
+void vehicle_data_publish_timing(int8_t timing) {
+    vehicle_data.timing_advance = timing;
+    timing_last_update = xTaskGetTickCount();
+}
+
+// Publish coolant temperature (°C) and mark it fresh
+void vehicle_data_publish_coolant(int16_t coolant) {
+    vehicle_data.coolant_temp = coolant;
+    coolant_last_update = xTaskGetTickCount();
 }
 
 // Parse multi-PID response line
 void parse_multi_pid_line(char *line)
+{
+    obd_data_parse_line(ELM327_LINK_PRIMARY, line);
+}
+
+// Decode one Mode 01 reply line from the given adapter link
+void obd_data_parse_line(uint8_t source, char *line)
 {
     /* Example after trimming CR/LF + prompt:
        "41 0C 1A F8 41 0D 3C 41 11 5A" */
 
+    // Mode 09 PID 02 (VIN) replies identify the car for the tuner
+    char *vin_start = strstr(line, "49 02 ");
+    if (vin_start != NULL) {
+        auto_tuner_on_vin_line(vin_start);
+        return;
+    }
+    
     // Handle lines that start with "0: " or similar prefixes
     char *data_start = strstr(line, "41 ");
     if (data_start == NULL) {
@@ -84,6 +316,15 @@ void parse_multi_pid_line(char *line)
         return;
     }
     
+    bool decoded = false;
+    
+    // Samples are stamped with the time their line was received
+    int64_t request_us, rx_us;
+    elm327_link_get_sample_times(&elm327_links[source], &request_us, &rx_us);
+    if (rx_us == 0) {
+        rx_us = esp_timer_get_time();
+    }
+
     // Now parse PID+data pairs
     while ((tok = strtok(NULL, " ")) != NULL) {
         // Stop at filler bytes (ELM pad)
@@ -112,23 +353,64 @@ void parse_multi_pid_line(char *line)
                 }
                 uint16_t raw = (HEXBYTE_TO_INT(data1) << 8) |
                                HEXBYTE_TO_INT(data2);
-                vehicle_data.rpm = raw / 4;
-                rpm_last_update = xTaskGetTickCount(); // Update timestamp
+                // Pulse tach owns the channel while it agrees with OBD
+                if (!pulse_input_fuse_rpm(raw / 4)) {
+                    vehicle_data_publish_rpm(raw / 4);
+                }
+                stream_push(source, pid_val, raw / 4, rx_us);
+                strategy_bench_on_pid(pid_val);
+                auto_tuner_on_pid(source, pid_val);
+                decoded = true;
                 break;
             }
             case 0x0D:                      // Vehicle speed (1 byte)
-                vehicle_data.vehicle_speed = HEXBYTE_TO_INT(data1);
-                speed_last_update = xTaskGetTickCount(); // Update timestamp
+                if (!pulse_input_fuse_speed(HEXBYTE_TO_INT(data1))) {
+                    vehicle_data_publish_speed(HEXBYTE_TO_INT(data1));
+                }
+                stream_push(source, pid_val, HEXBYTE_TO_INT(data1), rx_us);
+                strategy_bench_on_pid(pid_val);
+                auto_tuner_on_pid(source, pid_val);
+                decoded = true;
+                break;
+            case 0x0E:                      // Timing advance (1 byte)
+                vehicle_data_publish_timing((int8_t)(HEXBYTE_TO_INT(data1) / 2 - 64));
+                stream_push(source, pid_val, vehicle_data.timing_advance, rx_us);
+                decoded = true;
+                break;
+            case 0x05:                      // Coolant temperature (1 byte)
+                vehicle_data_publish_coolant((int16_t)HEXBYTE_TO_INT(data1) - 40);
+                stream_push(source, pid_val, vehicle_data.coolant_temp, rx_us);
+                decoded = true;
                 break;
             case 0x11:                      // Throttle position (1 byte)
-                vehicle_data.throttle_position =
-                    (HEXBYTE_TO_INT(data1) * 100) / 255;
-                throttle_last_update = xTaskGetTickCount(); // Update timestamp
+                vehicle_data_publish_throttle((HEXBYTE_TO_INT(data1) * 100) / 255);
+                stream_push(source, pid_val, vehicle_data.throttle_position, rx_us);
+                strategy_bench_on_pid(pid_val);
+                auto_tuner_on_pid(source, pid_val);
+                decoded = true;
                 break;
             default:
                 break;
         }
     }
+
+    // Evaluate output logic on every decoded sample, then record it
+    if (decoded) {
+        launch_control_evaluate();
+        freeze_frame_record_sample();
+        soak_test_on_sample();
+    }
+}
+
+// Broadcast RPM takes the same fusion, stream and output path as a polled sample
+void obd_data_on_broadcast_rpm(uint32_t rpm, int64_t rx_us) {
+    if (!pulse_input_fuse_rpm(rpm)) {
+        vehicle_data_publish_rpm(rpm);
+    }
+    stream_push(ELM327_LINK_PRIMARY, 0x0C, rpm, rx_us);
+    launch_control_evaluate();
+    freeze_frame_record_sample();
+    soak_test_on_sample();
 }
 
 // Initialize OBD data system
@@ -137,12 +419,18 @@ void obd_data_init(void) {
     vehicle_data.rpm = 0;
     vehicle_data.throttle_position = 0;
     vehicle_data.vehicle_speed = 0;
+    vehicle_data.timing_advance = 0;
+    vehicle_data.coolant_temp = 0;
+    vehicle_data.analog_interlock_ok = false;
+    poll_profile = OBD_PROFILE_NORMAL;
     
     // Initialize timestamps to current time
     TickType_t current_time = xTaskGetTickCount();
     rpm_last_update = current_time;
     throttle_last_update = current_time;
     speed_last_update = current_time;
+    timing_last_update = current_time;
+    coolant_last_update = current_time;
     
     LOG_VERBOSE(TAG, "OBD data system initialized");
 }
@@ -171,6 +459,8 @@ void obd_task(void *pv) {
     LOG_VERBOSE(TAG, "OBD Task started - waiting for Bluetooth connection...");
     
     while (1) {
+        task_watchdog_beat(WDT_TASK_OBD, "wait_connection", 1100);
+        
         // Wait for ELM327 to be connected and initialized
         if (connection_semaphore != NULL) {
             if (xSemaphoreTake(connection_semaphore, pdMS_TO_TICKS(1000)) == pdTRUE) {
@@ -186,15 +476,54 @@ void obd_task(void *pv) {
     ESP_LOGI(TAG, "📊 Two-phase strategy: 010C11 → 010D");
     
     static uint8_t phase = 0;
-    static bool use_individual_pids = false;
+    static obd_poll_profile_t active_profile = OBD_PROFILE_NORMAL;
+    static bool use_individual_pids = OBD_INDIVIDUAL_PIDS;
     static uint8_t can_error_count = 0;
     static TickType_t last_success_time = 0;
+    static TickType_t last_voltage_poll = 0;
+    static TickType_t last_link_stats = 0;
+    static TickType_t last_stats_report = 0;
+    static const char *const *checked_commands = NULL;  // Schedule the stale check last ran with
+    static TickType_t schedule_since = 0;
+    static TickType_t last_speed_request = 0;
+#if AUTO_TUNER_ENABLED || CAN_DISCOVERY_ENABLED
+    static uint32_t link_generation = 0;
+#endif
     
     while (1) {
-        if (is_connected && elm327_initialized) {
+        if (elm327_link_is_up(ELM327_LINK_PRIMARY)) {
+            
+#if AUTO_TUNER_ENABLED || CAN_DISCOVERY_ENABLED
+            // New adapter session: identify the car and load what is stored for it
+            // (not on parked probes, which reconnect every wake-up)
+            if (elm327_links[ELM327_LINK_PRIMARY].generation != link_generation &&
+                power_manager_get_state() != POWER_STATE_IGNITION_OFF) {
+                link_generation = elm327_links[ELM327_LINK_PRIMARY].generation;
+                auto_tuner_read_vin();
+#if AUTO_TUNER_ENABLED
+                auto_tuner_on_connect();
+                use_individual_pids = auto_tuner_active()->individual;
+#endif
+#if CAN_DISCOVERY_ENABLED
+                can_discovery_on_connect();
+#endif
+            }
+#endif
+            
+            // Update power state; slot period follows engine/ignition state
+            power_manager_update(true);
+            power_state_t power_state = power_manager_get_state();
+            uint32_t slot_ms = power_manager_slot_ms();
+            
+            // Low-latency link only while actively polling a running engine
+            link_policy_set(power_state == POWER_STATE_ENGINE_RUNNING ?
+                            LINK_POLICY_LOW_LATENCY : LINK_POLICY_POWER_SAVE);
             
             // Check if we should switch to individual PIDs due to CAN errors
             TickType_t current_time = xTaskGetTickCount();
+            if (last_success_time == 0) {
+                last_success_time = current_time;   // Error window starts with the session's first slot
+            }
             if ((current_time - last_success_time) > pdMS_TO_TICKS(5000)) {
                 if (!use_individual_pids) {
                     ESP_LOGW(TAG, "⚠️ Switching to individual PID requests due to errors");
@@ -202,51 +531,142 @@ void obd_task(void *pv) {
                 }
             }
             
+#if AUTO_TUNER_ENABLED
+            // Live tuning takes over the link for a while (normal profile, ECU awake)
+            if (auto_tuner_pending() && poll_profile == OBD_PROFILE_NORMAL &&
+                power_state != POWER_STATE_IGNITION_OFF) {
+                auto_tuner_run();
+                use_individual_pids = auto_tuner_active()->individual;
+                last_success_time = xTaskGetTickCount();
+                current_time = last_success_time;
+                phase = 0;
+            }
+#endif
+            
+#if CAN_DISCOVERY_ENABLED
+            // Broadcast RPM discovery needs the engine running (and revving)
+            if (can_discovery_pending() && poll_profile == OBD_PROFILE_NORMAL &&
+                power_state == POWER_STATE_ENGINE_RUNNING) {
+                hybrid_monitor_disengage();
+                can_discovery_run();
+                last_success_time = xTaskGetTickCount();
+                current_time = last_success_time;
+                phase = 0;
+            }
+#endif
+            
+            // Pick up profile changes at the start of the slot
+            obd_poll_profile_t profile = poll_profile;
+            if (profile != active_profile) {
+                ESP_LOGI(TAG, "🎯 Polling profile: %s", profile == OBD_PROFILE_ARMED ? "ARMED" : "NORMAL");
+                active_profile = profile;
+                phase = 0;  // Next slot starts the new schedule with RPM
+            }
+            
+            // Hybrid: broadcast RPM in monitor mode, slow channels polled in its gaps
+            bool hybrid = false;
+#if HYBRID_MONITOR_ENABLED
+            hybrid = hybrid_monitor_wanted(power_state);
+            if (!hybrid) {
+                hybrid_monitor_disengage();
+            }
+#endif
+            
             // Adaptive polling strategy
-            if (use_individual_pids) {
-                // Fallback: Individual PID requests
-                switch (phase % 3) {
-                    case 0:
-                        elm327_send_command("010C");  // RPM only
-                        break;
-                    case 1:
-                        elm327_send_command("0111");  // Throttle only
-                        break;
-                    case 2:
-                        elm327_send_command("010D");  // Speed only
-                        break;
+            const poll_schedule_t *schedule = &poll_schedules[use_individual_pids ? 1 : 0][active_profile];
+            const tuner_strategy_t *tuned = auto_tuner_active();
+            poll_schedule_t tuned_schedule;
+            uint32_t wait_ms = slot_ms;
+            if (hybrid) {
+                schedule = &hybrid_schedule;
+            } else if (elm327_link_is_up(ELM327_LINK_SECONDARY)) {
+                schedule = &split_primary_schedules[active_profile];
+            } else if (tuned->individual == use_individual_pids) {
+                // Tuned strategy (until the error fallback switches PID mode)
+                if (active_profile == OBD_PROFILE_NORMAL) {
+                    tuned_schedule = *schedule;
+                    tuned_schedule.commands = tuned->commands;
+                    tuned_schedule.length = tuned->length;
+                    schedule = &tuned_schedule;
                 }
-                phase = (phase + 1) % 3;
-            } else {
-                // Optimized: Multi-PID requests
-                switch (phase) {
-                    case 0:
-                        // Phase 0: RPM + Throttle (critical engine data)
-                        elm327_send_command("010C11");
-                        break;
-                    case 1:
-                        // Phase 1: Vehicle Speed
-                        elm327_send_command("010D");
-                        break;
+                if (power_state == POWER_STATE_ENGINE_RUNNING) {
+                    wait_ms = tuned->slot_ms;
                 }
-                // Alternate phases every 250ms
-                phase ^= 1;
+            }
+            bool floor_slot = false;
+            bool voltage_due = (current_time - last_voltage_poll) >= pdMS_TO_TICKS(power_manager_voltage_poll_ms());
+            if (voltage_due) {
+                last_voltage_poll = current_time;
+            }
+            // A send blocks until the previous reply's prompt, which can
+            // outlast the slot deadline beaten before the wait
+            task_watchdog_beat(WDT_TASK_OBD, "prompt_wait", ELM327_PROMPT_TIMEOUT_MS);
+            if (power_state == POWER_STATE_IGNITION_OFF) {
+                // Parked: probe voltage and RPM for the engine starting
+                task_watchdog_beat(WDT_TASK_OBD, "parked_probe", 3 * ELM327_PROMPT_TIMEOUT_MS);
+                elm327_send_command("AT RV");
+                elm327_send_command("010C");
+                elm327_link_wait_ready(&elm327_links[ELM327_LINK_PRIMARY], pdMS_TO_TICKS(ELM327_PROMPT_TIMEOUT_MS));
+                power_manager_update(true);
+                if (power_manager_get_state() == POWER_STATE_IGNITION_OFF) {
+                    park_until_next_probe();
+                }
+                continue;
+            } else if (hybrid) {
+                // Monitor window plus one polled gap (paces itself)
+                hybrid_monitor_cycle(voltage_due);
+            } else if (voltage_due) {
+                // Battery voltage for engine/ignition detection
+                elm327_send_command("AT RV");
+            } else if (schedule->speed_cmd != NULL &&
+                       (current_time - last_speed_request) + pdMS_TO_TICKS(wait_ms) >
+                       pdMS_TO_TICKS(LAUNCH_SPEED_POLL_MS)) {
+                // Speed floor: takes this slot, the listed command waits for the next
+                elm327_send_command(schedule->speed_cmd);
+                last_speed_request = current_time;
+                floor_slot = true;
+            } else {
+                elm327_send_command(schedule->commands[phase % schedule->length]);
+                phase = (phase + 1) % schedule->length;
             }
             
             // Check for stale data and reset if needed
-            check_and_reset_stale_data(use_individual_pids);
+            // Stale timeouts scale with the slot period
+            uint32_t slot_scale = slot_ms / POWER_SLOT_RUNNING_MS;
+            if (schedule->commands != checked_commands) {
+                checked_commands = schedule->commands;
+                schedule_since = xTaskGetTickCount();
+            }
+            check_and_reset_stale_data(schedule, slot_scale, schedule_since);
             
-            // Log status (adjust frequency based on mode)
-            if (use_individual_pids) {
-                // Log every cycle when using individual PIDs
-                if (phase == 0) {
-                    log_vehicle_status();
-                }
-            } else {
-                // Log once per complete cycle (every 500ms) for multi-PID
-                if (phase == 0) {
-                    log_vehicle_status();
-                }
+            // Re-evaluate outputs so timeouts/stale resets apply without new samples
+            launch_control_evaluate();
+            launch_control_log_transitions();
+            
+            // Log once per complete schedule cycle
+            if (phase == 0 && !floor_slot) {
+                log_vehicle_status();
+#if ROLLING_STATS_ENABLED
+                rolling_stats_log();
+#endif
+            }
+            
+            // Periodic RTT report per link policy
+            if ((current_time - last_link_stats) >= pdMS_TO_TICKS(LINK_STATS_LOG_INTERVAL_MS)) {
+                link_policy_log_stats();
+                last_link_stats = current_time;
+            }
+            
+            // Periodic receive-path and acquisition tables
+            if ((current_time - last_stats_report) >= pdMS_TO_TICKS(OBD_STATS_LOG_INTERVAL_MS)) {
+                elm327_log_rx_stats();
+#if HYBRID_MONITOR_ENABLED
+                hybrid_monitor_log_report();
+#endif
+#if PUBLISH_POLICY_ENABLED
+                publish_policy_log_stats();
+#endif
+                last_stats_report = current_time;
             }
             
             // Update success time if we have valid data
@@ -254,16 +674,103 @@ void obd_task(void *pv) {
                 last_success_time = current_time;
             }
             
-            // Wait before next phase
-            vTaskDelay(pdMS_TO_TICKS(150));
+            // Phone requests ride in the idle tail of a normal-profile slot,
+            // unless the secondary adapter is there to carry them
+            // (hybrid cycles serve them in their own gaps)
+            TickType_t proxy_ticks = 0;
+            if (active_profile == OBD_PROFILE_NORMAL && !elm327_link_is_up(ELM327_LINK_SECONDARY) &&
+                !hybrid && wait_ms > SPP_PROXY_SLOT_MARGIN_MS) {
+                proxy_ticks = spp_proxy_service_slot(&elm327_links[ELM327_LINK_PRIMARY],
+                                                     wait_ms - SPP_PROXY_SLOT_MARGIN_MS);
+            }
+            
+            // Repeated CAN ERROR / NO DATA: give the bus a pause before the next slot
+            if (elm327_link_take_backoff(&elm327_links[ELM327_LINK_PRIMARY])) {
+                ESP_LOGW(TAG, "⚠️ %d consecutive failures, backing off %d ms...",
+                         ELM327_BACKOFF_FAILURES, ELM327_BACKOFF_MS);
+                task_watchdog_beat(WDT_TASK_OBD, "backoff", ELM327_BACKOFF_MS);
+                vTaskDelay(pdMS_TO_TICKS(ELM327_BACKOFF_MS));
+            }
+            
+            // Wait before next phase (CPU at min frequency when engine is off;
+            // a zero wait paces requests on the adapter prompt)
+            if (!hybrid) {
+                TickType_t slot = pdMS_TO_TICKS(wait_ms);
+                task_watchdog_beat(WDT_TASK_OBD, "slot_wait", wait_ms);
+                vTaskDelay(proxy_ticks < slot ? slot - proxy_ticks : 0);
+            }
             
         } else {
             ESP_LOGI(TAG, "⏳ Waiting for ELM327 connection...");
+            // Never leave outputs driven without live data
+            launch_control_reset();
+            launch_control_log_transitions();
             // Reset strategy when disconnected
-            use_individual_pids = false;
+            use_individual_pids = OBD_INDIVIDUAL_PIDS;
+            phase = 0;
             can_error_count = 0;
             last_success_time = 0;
+            last_voltage_poll = 0;
+            
+            // Connection loss counts towards ignition-off
+            power_manager_update(false);
+            link_policy_set(LINK_POLICY_POWER_SAVE);
+            if (power_manager_get_state() == POWER_STATE_IGNITION_OFF &&
+                (xTaskGetTickCount() - radio_on_since) >= pdMS_TO_TICKS(POWER_PARKED_RECONNECT_MS)) {
+                park_until_next_probe();
+            } else {
+                task_watchdog_beat(WDT_TASK_OBD, "link_down", 1000);
+                vTaskDelay(pdMS_TO_TICKS(1000));
+            }
+        }
+    }
+}
+
+// Secondary adapter polling: slow channels on their own link, merged through
+// the same parser so the primary link can spend every slot on RPM + throttle
+void obd_secondary_task(void *pv) {
+    elm327_link_t *link = &elm327_links[ELM327_LINK_SECONDARY];
+    uint8_t phase = 0;
+    obd_poll_profile_t active_profile = OBD_PROFILE_NORMAL;
+    TickType_t last_speed_request = 0;
+    
+    LOG_VERBOSE(TAG, "Secondary OBD task started");
+    while (1) {
+        if (elm327_link_is_up(ELM327_LINK_SECONDARY) &&
+            power_manager_get_state() != POWER_STATE_IGNITION_OFF) {
+            uint32_t slot_ms = power_manager_slot_ms();
+            TickType_t now = xTaskGetTickCount();
+            obd_poll_profile_t profile = poll_profile;
+            if (profile != active_profile) {
+                active_profile = profile;
+                phase = 0;
+            }
+            task_watchdog_beat(WDT_TASK_OBD_SECONDARY, "prompt_wait", ELM327_PROMPT_TIMEOUT_MS);
+            if (active_profile == OBD_PROFILE_NORMAL) {
+                elm327_link_send(link, secondary_cmds[phase]);
+                phase = (phase + 1) % (sizeof(secondary_cmds) / sizeof(secondary_cmds[0]));
+            } else if ((now - last_speed_request) + pdMS_TO_TICKS(slot_ms) > pdMS_TO_TICKS(LAUNCH_SPEED_POLL_MS)) {
+                elm327_link_send(link, "010D");
+                last_speed_request = now;
+            } else {
+                elm327_link_send(link, secondary_armed_cmds[phase]);
+                phase = (phase + 1) % (sizeof(secondary_armed_cmds) / sizeof(secondary_armed_cmds[0]));
+            }
+            TickType_t proxy_ticks = 0;
+            if (slot_ms > SPP_PROXY_SLOT_MARGIN_MS) {
+                proxy_ticks = spp_proxy_service_slot(link, slot_ms - SPP_PROXY_SLOT_MARGIN_MS);
+            }
+            if (elm327_link_take_backoff(link)) {
+                task_watchdog_beat(WDT_TASK_OBD_SECONDARY, "backoff", ELM327_BACKOFF_MS);
+                vTaskDelay(pdMS_TO_TICKS(ELM327_BACKOFF_MS));
+            }
+            TickType_t slot = pdMS_TO_TICKS(slot_ms);
+            task_watchdog_beat(WDT_TASK_OBD_SECONDARY, "slot_wait", slot_ms);
+            vTaskDelay(proxy_ticks < slot ? slot - proxy_ticks : 0);
+        } else {
+            phase = 0;
+            task_watchdog_beat(WDT_TASK_OBD_SECONDARY, "idle", 1000);
             vTaskDelay(pdMS_TO_TICKS(1000));
         }
     }
-} 
\ No newline at end of file
+}
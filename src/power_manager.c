@@ -0,0 +1,180 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+
+#include "logging_config.h"
+#include "power_manager.h"
+#include "obd_data.h"
+
+static const char *TAG = "POWER";
+
+// Power state
+static power_state_t power_state = POWER_STATE_ENGINE_RUNNING;
+static volatile uint32_t battery_mv = 0;     // Last AT RV reading (0 = unknown)
+static volatile int64_t battery_mv_us = 0;   // When it arrived
+static uint32_t running_mv = 0;              // Voltage seen while the engine ran
+static int64_t rpm_zero_since_us = 0;        // 0 = RPM currently non-zero
+static int64_t link_down_since_us = 0;       // 0 = link currently up
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t cpu_max_lock = NULL;
+static bool cpu_max_lock_held = false;
+#endif
+
+static const char *state_names[] = { "ENGINE RUNNING", "ENGINE OFF", "IGNITION OFF" };
+
+// Hold the CPU at max frequency (and out of light sleep) only while the engine runs
+static void apply_power_state(power_state_t state) {
+#if CONFIG_PM_ENABLE
+    if (cpu_max_lock == NULL) {
+        return;
+    }
+    bool want_lock = (state == POWER_STATE_ENGINE_RUNNING);
+    if (want_lock && !cpu_max_lock_held) {
+        esp_pm_lock_acquire(cpu_max_lock);
+        cpu_max_lock_held = true;
+    } else if (!want_lock && cpu_max_lock_held) {
+        esp_pm_lock_release(cpu_max_lock);
+        cpu_max_lock_held = false;
+    }
+#endif
+}
+
+static void set_state(power_state_t next) {
+    if (next == power_state) {
+        return;
+    }
+    LOG_INFO(TAG, "Power state: %s -> %s (battery %lu mV)",
+             state_names[power_state], state_names[next], battery_mv);
+    power_state = next;
+    apply_power_state(next);
+}
+
+// Initialize power management (DFS + automatic light sleep). Light sleep
+// engages while parked, once obd_task has turned Bluetooth and the ADC off
+// (both hold PM locks while running); engine-off keeps the link at min
+// frequency
+void power_manager_init(void) {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = POWER_MAX_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_CPU_FREQ_MHZ,
+        .light_sleep_enable = true
+    };
+    esp_err_t ret = esp_pm_configure(&pm_config);
+    if (ret != ESP_OK) {
+        LOG_WARN(TAG, "Failed to configure power management: %s", esp_err_to_name(ret));
+    }
+
+    ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "engine_run", &cpu_max_lock);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to create PM lock: %s", esp_err_to_name(ret));
+        cpu_max_lock = NULL;
+    }
+#else
+    LOG_WARN(TAG, "CONFIG_PM_ENABLE is off - power states only change the polling rate");
+#endif
+
+    // Start at full rate until the first readings say otherwise
+    power_state = POWER_STATE_ENGINE_RUNNING;
+    apply_power_state(power_state);
+    LOG_VERBOSE(TAG, "Power manager initialized");
+}
+
+// Record a battery voltage reading (AT RV reply)
+void power_manager_update_voltage(uint32_t millivolts) {
+    battery_mv_us = esp_timer_get_time();
+    battery_mv = millivolts;
+}
+
+// Evaluate state transitions (called once per polling slot)
+void power_manager_update(bool link_up) {
+    int64_t now_us = esp_timer_get_time();
+    uint32_t mv = battery_mv;
+    bool charging = mv >= POWER_CHARGING_MV;
+
+    // Track link loss
+    if (link_up) {
+        link_down_since_us = 0;
+    } else if (link_down_since_us == 0) {
+        link_down_since_us = now_us;
+    }
+    bool link_lost = !link_up &&
+        (now_us - link_down_since_us) > (int64_t)POWER_LINK_LOSS_MS * 1000;
+
+    // Track how long RPM has been zero
+    if (vehicle_data.rpm > 0) {
+        rpm_zero_since_us = 0;
+    } else if (rpm_zero_since_us == 0) {
+        rpm_zero_since_us = now_us;
+    }
+    bool rpm_zero_confirmed = vehicle_data.rpm == 0 &&
+        (now_us - rpm_zero_since_us) > (int64_t)POWER_ENGINE_OFF_CONFIRM_MS * 1000;
+
+    // Voltage drop from the running level, read after RPM went to zero (an
+    // unknown or older reading cannot confirm the engine stopped)
+    bool voltage_dropped = mv != 0 && running_mv != 0 && battery_mv_us >= rpm_zero_since_us &&
+        mv + POWER_VOLTAGE_DROP_MV <= running_mv;
+
+    switch (power_state) {
+        case POWER_STATE_ENGINE_RUNNING:
+            if (mv > running_mv) {
+                running_mv = mv;
+            }
+            // Engine off: RPM 0 and voltage fell from its running level
+            if (rpm_zero_confirmed && voltage_dropped) {
+                set_state(POWER_STATE_ENGINE_OFF);
+            } else if (link_lost) {
+                set_state(POWER_STATE_IGNITION_OFF);
+            }
+            break;
+
+        case POWER_STATE_ENGINE_OFF:
+            if (vehicle_data.rpm > 0 || charging) {
+                running_mv = mv;
+                set_state(POWER_STATE_ENGINE_RUNNING);
+            } else if (link_lost || (mv != 0 && mv < POWER_LOW_VOLTAGE_MV)) {
+                set_state(POWER_STATE_IGNITION_OFF);
+            }
+            break;
+
+        case POWER_STATE_IGNITION_OFF:
+            if (link_up && (vehicle_data.rpm > 0 || charging)) {
+                running_mv = mv;
+                set_state(POWER_STATE_ENGINE_RUNNING);
+            }
+            break;
+    }
+}
+
+power_state_t power_manager_get_state(void) {
+    return power_state;
+}
+
+uint32_t power_manager_get_voltage_mv(void) {
+    return battery_mv;
+}
+
+// Delay between polling slots for the current state
+uint32_t power_manager_slot_ms(void) {
+    switch (power_state) {
+        case POWER_STATE_ENGINE_OFF:
+            return POWER_SLOT_ENGINE_OFF_MS;
+        case POWER_STATE_IGNITION_OFF:
+            return POWER_SLOT_IGNITION_OFF_MS;
+        default:
+            return POWER_SLOT_RUNNING_MS;
+    }
+}
+
+// How often to poll AT RV in the current state
+uint32_t power_manager_voltage_poll_ms(void) {
+    switch (power_state) {
+        case POWER_STATE_ENGINE_OFF:
+            return POWER_VOLTAGE_POLL_ENGINE_OFF_MS;
+        case POWER_STATE_IGNITION_OFF:
+            return POWER_VOLTAGE_POLL_IGNITION_OFF_MS;
+        default:
+            return POWER_VOLTAGE_POLL_RUNNING_MS;
+    }
+}
@@ -0,0 +1,104 @@
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+#include "logging_config.h"
+#include "publish_policy.h"
+
+static const char *TAG = "PUBLISH";
+
+// Channels without an entry are published always
+static const publish_policy_t policies[] = {
+    { 0x0C, PUBLISH_DEADBAND,  PUBLISH_RPM_DEADBAND,      PUBLISH_HEARTBEAT_MS },  // RPM
+    { 0x11, PUBLISH_DEADBAND,  PUBLISH_THROTTLE_DEADBAND, PUBLISH_HEARTBEAT_MS },  // Throttle
+    { 0x0D, PUBLISH_ON_CHANGE, 0,                         PUBLISH_HEARTBEAT_MS },  // Speed
+    { 0x0E, PUBLISH_ON_CHANGE, 0,                         PUBLISH_HEARTBEAT_MS },  // Timing advance
+    { 0x05, PUBLISH_ON_CHANGE, 0,                         PUBLISH_HEARTBEAT_MS },  // Coolant
+};
+#define POLICY_COUNT (sizeof(policies) / sizeof(policies[0]))
+
+// Last published value per channel
+typedef struct {
+    bool valid;
+    int32_t value;
+    int64_t timestamp_us;
+    uint32_t published;
+    uint32_t suppressed;
+    uint32_t heartbeats;
+} publish_state_t;
+
+static portMUX_TYPE publish_lock = portMUX_INITIALIZER_UNLOCKED;
+static publish_state_t states[POLICY_COUNT];
+
+void publish_policy_init(void) {
+    portENTER_CRITICAL(&publish_lock);
+    memset(states, 0, sizeof(states));
+    portEXIT_CRITICAL(&publish_lock);
+    LOG_VERBOSE(TAG, "Publish policies initialized (%d channels, heartbeat %d ms)",
+                (int)POLICY_COUNT, PUBLISH_HEARTBEAT_MS);
+}
+
+// Decide whether a decoded sample reaches stream consumers (constant time, no logging)
+bool publish_policy_admit(uint8_t pid, int32_t value, int64_t timestamp_us) {
+    int index = -1;
+    for (int i = 0; i < (int)POLICY_COUNT; i++) {
+        if (policies[i].pid == pid) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        return true;
+    }
+    const publish_policy_t *p = &policies[index];
+    publish_state_t *s = &states[index];
+
+    portENTER_CRITICAL(&publish_lock);
+    int32_t delta = value - s->value;
+    bool admit;
+    switch (p->mode) {
+        case PUBLISH_ON_CHANGE:
+            admit = !s->valid || delta != 0;
+            break;
+        case PUBLISH_DEADBAND:
+            admit = !s->valid || delta > p->deadband || delta < -p->deadband;
+            break;
+        default:
+            admit = true;
+            break;
+    }
+    if (!admit && p->heartbeat_ms > 0 &&
+        timestamp_us - s->timestamp_us >= (int64_t)p->heartbeat_ms * 1000) {
+        admit = true;
+        s->heartbeats++;
+    }
+    if (admit) {
+        s->valid = true;
+        s->value = value;
+        s->timestamp_us = timestamp_us;
+        s->published++;
+    } else {
+        s->suppressed++;
+    }
+    portEXIT_CRITICAL(&publish_lock);
+    return admit;
+}
+
+// Published vs suppressed per channel (task context)
+void publish_policy_log_stats(void) {
+    static const char *mode_names[] = { "always", "on change", "deadband" };
+
+    for (int i = 0; i < (int)POLICY_COUNT; i++) {
+        portENTER_CRITICAL(&publish_lock);
+        publish_state_t s = states[i];
+        portEXIT_CRITICAL(&publish_lock);
+
+        uint32_t total = s.published + s.suppressed;
+        if (total == 0) {
+            continue;
+        }
+        LOG_INFO(TAG, "PID %02X %-9s +/-%ld: %lu published (%lu heartbeats), %lu suppressed (%lu%%)",
+                 policies[i].pid, mode_names[policies[i].mode], policies[i].deadband,
+                 s.published, s.heartbeats, s.suppressed, s.suppressed * 100 / total);
+    }
+}
@@ -0,0 +1,271 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/pulse_cnt.h"
+#include <math.h>
+#include <string.h>
+
+#include "logging_config.h"
+#include "pulse_input.h"
+#include "obd_data.h"
+#include "launch_control.h"
+
+static const char *TAG = "PULSE";
+
+#define PULSE_HISTORY_LEN   (PULSE_WINDOW_MAX_MS / PULSE_SAMPLE_PERIOD_MS + 1)
+#define PULSE_COUNT_LIMIT   30000
+
+// One pulse input channel
+typedef struct {
+    const char *name;
+    pcnt_unit_handle_t unit;
+    float units_per_hz;                  // Physical units per Hz (RPM or km/h)
+    
+    // Sliding window of (time, accumulated count) samples
+    int64_t history_us[PULSE_HISTORY_LEN];
+    int history_count[PULSE_HISTORY_LEN];
+    uint32_t history_head;
+    int64_t last_pulse_us;               // Sample at which the count last moved
+    
+    // Fusion state, shared by the sample timer and the OBD parser (BT
+    // callback): only accessed under pulse_lock
+    float raw_value;                     // Uncalibrated physical value
+    float calibration;                   // OBD / pulse ratio
+    float obd_value;                     // Latest OBD sample
+    uint8_t agree;
+    uint8_t disagree;
+    bool trusted;
+} pulse_channel_t;
+
+static pulse_channel_t tach = {
+    .name = "tach",
+    .units_per_hz = 60.0f / PULSE_TACH_PER_REV,
+    .calibration = 1.0f
+};
+
+static pulse_channel_t vss = {
+    .name = "VSS",
+    .units_per_hz = 3600.0f / PULSE_VSS_PER_KM,
+    .calibration = 1.0f
+};
+
+static esp_timer_handle_t sample_timer = NULL;
+static portMUX_TYPE pulse_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Set up one PCNT unit counting rising edges on a pin
+static bool channel_init(pulse_channel_t *ch, gpio_num_t pin) {
+    pcnt_unit_config_t unit_config = {
+        .low_limit = -PULSE_COUNT_LIMIT,
+        .high_limit = PULSE_COUNT_LIMIT,
+        .flags.accum_count = 1       // Keep counting across hardware overflow
+    };
+    esp_err_t ret = pcnt_new_unit(&unit_config, &ch->unit);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to create %s PCNT unit: %s", ch->name, esp_err_to_name(ret));
+        return false;
+    }
+    
+    pcnt_glitch_filter_config_t filter_config = {
+        .max_glitch_ns = PULSE_GLITCH_NS
+    };
+    pcnt_unit_set_glitch_filter(ch->unit, &filter_config);
+    
+    pcnt_chan_config_t chan_config = {
+        .edge_gpio_num = pin,
+        .level_gpio_num = -1
+    };
+    pcnt_channel_handle_t chan = NULL;
+    ret = pcnt_new_channel(ch->unit, &chan_config, &chan);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to create %s PCNT channel: %s", ch->name, esp_err_to_name(ret));
+        return false;
+    }
+    pcnt_channel_set_edge_action(chan, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_HOLD);
+    pcnt_unit_add_watch_point(ch->unit, PULSE_COUNT_LIMIT);
+    
+    pcnt_unit_enable(ch->unit);
+    pcnt_unit_clear_count(ch->unit);
+    pcnt_unit_start(ch->unit);
+    
+    LOG_VERBOSE(TAG, "%s input on pin %d", ch->name, pin);
+    return true;
+}
+
+// Sample the counter and estimate frequency over the sliding window.
+// The window shrinks to the newest span holding PULSE_WINDOW_MIN_COUNT pulses,
+// so high rates respond within a few sample periods and low rates still resolve.
+// Returns the value to publish, or -1 if OBD owns the channel.
+static float channel_sample(pulse_channel_t *ch, int64_t now_us) {
+    if (ch->unit == NULL) {
+        return -1.0f;
+    }
+    
+    int count = 0;
+    pcnt_unit_get_count(ch->unit, &count);
+    
+    if (ch->history_head == 0 || count != ch->history_count[(ch->history_head - 1) % PULSE_HISTORY_LEN]) {
+        ch->last_pulse_us = now_us;
+    }
+    uint32_t newest = ch->history_head % PULSE_HISTORY_LEN;
+    ch->history_us[newest] = now_us;
+    ch->history_count[newest] = count;
+    ch->history_head++;
+    
+    uint32_t filled = ch->history_head < PULSE_HISTORY_LEN ? ch->history_head : PULSE_HISTORY_LEN;
+    uint32_t oldest = newest;
+    for (uint32_t k = 1; k < filled; k++) {
+        oldest = (ch->history_head - 1 - k) % PULSE_HISTORY_LEN;
+        if ((count - ch->history_count[oldest]) >= PULSE_WINDOW_MIN_COUNT) {
+            break;
+        }
+    }
+    
+    int64_t dt_us = now_us - ch->history_us[oldest];
+    int pulses = count - ch->history_count[oldest];
+    float hz = (dt_us > 0) ? (pulses * 1000000.0f / dt_us) : 0.0f;
+    float value = -1.0f;
+    float obd_value = 0.0f;
+    bool lost = false;
+    
+    portENTER_CRITICAL(&pulse_lock);
+    ch->raw_value = hz * ch->units_per_hz;
+    
+    // Signal gone while OBD still reports motion: no pulse for PULSE_LOSS_PERIODS
+    // of the interval the OBD value implies. Hand the channel back at once
+    // instead of publishing the decaying window estimate.
+    bool silent = ch->raw_value <= 0.0f;
+    if (ch->obd_value > 0.0f) {
+        float expected_hz = ch->obd_value / (ch->units_per_hz * ch->calibration);
+        int64_t limit_us = (int64_t)(PULSE_LOSS_PERIODS * 1000000.0f / expected_hz);
+        if (limit_us < 2 * PULSE_SAMPLE_PERIOD_MS * 1000) {
+            limit_us = 2 * PULSE_SAMPLE_PERIOD_MS * 1000;
+        }
+        silent |= (now_us - ch->last_pulse_us) > limit_us;
+    }
+    if (ch->trusted && silent && ch->obd_value > 0.0f) {
+        ch->trusted = false;
+        ch->agree = 0;
+        ch->disagree = 0;
+        obd_value = ch->obd_value;
+        value = obd_value;      // The latest OBD sample stands until the next one
+        lost = true;
+    } else if (ch->trusted) {
+        value = ch->raw_value * ch->calibration;
+    }
+    portEXIT_CRITICAL(&pulse_lock);
+    
+    if (lost) {
+        LOG_WARN(TAG, "%s pulses lost (OBD %.0f) - using OBD", ch->name, obd_value);
+    }
+    return value;
+}
+
+// Periodic counter sampling; publishes pulse values the OBD fusion trusts
+static void sample_timer_callback(void *arg) {
+    int64_t now_us = esp_timer_get_time();
+    bool published = false;
+    
+    float rpm = channel_sample(&tach, now_us);
+    float speed = channel_sample(&vss, now_us);
+    
+    if (rpm >= 0.0f) {
+        vehicle_data_publish_rpm((uint32_t)(rpm + 0.5f));
+        published = true;
+    }
+    if (speed >= 0.0f) {
+        vehicle_data_publish_speed((uint8_t)fminf(speed + 0.5f, 255.0f));
+        published = true;
+    }
+    
+    // Low-latency path into the output logic
+    if (published) {
+        launch_control_evaluate();
+    }
+}
+
+// Compare pulse and OBD values; calibrate on agreement, drop trust on persistent
+// mismatch, or at once when no pulses arrive while OBD reports motion
+static bool channel_fuse(pulse_channel_t *ch, float obd_value, float compare_min) {
+    bool gained = false;
+    bool dropped = false;
+    
+    portENTER_CRITICAL(&pulse_lock);
+    float raw = ch->raw_value;
+    float pulse_value = raw * ch->calibration;
+    bool compare = obd_value >= compare_min || pulse_value >= compare_min;
+    ch->obd_value = obd_value;
+    
+    if (ch->trusted && raw <= 0.0f && obd_value > 0.0f) {
+        ch->trusted = false;
+        ch->agree = 0;
+        ch->disagree = 0;
+        dropped = true;
+    } else if (compare) {
+        float reference = fmaxf(obd_value, compare_min);
+        bool plausible = raw > 0.0f &&
+            fabsf(pulse_value - obd_value) <= reference * PULSE_PLAUSIBLE_PCT / 100.0f;
+        
+        if (plausible) {
+            ch->disagree = 0;
+            if (obd_value >= compare_min) {
+                float ratio = obd_value / raw;
+                ch->calibration += PULSE_CAL_GAIN * (ratio - ch->calibration);
+            }
+            if (!ch->trusted && ++ch->agree >= PULSE_TRUST_COUNT) {
+                ch->trusted = true;
+                gained = true;
+            }
+        } else {
+            ch->agree = 0;
+            if (ch->trusted && ++ch->disagree >= PULSE_TRUST_COUNT) {
+                ch->trusted = false;
+                dropped = true;
+            }
+        }
+    }
+    bool trusted = ch->trusted;
+    float calibration = ch->calibration;
+    portEXIT_CRITICAL(&pulse_lock);
+    
+    if (gained) {
+        LOG_INFO(TAG, "%s pulses trusted (calibration %.3f)", ch->name, calibration);
+    } else if (dropped) {
+        LOG_WARN(TAG, "%s pulses implausible (pulse %.0f vs OBD %.0f) - using OBD",
+                 ch->name, pulse_value, obd_value);
+    }
+    return trusted;
+}
+
+// Initialize pulse inputs and start counter sampling
+void pulse_input_init(void) {
+    channel_init(&tach, PULSE_TACH_PIN);
+    channel_init(&vss, PULSE_VSS_PIN);
+    
+    const esp_timer_create_args_t timer_args = {
+        .callback = sample_timer_callback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "pulse_sample"
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &sample_timer);
+    if (ret == ESP_OK) {
+        ret = esp_timer_start_periodic(sample_timer, PULSE_SAMPLE_PERIOD_MS * 1000);
+    }
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Failed to start pulse sampling: %s", esp_err_to_name(ret));
+        return;
+    }
+    
+    LOG_VERBOSE(TAG, "Pulse inputs initialized (%d ppr tach, %d p/km VSS)",
+                PULSE_TACH_PER_REV, PULSE_VSS_PER_KM);
+}
+
+// OBD RPM sample arrived: true if the tach owns the RPM channel
+bool pulse_input_fuse_rpm(uint32_t obd_rpm) {
+    return channel_fuse(&tach, (float)obd_rpm, PULSE_RPM_COMPARE_MIN);
+}
+
+// OBD speed sample arrived: true if the VSS owns the speed channel
+bool pulse_input_fuse_speed(uint8_t obd_speed) {
+    return channel_fuse(&vss, (float)obd_speed, PULSE_SPEED_COMPARE_MIN);
+}
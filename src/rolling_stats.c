@@ -0,0 +1,176 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "logging_config.h"
+#include "rolling_stats.h"
+
+static const char *TAG = "ROLLING";
+
+#define FITS_WINDOW(capacity, window_ms, period_ms) \
+    ((capacity) >= (window_ms) / (period_ms) + 1 && ((capacity) & ((capacity) - 1)) == 0)
+
+#if !FITS_WINDOW(ROLLING_CAPACITY_RPM, ROLLING_WINDOW_RPM_MS, ROLLING_PERIOD_RPM_MS)
+#error "ROLLING_CAPACITY_RPM must be a power of two holding a full RPM window"
+#endif
+#if !FITS_WINDOW(ROLLING_CAPACITY_THROTTLE, ROLLING_WINDOW_THROTTLE_MS, ROLLING_PERIOD_THROTTLE_MS)
+#error "ROLLING_CAPACITY_THROTTLE must be a power of two holding a full throttle window"
+#endif
+#if !FITS_WINDOW(ROLLING_CAPACITY_SPEED, ROLLING_WINDOW_SPEED_MS, ROLLING_PERIOD_SPEED_MS)
+#error "ROLLING_CAPACITY_SPEED must be a power of two holding a full speed window"
+#endif
+
+#define SLOT(w, seq) ((seq) & (w)->mask)
+
+typedef struct {
+    int64_t timestamp_us;
+    int32_t value;
+} rolling_sample_t;
+
+// One channel: samples in arrival order plus two deques of sample sequence
+// numbers whose values are ascending (min) and descending (max) front to back.
+// Sequence numbers are free running; sample seq lives in samples[SLOT(w, seq)].
+typedef struct {
+    int64_t window_us;
+    uint32_t mask;                  // Capacity - 1
+    rolling_sample_t *samples;
+    uint32_t head;                  // Next sequence number
+    uint32_t tail;                  // Oldest sample still in the window
+    uint32_t *min_q;
+    uint32_t min_front, min_back;
+    uint32_t *max_q;
+    uint32_t max_front, max_back;
+    int64_t sum;
+    uint32_t overflows;             // Samples dropped before leaving the window
+} rolling_window_t;
+
+// Per-channel storage sized for its own window
+#define CHANNEL_STORAGE(name, capacity) \
+    static rolling_sample_t name##_samples[capacity]; \
+    static uint32_t name##_min_q[capacity]; \
+    static uint32_t name##_max_q[capacity]
+
+CHANNEL_STORAGE(rpm, ROLLING_CAPACITY_RPM);
+CHANNEL_STORAGE(throttle, ROLLING_CAPACITY_THROTTLE);
+CHANNEL_STORAGE(speed, ROLLING_CAPACITY_SPEED);
+
+#define CHANNEL_WINDOW(name, capacity) \
+    { .mask = (capacity) - 1, .samples = name##_samples, .min_q = name##_min_q, .max_q = name##_max_q }
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static rolling_window_t windows[ROLLING_CH_COUNT] = {
+    [ROLLING_CH_RPM]      = CHANNEL_WINDOW(rpm, ROLLING_CAPACITY_RPM),
+    [ROLLING_CH_THROTTLE] = CHANNEL_WINDOW(throttle, ROLLING_CAPACITY_THROTTLE),
+    [ROLLING_CH_SPEED]    = CHANNEL_WINDOW(speed, ROLLING_CAPACITY_SPEED),
+};
+rolling_stats_t vehicle_stats[ROLLING_CH_COUNT];
+
+static const char *channel_names[ROLLING_CH_COUNT] = { "rpm", "throttle", "speed" };
+
+void rolling_stats_init(void) {
+    static const uint32_t window_ms[ROLLING_CH_COUNT] = {
+        [ROLLING_CH_RPM]      = ROLLING_WINDOW_RPM_MS,
+        [ROLLING_CH_THROTTLE] = ROLLING_WINDOW_THROTTLE_MS,
+        [ROLLING_CH_SPEED]    = ROLLING_WINDOW_SPEED_MS,
+    };
+
+    portENTER_CRITICAL(&stats_lock);
+    for (int i = 0; i < ROLLING_CH_COUNT; i++) {
+        rolling_window_t *w = &windows[i];
+        w->window_us = (int64_t)window_ms[i] * 1000;
+        w->head = w->tail = 0;
+        w->min_front = w->min_back = 0;
+        w->max_front = w->max_back = 0;
+        w->sum = 0;
+        w->overflows = 0;
+        vehicle_stats[i] = (rolling_stats_t){ 0 };
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    LOG_VERBOSE(TAG, "Rolling statistics initialized (rpm %d, throttle %d, speed %d samples)",
+                ROLLING_CAPACITY_RPM, ROLLING_CAPACITY_THROTTLE, ROLLING_CAPACITY_SPEED);
+}
+
+// Drop the oldest sample; deque fronts referring to it go with it
+static void pop_oldest(rolling_window_t *w) {
+    w->sum -= w->samples[SLOT(w, w->tail)].value;
+    w->tail++;
+    if (w->min_front != w->min_back && w->min_q[SLOT(w, w->min_front)] == w->tail - 1) {
+        w->min_front++;
+    }
+    if (w->max_front != w->max_back && w->max_q[SLOT(w, w->max_front)] == w->tail - 1) {
+        w->max_front++;
+    }
+}
+
+static void expire(rolling_window_t *w, int64_t now_us) {
+    while (w->tail != w->head && now_us - w->samples[SLOT(w, w->tail)].timestamp_us > w->window_us) {
+        pop_oldest(w);
+    }
+}
+
+// Snapshot from the deque fronts and the running sum (constant time)
+static void snapshot(const rolling_window_t *w, rolling_stats_t *out) {
+    uint32_t count = w->head - w->tail;
+    if (count == 0) {
+        *out = (rolling_stats_t){ 0 };
+        return;
+    }
+    out->min = w->samples[SLOT(w, w->min_q[SLOT(w, w->min_front)])].value;
+    out->max = w->samples[SLOT(w, w->max_q[SLOT(w, w->max_front)])].value;
+    out->mean = (int32_t)(w->sum / (int64_t)count);
+    out->count = (uint16_t)count;
+    out->span_ms = (uint32_t)((w->samples[SLOT(w, w->head - 1)].timestamp_us -
+                               w->samples[SLOT(w, w->tail)].timestamp_us) / 1000);
+}
+
+// Add a sample: each sample enters and leaves each deque at most once
+void rolling_stats_push(rolling_channel_t channel, int32_t value) {
+    rolling_window_t *w = &windows[channel];
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&stats_lock);
+    expire(w, now_us);
+    if (w->head - w->tail == w->mask + 1) {
+        pop_oldest(w);
+        w->overflows++;
+    }
+
+    uint32_t seq = w->head;
+    w->samples[SLOT(w, seq)].timestamp_us = now_us;
+    w->samples[SLOT(w, seq)].value = value;
+    w->sum += value;
+
+    // Samples that can never be the minimum (maximum) again leave from the back
+    while (w->min_back != w->min_front && w->samples[SLOT(w, w->min_q[SLOT(w, w->min_back - 1)])].value >= value) {
+        w->min_back--;
+    }
+    w->min_q[SLOT(w, w->min_back++)] = seq;
+    while (w->max_back != w->max_front && w->samples[SLOT(w, w->max_q[SLOT(w, w->max_back - 1)])].value <= value) {
+        w->max_back--;
+    }
+    w->max_q[SLOT(w, w->max_back++)] = seq;
+    w->head++;
+
+    snapshot(w, &vehicle_stats[channel]);
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+// Current statistics; samples that aged out since the last push are dropped first
+void rolling_stats_get(rolling_channel_t channel, rolling_stats_t *out) {
+    rolling_window_t *w = &windows[channel];
+
+    portENTER_CRITICAL(&stats_lock);
+    expire(w, esp_timer_get_time());
+    snapshot(w, &vehicle_stats[channel]);
+    *out = vehicle_stats[channel];
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void rolling_stats_log(void) {
+    for (int i = 0; i < ROLLING_CH_COUNT; i++) {
+        rolling_stats_t s;
+        rolling_stats_get((rolling_channel_t)i, &s);
+        LOG_DEBUG(TAG, "%-8s min %ld max %ld mean %ld (%u samples over %lu ms, %lu dropped early)",
+                  channel_names[i], s.min, s.max, s.mean, s.count, s.span_ms, windows[i].overflows);
+    }
+}
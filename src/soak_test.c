@@ -0,0 +1,175 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+
+#include "logging_config.h"
+#include "soak_test.h"
+#include "histogram.h"
+#include "elm327_sim.h"
+
+static const char *TAG = "SOAK";
+
+// Per fault type recovery statistics
+typedef struct {
+    histogram_t time_to_sample;     // Fault cleared -> first decoded sample (ms)
+    histogram_t samples_lost;       // Expected at the healthy rate minus received
+    uint32_t injected;
+    uint32_t failed;                // No sample within SOAK_RECOVERY_TIMEOUT_MS
+} fault_stats_t;
+
+static const char *fault_names[ELM327_SIM_FAULT_COUNT] = { "none", "link close", "adapter hang", "NO DATA storm" };
+
+static fault_stats_t stats[ELM327_SIM_FAULT_COUNT];
+static uint32_t prng_state = SOAK_TEST_SEED;
+
+// Sample stream (written from the simulator task via the parser)
+static volatile uint32_t sample_count = 0;
+static volatile int64_t last_sample_us = 0;
+
+// Resource baseline taken once the first connection is healthy
+static uint32_t baseline_heap = 0;
+static UBaseType_t baseline_tasks = 0;
+static UBaseType_t max_task_growth = 0;
+static uint32_t max_heap_drop = 0;
+
+// xorshift32: reproducible fault schedule
+static uint32_t prng_next(void) {
+    prng_state ^= prng_state << 13;
+    prng_state ^= prng_state >> 17;
+    prng_state ^= prng_state << 5;
+    return prng_state;
+}
+
+static uint32_t random_between(uint32_t min, uint32_t max) {
+    return min + prng_next() % (max - min + 1);
+}
+
+// Count first: a waiter that sees the new timestamp also sees the count
+void soak_test_on_sample(void) {
+    sample_count++;
+    last_sample_us = esp_timer_get_time();
+}
+
+// Wait for a decoded sample newer than after_us; returns its time or 0 on timeout
+static int64_t wait_for_sample(int64_t after_us, uint32_t timeout_ms) {
+    TickType_t start = xTaskGetTickCount();
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(timeout_ms)) {
+        if (last_sample_us > after_us) {
+            return last_sample_us;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return 0;
+}
+
+// Compare heap and task count against the healthy baseline
+static void check_resources(void) {
+    uint32_t heap = esp_get_free_heap_size();
+    UBaseType_t tasks = uxTaskGetNumberOfTasks();
+    
+    if (baseline_heap > heap && baseline_heap - heap > max_heap_drop) {
+        max_heap_drop = baseline_heap - heap;
+    }
+    if (tasks > baseline_tasks && tasks - baseline_tasks > max_task_growth) {
+        max_task_growth = tasks - baseline_tasks;
+        LOG_WARN(TAG, "Task count grew to %u (baseline %u) after recovery", (unsigned)tasks, (unsigned)baseline_tasks);
+    }
+}
+
+static void log_report(uint32_t elapsed_s) {
+    char label[32];
+    
+    LOG_INFO(TAG, "Soak report after %lu s (heap drop max %lu B, min free %lu B, task growth max %u)",
+             elapsed_s, max_heap_drop, esp_get_minimum_free_heap_size(), (unsigned)max_task_growth);
+    histogram_log_header(TAG, "ms / samples");
+    for (int f = ELM327_SIM_FAULT_LINK_CLOSE; f < ELM327_SIM_FAULT_COUNT; f++) {
+        if (stats[f].injected == 0) {
+            continue;
+        }
+        LOG_INFO(TAG, "%s: %lu injected, %lu failed to recover", fault_names[f], stats[f].injected, stats[f].failed);
+        snprintf(label, sizeof(label), "%s recovery", fault_names[f]);
+        histogram_log_row(TAG, label, &stats[f].time_to_sample);
+        snprintf(label, sizeof(label), "%s lost", fault_names[f]);
+        histogram_log_row(TAG, label, &stats[f].samples_lost);
+    }
+}
+
+// Soak task: alternate healthy periods and random faults, forever
+void soak_test_task(void *pv) {
+    for (int f = 0; f < ELM327_SIM_FAULT_COUNT; f++) {
+        histogram_init(&stats[f].time_to_sample, SOAK_RECOVERY_BUCKET_MS);
+        histogram_init(&stats[f].samples_lost, SOAK_LOST_BUCKET_SAMPLES);
+    }
+    
+    // Healthy baseline: first sample, then let initialization tasks finish
+    while (wait_for_sample(0, SOAK_RECOVERY_TIMEOUT_MS) == 0) {
+        LOG_WARN(TAG, "Waiting for first sample...");
+    }
+    vTaskDelay(pdMS_TO_TICKS(SOAK_SETTLE_MS));
+    baseline_heap = esp_get_free_heap_size();
+    baseline_tasks = uxTaskGetNumberOfTasks();
+    int64_t soak_start_us = esp_timer_get_time();
+    int64_t last_report_us = soak_start_us;
+    LOG_INFO(TAG, "Soak started (heap %lu B, %u tasks)", baseline_heap, (unsigned)baseline_tasks);
+    
+    while (1) {
+        // Healthy period also measures the expected sample rate
+        uint32_t healthy_ms = random_between(SOAK_HEALTHY_MIN_MS, SOAK_HEALTHY_MAX_MS);
+        uint32_t count_before = sample_count;
+        vTaskDelay(pdMS_TO_TICKS(healthy_ms));
+        uint32_t rate_x1000 = (sample_count - count_before) * 1000000 / healthy_ms;   // samples/s x1000
+        
+        // Inject one fault
+        elm327_sim_fault_t fault = (elm327_sim_fault_t)random_between(ELM327_SIM_FAULT_LINK_CLOSE,
+                                                                      ELM327_SIM_FAULT_COUNT - 1);
+        uint32_t duration_ms;
+        switch (fault) {
+            case ELM327_SIM_FAULT_LINK_CLOSE:
+                duration_ms = random_between(SOAK_LINK_DOWN_MIN_MS, SOAK_LINK_DOWN_MAX_MS);
+                break;
+            case ELM327_SIM_FAULT_HANG:
+                duration_ms = random_between(SOAK_HANG_MIN_MS, SOAK_HANG_MAX_MS);
+                break;
+            default:
+                duration_ms = random_between(SOAK_NO_DATA_MIN_MS, SOAK_NO_DATA_MAX_MS);
+                break;
+        }
+        
+        int64_t fault_start_us = esp_timer_get_time();
+        uint32_t count_at_fault = sample_count;
+        elm327_sim_inject_fault(fault, duration_ms);
+        vTaskDelay(pdMS_TO_TICKS(duration_ms));
+        if (fault == ELM327_SIM_FAULT_LINK_CLOSE) {
+            elm327_sim_link_reopen();
+        }
+        int64_t fault_end_us = esp_timer_get_time();
+        stats[fault].injected++;
+        
+        // Recovery: first sample after the fault cleared
+        int64_t first_us = wait_for_sample(fault_end_us, SOAK_RECOVERY_TIMEOUT_MS);
+        if (first_us == 0) {
+            stats[fault].failed++;
+            LOG_ERROR(TAG, "No sample %d ms after %s cleared", SOAK_RECOVERY_TIMEOUT_MS, fault_names[fault]);
+            continue;
+        }
+        histogram_record(&stats[fault].time_to_sample, (uint32_t)((first_us - fault_end_us) / 1000));
+        
+        // Loss: samples the healthy rate would have produced over the outage
+        uint32_t outage_ms = (uint32_t)((first_us - fault_start_us) / 1000);
+        uint32_t expected = (uint32_t)((uint64_t)rate_x1000 * outage_ms / 1000000);
+        uint32_t received = sample_count - count_at_fault;
+        received = received > 0 ? received - 1 : 0;   // Exclude the recovery sample
+        histogram_record(&stats[fault].samples_lost, expected > received ? expected - received : 0);
+        
+        vTaskDelay(pdMS_TO_TICKS(SOAK_SETTLE_MS));
+        check_resources();
+        
+        if ((esp_timer_get_time() - last_report_us) >= (int64_t)SOAK_REPORT_INTERVAL_MS * 1000) {
+            log_report((uint32_t)((esp_timer_get_time() - soak_start_us) / 1000000));
+            last_report_us = esp_timer_get_time();
+        }
+    }
+}
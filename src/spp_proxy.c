@@ -0,0 +1,313 @@
+#include "esp_log.h"
+#include "esp_spp_api.h"
+#include "esp_gap_bt_api.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "logging_config.h"
+#include "spp_proxy.h"
+#include "obd_data.h"
+#include "power_manager.h"
+
+static const char *TAG = "SPP_PROXY";
+
+// Phone session (one client, like a real adapter)
+static uint32_t phone_handle = 0;
+static bool echo_on = true;
+static bool linefeeds_on = false;
+static char cmd_buffer[SPP_PROXY_CMD_MAX];
+static uint16_t cmd_len = 0;
+
+// Request waiting for an adapter slot, and the reply being collected for it
+static portMUX_TYPE forward_lock = portMUX_INITIALIZER_UNLOCKED;
+static char forward_cmd[SPP_PROXY_CMD_MAX];
+static volatile bool forward_pending = false;
+static char inflight_cmd[SPP_PROXY_CMD_MAX];
+static char forward_reply[SPP_PROXY_REPLY_MAX];
+static uint16_t forward_reply_len = 0;
+
+// Counters
+static uint32_t answered_cached = 0;
+static uint32_t answered_local = 0;
+static uint32_t forwarded = 0;
+static uint32_t rejected = 0;
+
+// Send text to the phone, translating line ends per ATL
+static void phone_write(const char *text) {
+    char out[SPP_PROXY_REPLY_MAX + 32];
+    uint16_t n = 0;
+    
+    if (phone_handle == 0) {
+        return;
+    }
+    for (const char *p = text; *p && n < sizeof(out) - 2; p++) {
+        out[n++] = *p;
+        if (*p == '\r' && linefeeds_on) {
+            out[n++] = '\n';
+        }
+    }
+    esp_spp_write(phone_handle, n, (uint8_t *)out);
+}
+
+// Complete reply: optional echo, body lines, blank line and prompt
+static void phone_reply(const char *cmd, const char *body) {
+    char text[SPP_PROXY_REPLY_MAX + SPP_PROXY_CMD_MAX + 8];
+    snprintf(text, sizeof(text), "%s%s%s\r\r>", echo_on ? cmd : "", echo_on ? "\r" : "", body);
+    phone_write(text);
+}
+
+// Answer AT commands locally: adapter configuration stays ours
+static void handle_at_command(const char *cmd) {
+    char body[40];
+    const char *at = cmd + 2;
+    
+    if (strcmp(at, "Z") == 0 || strcmp(at, "WS") == 0) {
+        echo_on = true;
+        linefeeds_on = false;
+        phone_reply(cmd, "\rELM327 v1.5");
+        return;
+    } else if (strcmp(at, "E0") == 0 || strcmp(at, "E1") == 0) {
+        echo_on = at[1] == '1';
+        strcpy(body, "OK");
+    } else if (strcmp(at, "L0") == 0 || strcmp(at, "L1") == 0) {
+        linefeeds_on = at[1] == '1';
+        strcpy(body, "OK");
+    } else if (strcmp(at, "I") == 0) {
+        strcpy(body, "ELM327 v1.5");
+    } else if (strcmp(at, "@1") == 0) {
+        strcpy(body, "OBDII proxy");
+    } else if (strcmp(at, "RV") == 0) {
+        uint32_t mv = power_manager_get_voltage_mv();
+        snprintf(body, sizeof(body), "%lu.%luV", mv / 1000, (mv % 1000) / 100);
+    } else if (strcmp(at, "DP") == 0) {
+        strcpy(body, "AUTO, ISO 15765-4 (CAN 11/500)");
+    } else if (strcmp(at, "DPN") == 0) {
+        strcpy(body, "A6");
+    } else {
+        strcpy(body, "OK");     // ATH, ATS, ATSP, ATST, ... acknowledged, not applied
+    }
+    answered_local++;
+    phone_reply(cmd, body);
+}
+
+// Answer a Mode 01 request from cached values when every PID is polled and fresh
+static bool answer_from_cache(const char *cmd) {
+    char body[64];
+    size_t used = snprintf(body, sizeof(body), "41");
+    size_t len = strlen(cmd);
+    
+    if (len < 4 || (len % 2) != 0 || strncmp(cmd, "01", 2) != 0) {
+        return false;
+    }
+    for (size_t i = 2; i + 1 < len && used < sizeof(body); i += 2) {
+        char hex[3] = { cmd[i], cmd[i + 1], '\0' };
+        uint8_t pid = (uint8_t)strtol(hex, NULL, 16);
+        if (vehicle_data_age_ms(pid) > SPP_PROXY_CACHE_MAX_AGE_MS) {
+            return false;
+        }
+        switch (pid) {
+            case 0x0C: {
+                uint16_t raw = (uint16_t)(vehicle_data.rpm * 4);
+                used += snprintf(body + used, sizeof(body) - used, " 0C %02X %02X", raw >> 8, raw & 0xFF);
+                break;
+            }
+            case 0x0D:
+                used += snprintf(body + used, sizeof(body) - used, " 0D %02X", vehicle_data.vehicle_speed);
+                break;
+            case 0x11:
+                used += snprintf(body + used, sizeof(body) - used, " 11 %02X",
+                                 vehicle_data.throttle_position * 255 / 100);
+                break;
+            case 0x0E:
+                used += snprintf(body + used, sizeof(body) - used, " 0E %02X",
+                                 (uint8_t)((vehicle_data.timing_advance + 64) * 2));
+                break;
+            case 0x05:
+                used += snprintf(body + used, sizeof(body) - used, " 05 %02X",
+                                 (uint8_t)(vehicle_data.coolant_temp + 40));
+                break;
+            default:
+                return false;
+        }
+    }
+    answered_cached++;
+    phone_reply(cmd, body);
+    return true;
+}
+
+// Read-only requests only: Mode 01 with up to SPP_PROXY_MAX_PIDS PIDs or one
+// Mode 09 PID, each optionally followed by the ELM327 response-count digit.
+// Clearing DTCs, actuator tests and raw frames never reach the bus
+static bool request_allowed(const char *cmd) {
+    size_t len = strlen(cmd);
+    if (len < 4) {
+        return false;
+    }
+    size_t pid_chars = len - 2 - (len % 2);     // Odd length: trailing response count
+    if (strncmp(cmd, "01", 2) == 0) {
+        if (pid_chars > 2 * SPP_PROXY_MAX_PIDS) {
+            return false;
+        }
+    } else if (strncmp(cmd, "09", 2) != 0 || pid_chars != 2) {
+        return false;
+    }
+    for (size_t i = 2; i < len; i++) {
+        char c = cmd[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// One complete command line from the phone
+static void handle_phone_command(char *cmd) {
+    // Normalize: uppercase, no spaces (ELM327 ignores spaces)
+    uint16_t n = 0;
+    for (char *p = cmd; *p; p++) {
+        if (*p != ' ') {
+            cmd[n++] = (*p >= 'a' && *p <= 'z') ? (char)(*p - 'a' + 'A') : *p;
+        }
+    }
+    cmd[n] = '\0';
+    if (n == 0) {
+        return;
+    }
+    
+    if (strncmp(cmd, "AT", 2) == 0) {
+        handle_at_command(cmd);
+    } else if (!request_allowed(cmd)) {
+        rejected++;
+        phone_reply(cmd, "?");
+    } else if (!answer_from_cache(cmd)) {
+        // Needs the bus: queue for the next idle slot on an adapter
+        portENTER_CRITICAL(&forward_lock);
+        strncpy(forward_cmd, cmd, sizeof(forward_cmd) - 1);
+        forward_cmd[sizeof(forward_cmd) - 1] = '\0';
+        forward_pending = true;
+        portEXIT_CRITICAL(&forward_lock);
+    }
+}
+
+void spp_proxy_start_server(void) {
+#if CONFIG_BT_SSP_ENABLED
+    // No display or keyboard: SSP pairing is just-works, the link is still
+    // bonded and encrypted
+    esp_bt_io_cap_t iocap = ESP_BT_IO_CAP_NONE;
+    esp_bt_gap_set_security_param(ESP_BT_SP_IOCAP_MODE, &iocap, sizeof(iocap));
+#endif
+    esp_bt_pin_code_t pin;
+    memcpy(pin, SPP_PROXY_PIN, strlen(SPP_PROXY_PIN));
+    esp_bt_gap_set_pin(ESP_BT_PIN_TYPE_FIXED, strlen(SPP_PROXY_PIN), pin);
+    
+    esp_bt_gap_set_device_name(SPP_PROXY_DEVICE_NAME);
+    esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
+    esp_err_t ret = esp_spp_start_srv(ESP_SPP_SEC_AUTHENTICATE | ESP_SPP_SEC_ENCRYPT, ESP_SPP_ROLE_SLAVE, 0,
+                                      SPP_PROXY_SERVER_NAME);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "SPP server start failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    LOG_INFO(TAG, "ELM327 proxy server '%s' started", SPP_PROXY_SERVER_NAME);
+}
+
+bool spp_proxy_owns(uint32_t handle) {
+    return phone_handle != 0 && handle == phone_handle;
+}
+
+void spp_proxy_on_open(uint32_t handle) {
+    phone_handle = handle;
+    echo_on = true;
+    linefeeds_on = false;
+    cmd_len = 0;
+    forward_pending = false;
+    LOG_INFO(TAG, "Phone connected to proxy");
+}
+
+void spp_proxy_on_close(void) {
+    phone_handle = 0;
+    forward_pending = false;
+    LOG_INFO(TAG, "Phone disconnected (cached %lu, local %lu, forwarded %lu, rejected %lu)",
+             answered_cached, answered_local, forwarded, rejected);
+}
+
+// Bytes from the phone: commands end with CR
+void spp_proxy_on_data(const uint8_t *data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        char c = (char)data[i];
+        if (c == '\r') {
+            cmd_buffer[cmd_len] = '\0';
+            handle_phone_command(cmd_buffer);
+            cmd_len = 0;
+        } else if (c >= 32 && c <= 126 && cmd_len < SPP_PROXY_CMD_MAX - 1) {
+            cmd_buffer[cmd_len++] = c;
+        }
+    }
+}
+
+// Forward the pending phone request in the idle tail of a polling slot
+TickType_t spp_proxy_service_slot(elm327_link_t *link, uint32_t budget_ms) {
+    char cmd[SPP_PROXY_CMD_MAX];
+    TickType_t start = xTaskGetTickCount();
+    TickType_t budget = pdMS_TO_TICKS(budget_ms);
+    
+    if (!forward_pending || phone_handle == 0) {
+        return 0;
+    }
+    
+    // Our own request must be complete first (elapsed can exceed the budget:
+    // compare forward, never subtract from the budget)
+    if (!elm327_link_wait_ready(link, budget) ||
+        (xTaskGetTickCount() - start) + pdMS_TO_TICKS(SPP_PROXY_FORWARD_MIN_MS) >= budget) {
+        return xTaskGetTickCount() - start;
+    }
+    
+    portENTER_CRITICAL(&forward_lock);
+    strcpy(cmd, forward_cmd);
+    forward_pending = false;
+    portEXIT_CRITICAL(&forward_lock);
+    
+    strcpy(inflight_cmd, cmd);
+    forward_reply_len = 0;
+    forward_reply[0] = '\0';
+    link->forwarding = true;
+    if (elm327_link_send(link, cmd) != ESP_OK) {
+        link->forwarding = false;
+        phone_reply(cmd, "CAN ERROR");
+        return xTaskGetTickCount() - start;
+    }
+    forwarded++;
+    
+    // Reply goes to the phone from the receive path (its prompt sets ready);
+    // abort if it would eat our next slot
+    TickType_t spent = xTaskGetTickCount() - start;
+    elm327_link_wait_ready(link, spent < budget ? budget - spent : 0);
+    if (link->forwarding) {
+        LOG_DEBUG(TAG, "Forwarded '%s' overran the slot, aborting", cmd);
+        elm327_link_abort(link);
+    }
+    return xTaskGetTickCount() - start;
+}
+
+// A phone request is waiting for an adapter slot
+bool spp_proxy_forward_pending(void) {
+    return forward_pending && phone_handle != 0;
+}
+
+// Collect forwarded reply lines (receive path)
+void spp_proxy_on_adapter_line(const char *line) {
+    int n = snprintf(forward_reply + forward_reply_len, sizeof(forward_reply) - forward_reply_len,
+                     "%s%s", forward_reply_len ? "\r" : "", line);
+    if (n > 0 && forward_reply_len + (size_t)n < sizeof(forward_reply)) {
+        forward_reply_len += n;
+    }
+}
+
+// Adapter prompt: forwarded reply complete
+void spp_proxy_on_adapter_prompt(void) {
+    phone_reply(inflight_cmd, forward_reply_len ? forward_reply : "NO DATA");
+}
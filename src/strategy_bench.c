@@ -0,0 +1,167 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "logging_config.h"
+#include "strategy_bench.h"
+#include "histogram.h"
+#include "elm327.h"
+#include "elm327_sim.h"
+
+static const char *TAG = "STRATEGY";
+
+// Channels compared across variants
+typedef enum {
+    CHANNEL_RPM = 0,
+    CHANNEL_THROTTLE,
+    CHANNEL_SPEED,
+    CHANNEL_COUNT
+} bench_channel_t;
+
+static const char *channel_names[CHANNEL_COUNT] = { "rpm", "throttle", "speed" };
+
+// Request cycles under test
+static const char *const alternate_cmds[] = { "010C11", "010D" };
+static const char *const single_cmds[] = { "010C", "0111", "010D" };
+static const char *const batch_cmds[] = { "010C110D" };
+static const char *const rpm_biased_cmds[] = { "010C11", "010C0D" };
+static const char *const batch_one_reply_cmds[] = { "010C110D1" };   // Response-count digit
+
+static const strategy_variant_t variants[] = {
+    { "alternate 010C11/010D",  alternate_cmds,  2, 150, ELM327_ATST_VALUE },
+    { "single PIDs",            single_cmds,     3, 150, ELM327_ATST_VALUE },
+    { "batch 010C110D",         batch_cmds,      1, 150, ELM327_ATST_VALUE },
+    { "alternate on prompt",    alternate_cmds,  2, 0,   ELM327_ATST_VALUE },
+    { "batch on prompt",        batch_cmds,      1, 0,   ELM327_ATST_VALUE },
+    { "rpm-biased on prompt",   rpm_biased_cmds, 2, 0,   ELM327_ATST_VALUE },
+    { "alternate, ATST 19",     alternate_cmds,  2, 0,   "19" },
+    { "alternate, ATST 0A",     alternate_cmds,  2, 0,   "0A" },
+    { "batch, 1 response",      batch_one_reply_cmds, 1, 0, ELM327_ATST_VALUE },
+};
+#define VARIANT_COUNT (sizeof(variants) / sizeof(variants[0]))
+
+// Summary kept per variant for the final table
+typedef struct {
+    uint32_t samples_x10[CHANNEL_COUNT];    // samples/s x10
+    uint32_t age_p50_ms[CHANNEL_COUNT];
+    uint32_t age_p99_ms[CHANNEL_COUNT];
+    uint32_t bytes_per_s;
+    uint32_t cycles_per_sample;
+} variant_result_t;
+
+static volatile bool run_active = false;
+static histogram_t value_age[CHANNEL_COUNT];
+static uint32_t sample_count[CHANNEL_COUNT];
+static variant_result_t results[VARIANT_COUNT];
+
+// Parser hook (simulator task context)
+void strategy_bench_on_pid(uint8_t pid) {
+    bench_channel_t channel;
+    
+    if (!run_active) {
+        return;
+    }
+    switch (pid) {
+        case 0x0C: channel = CHANNEL_RPM; break;
+        case 0x11: channel = CHANNEL_THROTTLE; break;
+        case 0x0D: channel = CHANNEL_SPEED; break;
+        default: return;
+    }
+    
+    int64_t sample_us = elm327_sim_last_sample_us();
+    if (sample_us > 0) {
+        histogram_record(&value_age[channel], (uint32_t)(esp_timer_get_time() - sample_us));
+    }
+    sample_count[channel]++;
+}
+
+// Run one variant for STRATEGY_BENCH_RUN_MS and summarize it
+static void run_variant(const strategy_variant_t *v, variant_result_t *result) {
+    char atst_cmd[16];
+    elm327_link_counters_t before, after;
+    uint8_t phase = 0;
+    
+    snprintf(atst_cmd, sizeof(atst_cmd), "AT ST %s", v->atst);
+    elm327_send_command(atst_cmd);
+    vTaskDelay(pdMS_TO_TICKS(STRATEGY_BENCH_SETTLE_MS));
+    elm327_sim_reset_model();
+    
+    for (int c = 0; c < CHANNEL_COUNT; c++) {
+        histogram_init(&value_age[c], STRATEGY_BENCH_AGE_BUCKET_US);
+        sample_count[c] = 0;
+    }
+    elm327_link_get_counters(&elm327_links[ELM327_LINK_PRIMARY], &before);
+    TickType_t start = xTaskGetTickCount();
+    run_active = true;
+    
+    // Same request path as obd_task: elm327_send_command waits for the prompt
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(STRATEGY_BENCH_RUN_MS)) {
+        elm327_send_command(v->commands[phase]);
+        phase = (phase + 1) % v->length;
+        if (v->slot_ms > 0) {
+            vTaskDelay(pdMS_TO_TICKS(v->slot_ms));
+        }
+    }
+    
+    // Let the last reply arrive before closing the window
+    vTaskDelay(pdMS_TO_TICKS(STRATEGY_BENCH_SETTLE_MS));
+    run_active = false;
+    elm327_link_get_counters(&elm327_links[ELM327_LINK_PRIMARY], &after);
+    uint32_t elapsed_ms = pdTICKS_TO_MS(xTaskGetTickCount() - start);
+    
+    uint32_t total_samples = 0;
+    LOG_INFO(TAG, "Variant '%s' (slot %lu ms, ATST %s):", v->name, v->slot_ms, v->atst);
+    histogram_log_header(TAG, "us");
+    for (int c = 0; c < CHANNEL_COUNT; c++) {
+        histogram_log_row(TAG, channel_names[c], &value_age[c]);
+        result->samples_x10[c] = sample_count[c] * 10000 / elapsed_ms;
+        result->age_p50_ms[c] = histogram_percentile(&value_age[c], 50) / 1000;
+        result->age_p99_ms[c] = histogram_percentile(&value_age[c], 99) / 1000;
+        total_samples += sample_count[c];
+    }
+    result->bytes_per_s = (after.tx_bytes - before.tx_bytes + after.rx_bytes - before.rx_bytes) * 1000 / elapsed_ms;
+    result->cycles_per_sample = total_samples > 0 ?
+        (uint32_t)((after.rx_cycles - before.rx_cycles) / total_samples) : 0;
+}
+
+// Final comparison table: samples/s and value age p50/p99 per channel
+static void log_summary(void) {
+    LOG_INFO(TAG, "Strategy comparison (sim latency %d+%d ms, %d ms runs)",
+             ELM327_SIM_LATENCY_MS, ELM327_SIM_JITTER_MS, STRATEGY_BENCH_RUN_MS);
+    LOG_INFO(TAG, "%-24s | %-17s | %-17s | %-17s | %6s | %8s",
+             "variant", "rpm /s p50 p99", "thr /s p50 p99", "spd /s p50 p99", "B/s", "cyc/smp");
+    for (size_t i = 0; i < VARIANT_COUNT; i++) {
+        const variant_result_t *r = &results[i];
+        LOG_INFO(TAG, "%-24s | %3lu.%lu %5lu %5lu | %3lu.%lu %5lu %5lu | %3lu.%lu %5lu %5lu | %6lu | %8lu",
+                 variants[i].name,
+                 r->samples_x10[CHANNEL_RPM] / 10, r->samples_x10[CHANNEL_RPM] % 10,
+                 r->age_p50_ms[CHANNEL_RPM], r->age_p99_ms[CHANNEL_RPM],
+                 r->samples_x10[CHANNEL_THROTTLE] / 10, r->samples_x10[CHANNEL_THROTTLE] % 10,
+                 r->age_p50_ms[CHANNEL_THROTTLE], r->age_p99_ms[CHANNEL_THROTTLE],
+                 r->samples_x10[CHANNEL_SPEED] / 10, r->samples_x10[CHANNEL_SPEED] % 10,
+                 r->age_p50_ms[CHANNEL_SPEED], r->age_p99_ms[CHANNEL_SPEED],
+                 r->bytes_per_s, r->cycles_per_sample);
+    }
+}
+
+// Harness task: replaces obd_task, runs every variant against the same simulated adapter
+void strategy_bench_task(void *pv) {
+    while (connection_semaphore == NULL ||
+           xSemaphoreTake(connection_semaphore, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    
+    LOG_INFO(TAG, "Comparing %d acquisition strategies...", (int)VARIANT_COUNT);
+    for (size_t i = 0; i < VARIANT_COUNT; i++) {
+        run_variant(&variants[i], &results[i]);
+    }
+    log_summary();
+    
+    // Restore the production timeout
+    elm327_send_command("AT ST " ELM327_ATST_VALUE);
+    vTaskDelete(NULL);
+}
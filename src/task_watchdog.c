@@ -0,0 +1,228 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_task_wdt.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+#include "logging_config.h"
+#include "task_watchdog.h"
+#include "histogram.h"
+
+static const char *TAG = "WATCHDOG";
+
+// Watch state per task
+typedef struct {
+    const char *name;
+    uint32_t slack_ms;
+    bool section;                       // Deadline only between enter and leave
+    esp_task_wdt_user_handle_t twdt_user;
+    TaskHandle_t task;                  // Last task seen beating (for FreeRTOS state)
+    bool active;                        // Deadline armed
+    bool stalled;                       // Stall reported, waiting for the next beat
+    const char *state;                  // Last-known state
+    int32_t detail;                     // Event number for callback sections
+    int64_t last_beat_us;
+    uint32_t deadline_ms;
+    uint32_t stalls;
+    uint32_t longest_stall_ms;
+    histogram_t usage;                  // Beat gap / deadline in percent
+} watch_t;
+
+static portMUX_TYPE watch_lock = portMUX_INITIALIZER_UNLOCKED;
+static watch_t watches[WDT_TASK_COUNT] = {
+    [WDT_TASK_OBD]           = { .name = "obd_task",      .slack_ms = TASK_WATCHDOG_SLACK_OBD_MS },
+    [WDT_TASK_OBD_SECONDARY] = { .name = "obd_secondary", .slack_ms = TASK_WATCHDOG_SLACK_OBD_MS },
+    [WDT_TASK_ANALOG]        = { .name = "analog_input",  .slack_ms = TASK_WATCHDOG_SLACK_ANALOG_MS },
+    [WDT_TASK_FREEZE]        = { .name = "freeze_frame",  .slack_ms = TASK_WATCHDOG_SLACK_FREEZE_MS },
+    [WDT_TASK_LED]           = { .name = "led_search",    .slack_ms = TASK_WATCHDOG_SLACK_LED_MS },
+    [WDT_TASK_BLE_STREAM]    = { .name = "ble_stream",    .slack_ms = TASK_WATCHDOG_SLACK_STREAM_MS },
+    [WDT_TASK_DASHBOARD]     = { .name = "dashboard",     .slack_ms = TASK_WATCHDOG_SLACK_STREAM_MS },
+    [WDT_TASK_CONSOLE]       = { .name = "tuner_console", .slack_ms = TASK_WATCHDOG_SLACK_CONSOLE_MS },
+    [WDT_TASK_ELM327_INIT]   = { .name = "elm327_init",   .slack_ms = TASK_WATCHDOG_SLACK_INIT_MS },
+    [WDT_TASK_ELM327_INIT_SECONDARY] = { .name = "elm327_init_2", .slack_ms = TASK_WATCHDOG_SLACK_INIT_MS },
+    [WDT_TASK_BTC]           = { .name = "bt_callbacks",  .slack_ms = TASK_WATCHDOG_SECTION_BTC_MS, .section = true },
+};
+static bool running = false;
+
+static const char *task_state_names[] = { "running", "ready", "blocked", "suspended", "deleted", "invalid" };
+
+// Register every watched task as a TWDT user
+void task_watchdog_init(void) {
+    for (int i = 0; i < WDT_TASK_COUNT; i++) {
+        histogram_init(&watches[i].usage, TASK_WATCHDOG_USAGE_BUCKET_PCT);
+        esp_err_t ret = esp_task_wdt_add_user(watches[i].name, &watches[i].twdt_user);
+        if (ret != ESP_OK) {
+            LOG_ERROR(TAG, "TWDT user %s failed: %s", watches[i].name, esp_err_to_name(ret));
+            watches[i].twdt_user = NULL;
+        }
+    }
+    running = true;
+    LOG_VERBOSE(TAG, "Task watchdog initialized (%d tasks)", WDT_TASK_COUNT);
+}
+
+// Close the current beat interval: usage sample, and recovery from a reported stall
+static void close_interval(watch_t *w, int64_t now_us, uint32_t *stall_ms) {
+    uint32_t gap_ms = (uint32_t)((now_us - w->last_beat_us) / 1000);
+    histogram_record(&w->usage, w->deadline_ms > 0 ? gap_ms * 100 / w->deadline_ms : 0);
+    if (w->stalled) {
+        w->stalled = false;
+        *stall_ms = gap_ms;
+        if (gap_ms > w->longest_stall_ms) {
+            w->longest_stall_ms = gap_ms;
+        }
+    }
+}
+
+static void log_recovery(const watch_t *w, uint32_t stall_ms) {
+    if (stall_ms > 0) {
+        LOG_WARN(TAG, "%s recovered after %lu ms (deadline %lu ms)", w->name, stall_ms, w->deadline_ms);
+    }
+}
+
+void task_watchdog_beat(task_watchdog_id_t id, const char *state, uint32_t expect_ms) {
+    if (!running) {
+        return;
+    }
+    watch_t *w = &watches[id];
+    int64_t now_us = esp_timer_get_time();
+    uint32_t stall_ms = 0;
+
+    portENTER_CRITICAL(&watch_lock);
+    if (w->active) {
+        close_interval(w, now_us, &stall_ms);
+    }
+    w->task = xTaskGetCurrentTaskHandle();
+    w->state = state;
+    w->last_beat_us = now_us;
+    w->deadline_ms = expect_ms + w->slack_ms;
+    w->active = true;
+    portEXIT_CRITICAL(&watch_lock);
+
+    log_recovery(w, stall_ms);
+}
+
+// Callback entry (Bluetooth task context: no logging here)
+void task_watchdog_enter(task_watchdog_id_t id, const char *state, int32_t detail) {
+    if (!running) {
+        return;
+    }
+    watch_t *w = &watches[id];
+
+    portENTER_CRITICAL(&watch_lock);
+    w->task = xTaskGetCurrentTaskHandle();
+    w->state = state;
+    w->detail = detail;
+    w->last_beat_us = esp_timer_get_time();
+    w->deadline_ms = w->slack_ms;
+    w->active = true;
+    portEXIT_CRITICAL(&watch_lock);
+}
+
+void task_watchdog_leave(task_watchdog_id_t id) {
+    if (!running) {
+        return;
+    }
+    watch_t *w = &watches[id];
+    uint32_t stall_ms = 0;
+
+    portENTER_CRITICAL(&watch_lock);
+    if (w->active) {
+        close_interval(w, esp_timer_get_time(), &stall_ms);
+        w->active = false;
+    }
+    portEXIT_CRITICAL(&watch_lock);
+
+    log_recovery(w, stall_ms);
+}
+
+// Report a missed deadline with what the task was last doing
+static void report_stall(const watch_t *w, uint32_t late_ms) {
+    eTaskState task_state = w->task ? eTaskGetState(w->task) : eInvalid;
+    UBaseType_t stack_free = w->task ? uxTaskGetStackHighWaterMark(w->task) : 0;
+
+    if (w->section) {
+        LOG_ERROR(TAG, "STALL %s: in %s (event %ld) for %lu ms, deadline %lu ms, task %s, stack free %u",
+                  w->name, w->state, w->detail, late_ms, w->deadline_ms,
+                  task_state_names[task_state], stack_free);
+    } else {
+        LOG_ERROR(TAG, "STALL %s: no beat for %lu ms, deadline %lu ms, last state '%s', task %s, stack free %u",
+                  w->name, late_ms, w->deadline_ms, w->state ? w->state : "-",
+                  task_state_names[task_state], stack_free);
+    }
+}
+
+// Monitor: feeds each TWDT user while its task keeps its deadline
+void task_watchdog_task(void *pv) {
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t last_report = last_wake;
+
+    esp_task_wdt_add(NULL);  // The monitor itself must not hang either
+    LOG_INFO(TAG, "Task watchdog monitor started (%d tasks, %d ms resolution)",
+             WDT_TASK_COUNT, TASK_WATCHDOG_CHECK_MS);
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TASK_WATCHDOG_CHECK_MS));
+        esp_task_wdt_reset();
+
+        int64_t now_us = esp_timer_get_time();
+        for (int i = 0; i < WDT_TASK_COUNT; i++) {
+            watch_t *w = &watches[i];
+            bool newly_stalled = false;
+            bool healthy;
+            uint32_t elapsed_ms = 0;
+
+            portENTER_CRITICAL(&watch_lock);
+            if (w->active) {
+                elapsed_ms = (uint32_t)((now_us - w->last_beat_us) / 1000);
+                healthy = elapsed_ms <= w->deadline_ms;
+                if (!healthy && !w->stalled) {
+                    w->stalled = true;
+                    w->stalls++;
+                    newly_stalled = true;
+                }
+            } else {
+                healthy = true;  // Not started yet, or outside a callback section
+            }
+            portEXIT_CRITICAL(&watch_lock);
+
+            // A stalled task stops feeding its TWDT user: the TWDT reports it by name
+            if (healthy && w->twdt_user) {
+                esp_task_wdt_reset_user(w->twdt_user);
+            }
+            if (newly_stalled) {
+                report_stall(w, elapsed_ms);
+            }
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if ((now - last_report) >= pdMS_TO_TICKS(TASK_WATCHDOG_REPORT_INTERVAL_MS)) {
+            task_watchdog_log_report();
+            last_report = now;
+        }
+    }
+}
+
+// Deadline usage per task: p99 near 100% means the deadline is about to be missed
+void task_watchdog_log_report(void) {
+    static histogram_t snapshot;
+    uint32_t stalls, longest;
+
+    LOG_INFO(TAG, "Deadline usage per task (%% of deadline):");
+    histogram_log_header(TAG, "%");
+    for (int i = 0; i < WDT_TASK_COUNT; i++) {
+        portENTER_CRITICAL(&watch_lock);
+        memcpy(&snapshot, &watches[i].usage, sizeof(snapshot));
+        stalls = watches[i].stalls;
+        longest = watches[i].longest_stall_ms;
+        portEXIT_CRITICAL(&watch_lock);
+
+        if (snapshot.count == 0) {
+            continue;
+        }
+        histogram_log_row(TAG, watches[i].name, &snapshot);
+        if (stalls > 0) {
+            LOG_WARN(TAG, "  %s: %lu stalls, longest %lu ms", watches[i].name, stalls, longest);
+        }
+    }
+}
@@ -0,0 +1,186 @@
+#include "esp_log.h"
+#include <string.h>
+
+#include "logging_config.h"
+#include "vehicle_model.h"
+
+static const char *TAG = "VEHICLE_MODEL";
+
+#define STEP_S          (VEHICLE_MODEL_STEP_US / 1000000.0f)
+#define KMH_PER_MS      3.6f
+
+// Gear ratios x100, index 1..VEHICLE_GEAR_COUNT
+static const uint16_t gear_ratio_x100[VEHICLE_GEAR_COUNT + 1] = { 0, 336, 207, 143, 100, 84 };
+
+static vehicle_model_state_t state;
+static uint32_t phase_elapsed_ms = 0;
+static bool fuel_cut = false;
+static uint32_t watch_rpm = 0;
+static int64_t last_crossing_us = 0;
+
+// Engine RPM locked to the wheels in the given gear
+static float wheel_rpm(float speed_kmh, uint8_t gear) {
+    float wheel_rps = (speed_kmh / KMH_PER_MS) / (VEHICLE_TIRE_CIRCUMFERENCE_MM / 1000.0f);
+    return wheel_rps * 60.0f * (gear_ratio_x100[gear] / 100.0f) * (VEHICLE_FINAL_DRIVE_X100 / 100.0f);
+}
+
+// First-order approach of value towards target
+static float approach(float value, float target, uint32_t tau_ms) {
+    return value + (target - value) * (VEHICLE_MODEL_STEP_US / 1000.0f) / (float)(tau_ms + VEHICLE_MODEL_STEP_US / 1000);
+}
+
+static void enter_phase(vehicle_phase_t phase) {
+    state.phase = phase;
+    phase_elapsed_ms = 0;
+}
+
+// Driver pedal demand for the current phase (0-100 %)
+static float driver_pedal(void) {
+    switch (state.phase) {
+        case VEHICLE_PHASE_STAGE:
+            // Simple two-step: pedal down, feathered around the staging RPM
+            return state.rpm < VEHICLE_STAGE_RPM ? 80.0f : 15.0f;
+        case VEHICLE_PHASE_LAUNCH:
+            return 100.0f;
+        default:
+            return 0.0f;
+    }
+}
+
+// Driver decisions: phase changes and shift points
+static void driver_update(void) {
+    switch (state.phase) {
+        case VEHICLE_PHASE_IDLE:
+            if (phase_elapsed_ms >= VEHICLE_IDLE_TIME_MS) {
+                enter_phase(VEHICLE_PHASE_STAGE);
+            }
+            break;
+        case VEHICLE_PHASE_STAGE:
+            if (phase_elapsed_ms >= VEHICLE_STAGE_TIME_MS) {
+                state.gear = 1;
+                enter_phase(VEHICLE_PHASE_LAUNCH);
+            }
+            break;
+        case VEHICLE_PHASE_LAUNCH:
+            if (state.speed_kmh >= VEHICLE_PULL_END_KMH) {
+                enter_phase(VEHICLE_PHASE_COAST);
+            } else if (state.rpm >= VEHICLE_SHIFT_RPM && state.gear < VEHICLE_GEAR_COUNT) {
+                enter_phase(VEHICLE_PHASE_SHIFT);
+            }
+            break;
+        case VEHICLE_PHASE_SHIFT:
+            if (phase_elapsed_ms >= VEHICLE_SHIFT_TIME_MS) {
+                state.gear++;
+                enter_phase(VEHICLE_PHASE_LAUNCH);
+            }
+            break;
+        case VEHICLE_PHASE_COAST:
+            if (phase_elapsed_ms >= VEHICLE_COAST_TIME_MS) {
+                enter_phase(VEHICLE_PHASE_BRAKE);
+            }
+            break;
+        case VEHICLE_PHASE_BRAKE:
+            if (state.speed_kmh <= 0.0f) {
+                state.speed_kmh = 0.0f;
+                state.gear = 0;
+                enter_phase(VEHICLE_PHASE_IDLE);
+            }
+            break;
+    }
+}
+
+// One fixed integration step
+static void model_step(void) {
+    float prev_rpm = state.rpm;
+    
+    driver_update();
+    
+    // Throttle body follows the pedal at a limited slew rate
+    float pedal = driver_pedal();
+    float max_delta = VEHICLE_THROTTLE_RATE_PCT_S * STEP_S;
+    float delta = pedal - state.throttle_pct;
+    if (delta > max_delta) delta = max_delta;
+    if (delta < -max_delta) delta = -max_delta;
+    state.throttle_pct += delta;
+    
+    // Rev limiter with hysteresis
+    if (state.rpm >= VEHICLE_REV_LIMIT_RPM) {
+        fuel_cut = true;
+    } else if (state.rpm < VEHICLE_REV_LIMIT_RESUME_RPM) {
+        fuel_cut = false;
+    }
+    float drive = fuel_cut ? 0.0f : state.throttle_pct / 100.0f;
+    
+    // Vehicle longitudinal dynamics
+    float v = state.speed_kmh / KMH_PER_MS;
+    float accel = -VEHICLE_DRAG_COEFF * v * v;
+    bool clutch_in = state.gear == 0 || state.phase == VEHICLE_PHASE_SHIFT;
+    if (!clutch_in) {
+        // Tractive force scales with overall ratio relative to first gear
+        accel += drive * VEHICLE_MAX_ACCEL_MS2 * gear_ratio_x100[state.gear] / gear_ratio_x100[1];
+    }
+    if (state.phase == VEHICLE_PHASE_BRAKE) {
+        accel -= VEHICLE_BRAKE_DECEL_MS2;
+    }
+    v += accel * STEP_S;
+    state.speed_kmh = v > 0.0f ? v * KMH_PER_MS : 0.0f;
+    
+    // Engine speed: free-revving with the clutch in, locked (after slip) in gear
+    float free_target = VEHICLE_IDLE_RPM + drive * (VEHICLE_REV_LIMIT_RPM + 200 - VEHICLE_IDLE_RPM);
+    if (clutch_in) {
+        float target = free_target;
+        if (state.phase == VEHICLE_PHASE_SHIFT) {
+            target = VEHICLE_IDLE_RPM;  // Lifted: engine falls towards the next gear
+        }
+        state.rpm = approach(state.rpm, target, VEHICLE_FREE_REV_TAU_MS);
+    } else {
+        float locked = wheel_rpm(state.speed_kmh, state.gear);
+        if (locked < VEHICLE_IDLE_RPM) {
+            locked = VEHICLE_IDLE_RPM;
+        }
+        if (state.gear == 1 && phase_elapsed_ms < VEHICLE_CLUTCH_SLIP_MS && state.phase == VEHICLE_PHASE_LAUNCH) {
+            // Launch clutch slip: blend from the staged RPM to the wheel-locked RPM
+            float k = (float)phase_elapsed_ms / VEHICLE_CLUTCH_SLIP_MS;
+            state.rpm = VEHICLE_STAGE_RPM * (1.0f - k) + locked * k;
+        } else {
+            state.rpm = locked;
+        }
+    }
+    
+    state.time_us += VEHICLE_MODEL_STEP_US;
+    phase_elapsed_ms += VEHICLE_MODEL_STEP_US / 1000;
+    
+    // Ground truth crossing, interpolated within the step
+    if (watch_rpm > 0 && prev_rpm < watch_rpm && state.rpm >= watch_rpm) {
+        float frac = (watch_rpm - prev_rpm) / (state.rpm - prev_rpm);
+        last_crossing_us = state.time_us - VEHICLE_MODEL_STEP_US + (int64_t)(frac * VEHICLE_MODEL_STEP_US);
+    }
+}
+
+// Initialize the model at idle, clock starting at start_us
+void vehicle_model_init(int64_t start_us, uint32_t rpm_to_watch) {
+    memset(&state, 0, sizeof(state));
+    state.time_us = start_us;
+    state.rpm = VEHICLE_IDLE_RPM;
+    state.phase = VEHICLE_PHASE_IDLE;
+    phase_elapsed_ms = 0;
+    fuel_cut = false;
+    watch_rpm = rpm_to_watch;
+    last_crossing_us = 0;
+    LOG_VERBOSE(TAG, "Vehicle model initialized (watch %lu RPM)", watch_rpm);
+}
+
+// Integrate in fixed steps up to time_us (state is exact at step boundaries)
+void vehicle_model_advance_to(int64_t time_us) {
+    while (state.time_us + VEHICLE_MODEL_STEP_US <= time_us) {
+        model_step();
+    }
+}
+
+const vehicle_model_state_t *vehicle_model_state(void) {
+    return &state;
+}
+
+int64_t vehicle_model_last_crossing_us(void) {
+    return last_crossing_us;
+}
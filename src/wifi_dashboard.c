@@ -0,0 +1,381 @@
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "esp_event.h"
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "logging_config.h"
+#include "wifi_dashboard.h"
+#include "histogram.h"
+#include "obd_data.h"
+#include "launch_control.h"
+#include "power_manager.h"
+#include "task_watchdog.h"
+
+#if WIFI_DASHBOARD_ENABLED && !CONFIG_HTTPD_WS_SUPPORT
+#error "WIFI_DASHBOARD_ENABLED needs CONFIG_HTTPD_WS_SUPPORT=y"
+#endif
+
+static const char *TAG = "DASHBOARD";
+
+// 128 x 5 ms = 640 ms: round trips stretched by Wi-Fi airtime (up to the
+// 200 ms adapter timeout and beyond) still land below the overflow bucket
+#define RTT_BUCKET_US   5000
+
+// SPP round trips split by what the Wi-Fi side was doing at the time
+typedef enum {
+    COEX_WIFI_IDLE = 0,     // AP up, no station
+    COEX_WIFI_ASSOCIATED,   // Station joined, no WebSocket
+    COEX_WIFI_STREAMING,    // Frames flowing
+    COEX_STATE_COUNT
+} coex_state_t;
+
+static const char *coex_names[] = { "SPP RTT, Wi-Fi idle", "SPP RTT, Wi-Fi associated", "SPP RTT, Wi-Fi streaming" };
+
+// One WebSocket session
+typedef struct {
+    int fd;                             // -1 = free
+    bool need_key;
+    uint8_t inflight;                   // Frames queued on the server task
+    int32_t last[DASH_CH_COUNT];        // Values in the client's last queued frame
+    uint32_t sent;
+    uint32_t dropped;
+} dash_client_t;
+
+static portMUX_TYPE client_lock = portMUX_INITIALIZER_UNLOCKED;
+static dash_client_t clients[WIFI_DASHBOARD_MAX_CLIENTS];
+static httpd_handle_t server = NULL;
+static volatile uint8_t stations = 0;
+static volatile uint8_t ws_clients = 0;
+
+// Coexistence histograms
+static portMUX_TYPE coex_lock = portMUX_INITIALIZER_UNLOCKED;
+static histogram_t spp_rtt[COEX_STATE_COUNT];
+
+// Static dashboard: opens the WebSocket and applies key/delta frames
+static const char dashboard_html[] =
+    "<!DOCTYPE html><html><head><meta name=viewport content='width=device-width'>"
+    "<title>RPM Trigger</title><style>body{font-family:sans-serif;background:#111;color:#eee}"
+    "td{padding:4px 12px;font-size:1.4em}td+td{text-align:right;font-weight:bold}</style></head>"
+    "<body><table id=t></table><p id=s>connecting</p><script>"
+    "var n=['RPM','Throttle %','Speed km/h','Timing deg','Coolant C','Bottle psi','AFR x10','Interlock','Launch','Battery mV'];"
+    "var t=document.getElementById('t'),s=document.getElementById('s'),c=[];"
+    "n.forEach(function(l){var r=t.insertRow();r.insertCell().textContent=l;c.push(r.insertCell());});"
+    "function go(){var w=new WebSocket('ws://'+location.host+'/ws');w.binaryType='arraybuffer';"
+    "w.onopen=function(){s.textContent='live';};"
+    "w.onclose=function(){s.textContent='reconnecting';setTimeout(go,1000);};"
+    "w.onmessage=function(e){var d=new DataView(e.data),k=d.getUint8(1);"
+    "s.textContent='frame '+d.getUint16(2,true);"
+    "for(var i=0;i<k;i++){var o=4+i*5;c[d.getUint8(o)].textContent=d.getInt32(o+1,true);}};}"
+    "go();</script></body></html>";
+
+static esp_err_t index_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_send(req, dashboard_html, sizeof(dashboard_html) - 1);
+}
+
+// WebSocket endpoint: handshake registers the session, incoming frames are ignored
+static esp_err_t ws_handler(httpd_req_t *req) {
+    if (req->method == HTTP_GET) {
+        int fd = httpd_req_to_sockfd(req);
+        bool added = false;
+
+        portENTER_CRITICAL(&client_lock);
+        for (int i = 0; i < WIFI_DASHBOARD_MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0) {
+                memset(&clients[i], 0, sizeof(clients[i]));
+                clients[i].fd = fd;
+                clients[i].need_key = true;
+                ws_clients++;
+                added = true;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&client_lock);
+
+        if (!added) {
+            LOG_WARN(TAG, "WebSocket rejected: %d sessions open", WIFI_DASHBOARD_MAX_CLIENTS);
+            return ESP_FAIL;
+        }
+        LOG_INFO(TAG, "WebSocket client connected (fd %d)", fd);
+        return ESP_OK;
+    }
+
+    // Drain the frame so the server can parse the next one
+    httpd_ws_frame_t frame = {0};
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK || frame.len == 0) {
+        return ret;
+    }
+    uint8_t scratch[32];
+    frame.payload = scratch;
+    return httpd_ws_recv_frame(req, &frame, frame.len < sizeof(scratch) ? frame.len : sizeof(scratch));
+}
+
+static void release_client(int fd) {
+    portENTER_CRITICAL(&client_lock);
+    for (int i = 0; i < WIFI_DASHBOARD_MAX_CLIENTS; i++) {
+        if (clients[i].fd == fd) {
+            clients[i].fd = -1;
+            ws_clients--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&client_lock);
+}
+
+// Socket closed by the server (client gone, error or LRU purge)
+static void on_socket_close(httpd_handle_t hd, int fd) {
+    release_client(fd);
+    close(fd);
+}
+
+// Frame left the server task (sent or failed)
+static void on_send_done(esp_err_t err, int fd, void *arg) {
+    free(arg);
+    portENTER_CRITICAL(&client_lock);
+    for (int i = 0; i < WIFI_DASHBOARD_MAX_CLIENTS; i++) {
+        if (clients[i].fd == fd && clients[i].inflight > 0) {
+            clients[i].inflight--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&client_lock);
+}
+
+static void wifi_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data) {
+    if (id == WIFI_EVENT_AP_STACONNECTED) {
+        stations++;
+        LOG_INFO(TAG, "Station joined (%d connected)", stations);
+    } else if (id == WIFI_EVENT_AP_STADISCONNECTED && stations > 0) {
+        stations--;
+        LOG_INFO(TAG, "Station left (%d connected)", stations);
+    }
+}
+
+static esp_err_t start_soft_ap(void) {
+    esp_err_t ret = esp_netif_init();
+    if (ret == ESP_OK) {
+        ret = esp_event_loop_create_default();
+    }
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+    esp_netif_create_default_wifi_ap();
+
+    wifi_init_config_t init_cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ret = esp_wifi_init(&init_cfg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_event_handler, NULL);
+
+    wifi_config_t ap_cfg = {0};
+    strncpy((char *)ap_cfg.ap.ssid, WIFI_DASHBOARD_SSID, sizeof(ap_cfg.ap.ssid));
+    ap_cfg.ap.ssid_len = strlen(WIFI_DASHBOARD_SSID);
+    strncpy((char *)ap_cfg.ap.password, WIFI_DASHBOARD_PASSWORD, sizeof(ap_cfg.ap.password));
+    ap_cfg.ap.channel = WIFI_DASHBOARD_CHANNEL;
+    ap_cfg.ap.max_connection = WIFI_DASHBOARD_MAX_STATIONS;
+    ap_cfg.ap.authmode = WIFI_AUTH_WPA2_PSK;
+
+    ret = esp_wifi_set_mode(WIFI_MODE_AP);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_set_config(WIFI_IF_AP, &ap_cfg);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_wifi_start();
+    }
+    return ret;
+}
+
+// Bring up the soft-AP and HTTP server
+void wifi_dashboard_init(void) {
+    for (int i = 0; i < WIFI_DASHBOARD_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+    }
+    for (int i = 0; i < COEX_STATE_COUNT; i++) {
+        histogram_init(&spp_rtt[i], RTT_BUCKET_US);
+    }
+
+    esp_err_t ret = start_soft_ap();
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "Soft-AP start failed: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_open_sockets = WIFI_DASHBOARD_MAX_CLIENTS + 2;  // Page loads next to the sockets
+    config.lru_purge_enable = true;
+    config.close_fn = on_socket_close;
+
+    ret = httpd_start(&server, &config);
+    if (ret != ESP_OK) {
+        LOG_ERROR(TAG, "HTTP server start failed: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    static const httpd_uri_t index_uri = { .uri = "/", .method = HTTP_GET, .handler = index_handler };
+    static const httpd_uri_t ws_uri = { .uri = "/ws", .method = HTTP_GET, .handler = ws_handler, .is_websocket = true };
+    httpd_register_uri_handler(server, &index_uri);
+    httpd_register_uri_handler(server, &ws_uri);
+
+    LOG_INFO(TAG, "Dashboard on AP \"%s\" (http://192.168.4.1/)", WIFI_DASHBOARD_SSID);
+}
+
+// Record one SPP round trip under the current Wi-Fi activity
+void wifi_dashboard_on_spp_rtt(uint32_t rtt_us) {
+    coex_state_t state = ws_clients > 0 ? COEX_WIFI_STREAMING :
+                         stations > 0 ? COEX_WIFI_ASSOCIATED : COEX_WIFI_IDLE;
+    portENTER_CRITICAL(&coex_lock);
+    histogram_record(&spp_rtt[state], rtt_us);
+    portEXIT_CRITICAL(&coex_lock);
+}
+
+static void snapshot_channels(int32_t *values) {
+    values[DASH_CH_RPM] = (int32_t)vehicle_data.rpm;
+    values[DASH_CH_THROTTLE] = vehicle_data.throttle_position;
+    values[DASH_CH_SPEED] = vehicle_data.vehicle_speed;
+    values[DASH_CH_TIMING] = vehicle_data.timing_advance;
+    values[DASH_CH_COOLANT] = vehicle_data.coolant_temp;
+    values[DASH_CH_BOTTLE_PSI] = vehicle_data.bottle_pressure_psi;
+    values[DASH_CH_AFR_X10] = vehicle_data.afr_x10;
+    values[DASH_CH_INTERLOCK] = vehicle_data.analog_interlock_ok ? 1 : 0;
+    values[DASH_CH_LAUNCH_STATE] = (int32_t)launch_control_get_state();
+    values[DASH_CH_BATTERY_MV] = (int32_t)power_manager_get_voltage_mv();
+}
+
+// Build and queue one frame for a client; a slow client's frame is dropped
+// and its changes roll into the next delta
+static void push_client(int index, const int32_t *values, uint16_t seq, bool keyframe) {
+    uint8_t frame[sizeof(dash_frame_header_t) + DASH_CH_COUNT * sizeof(dash_frame_entry_t)];
+    dash_frame_header_t *header = (dash_frame_header_t *)frame;
+    dash_frame_entry_t *entries = (dash_frame_entry_t *)(frame + sizeof(dash_frame_header_t));
+    dash_client_t *client = &clients[index];
+    uint8_t count = 0;
+    int fd;
+
+    portENTER_CRITICAL(&client_lock);
+    fd = client->fd;
+    if (fd < 0) {
+        portEXIT_CRITICAL(&client_lock);
+        return;
+    }
+    if (client->inflight >= WIFI_DASHBOARD_MAX_INFLIGHT) {
+        client->dropped++;
+        portEXIT_CRITICAL(&client_lock);
+        return;
+    }
+    bool key = keyframe || client->need_key;
+    for (int ch = 0; ch < DASH_CH_COUNT; ch++) {
+        if (key || values[ch] != client->last[ch]) {
+            entries[count].channel = ch;
+            entries[count].value = values[ch];
+            client->last[ch] = values[ch];
+            count++;
+        }
+    }
+    if (count == 0) {
+        portEXIT_CRITICAL(&client_lock);
+        return;
+    }
+    client->need_key = false;
+    client->inflight++;
+    client->sent++;
+    portEXIT_CRITICAL(&client_lock);
+
+    header->type = key ? DASH_FRAME_KEY : DASH_FRAME_DELTA;
+    header->count = count;
+    header->seq = seq;
+
+    // Payload must outlive the call: freed in on_send_done
+    size_t len = sizeof(dash_frame_header_t) + count * sizeof(dash_frame_entry_t);
+    uint8_t *payload = malloc(len);
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (payload != NULL) {
+        memcpy(payload, frame, len);
+        httpd_ws_frame_t ws_frame = {
+            .final = true,
+            .type = HTTPD_WS_TYPE_BINARY,
+            .payload = payload,
+            .len = len,
+        };
+        ret = httpd_ws_send_data_async(server, fd, &ws_frame, on_send_done, payload);
+    }
+    if (ret != ESP_OK) {
+        free(payload);
+        portENTER_CRITICAL(&client_lock);
+        if (client->fd == fd) {
+            client->inflight--;
+            client->need_key = true;  // Client state unknown: resync
+        }
+        portEXIT_CRITICAL(&client_lock);
+    }
+}
+
+// Push delta frames at a fixed rate
+void wifi_dashboard_task(void *pv) {
+    int32_t values[DASH_CH_COUNT];
+    uint16_t seq = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t last_report = last_wake;
+
+    LOG_INFO(TAG, "Dashboard push task started (every %d ms)", WIFI_DASHBOARD_PUSH_INTERVAL_MS);
+
+    while (1) {
+        task_watchdog_beat(WDT_TASK_DASHBOARD, "push_wait", WIFI_DASHBOARD_PUSH_INTERVAL_MS);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(WIFI_DASHBOARD_PUSH_INTERVAL_MS));
+
+        if (server != NULL && ws_clients > 0) {
+            bool keyframe = (seq % WIFI_DASHBOARD_KEYFRAME_EVERY) == 0;
+            snapshot_channels(values);
+            for (int i = 0; i < WIFI_DASHBOARD_MAX_CLIENTS; i++) {
+                push_client(i, values, seq, keyframe);
+            }
+            seq++;
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if ((now - last_report) >= pdMS_TO_TICKS(WIFI_DASHBOARD_REPORT_INTERVAL_MS)) {
+            wifi_dashboard_log_report();
+            last_report = now;
+        }
+    }
+}
+
+// Per-client delivery and SPP RTT per Wi-Fi activity
+void wifi_dashboard_log_report(void) {
+    static histogram_t snapshot[COEX_STATE_COUNT];
+    dash_client_t client_snapshot[WIFI_DASHBOARD_MAX_CLIENTS];
+
+    portENTER_CRITICAL(&coex_lock);
+    memcpy(snapshot, spp_rtt, sizeof(snapshot));
+    portEXIT_CRITICAL(&coex_lock);
+    portENTER_CRITICAL(&client_lock);
+    memcpy(client_snapshot, clients, sizeof(client_snapshot));
+    portEXIT_CRITICAL(&client_lock);
+
+    LOG_INFO(TAG, "Stations: %d, WebSocket clients: %d", stations, ws_clients);
+    for (int i = 0; i < WIFI_DASHBOARD_MAX_CLIENTS; i++) {
+        if (client_snapshot[i].fd >= 0) {
+            LOG_INFO(TAG, "  fd %d: %lu frames sent, %lu dropped (slow client)",
+                     client_snapshot[i].fd, client_snapshot[i].sent, client_snapshot[i].dropped);
+        }
+    }
+
+    histogram_log_header(TAG, "us");
+    for (int i = 0; i < COEX_STATE_COUNT; i++) {
+        if (snapshot[i].count > 0) {
+            histogram_log_row(TAG, coex_names[i], &snapshot[i]);
+        }
+    }
+
+    // Median shift of the SPP round trip caused by Wi-Fi traffic
+    histogram_log_shift(TAG, "SPP RTT, Wi-Fi streaming vs idle", &snapshot[COEX_WIFI_IDLE],
+                        &snapshot[COEX_WIFI_STREAMING], "us");
+}
@@ -0,0 +1,333 @@
+// Receive/parse hot-path microbenchmarks with a checked-in regression gate.
+//
+//   hotpath_bench <baseline file> [results file]    compare, fail on regression
+//   hotpath_bench --record <baseline file>          rewrite the baselines
+//
+// Each benchmark calls one entry point BENCH_BATCH times per timed batch, on
+// the firmware build without the simulator, and keeps the best batch of
+// BENCH_BATCHES. Firmware state (link, vehicle data, launch control,
+// freeze-frame ring, stream filters) is reset before every batch, outside
+// the timed region. RPM stays below LAUNCH_RPM_LIMIT, so the output never fires.
+// A benchmark over its tolerance is measured again, up to BENCH_ATTEMPTS times.
+//
+// Host timings vary between machines, so every result is divided by a fixed
+// calibration loop timed the same way. The gate compares that relative cost
+// with the baseline file: name, relative cost, tolerance (%). A benchmark
+// slower than its tolerance fails the test; one faster than it passes and
+// asks for --record.
+//
+// The results file gets one machine-readable line per benchmark:
+//   BENCH name=<name> ns=<ns/call> relative=<x> baseline=<x> delta_pct=<d> status=pass|fail|new
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host.h"
+#include "elm327.h"
+#include "obd_data.h"
+#include "launch_control.h"
+#include "freeze_frame.h"
+#include "publish_policy.h"
+#include "rolling_stats.h"
+
+#define BENCH_BATCH         200
+#define BENCH_BATCHES       2000
+#define BENCH_ATTEMPTS      3       // Measurements before a regression counts
+#define DEFAULT_TOLERANCE   25      // percent, for benchmarks new to the baseline file
+#define LINE_MAX_LEN        256
+
+// Representative traffic (RPM 2000, throttle 20 %, speed 40 km/h)
+#define BENCH_RX_CHUNK          "41 0C 1F 40 11 33 \r\r>"
+#define BENCH_RX_MULTI_FRAME    "008\r0: 41 0C 1F 40 11 33\r1: 0D 28 55 55 55 55 55\r\r>"
+#define BENCH_RESPONSE          "41 0C 1F 40 11 33"
+#define BENCH_RESPONSE_COMPACT  "410C1F401133"
+
+typedef enum {
+    BENCH_CALIBRATION = 0,
+    BENCH_RX_CHUNK_ID,
+    BENCH_RX_MULTI_FRAME_ID,
+    BENCH_HANDLE_RESPONSE_ID,
+    BENCH_HANDLE_COMPACT_ID,
+    BENCH_PARSE_MULTI_ID,
+    BENCH_COUNT
+} bench_id_t;
+
+typedef struct {
+    const char *name;
+    double ns;              // Best batch, per call
+    double relative;        // ns / calibration ns
+    double baseline;        // 0 = not in the baseline file
+    uint32_t tolerance_pct;
+} bench_result_t;
+
+static bench_result_t results[BENCH_COUNT] = {
+    [BENCH_CALIBRATION]        = { "calibration" },
+    [BENCH_RX_CHUNK_ID]        = { "process_received_data" },
+    [BENCH_RX_MULTI_FRAME_ID]  = { "process_received_data_multi_frame" },
+    [BENCH_HANDLE_RESPONSE_ID] = { "elm327_handle_response" },
+    [BENCH_HANDLE_COMPACT_ID]  = { "elm327_handle_response_compact" },
+    [BENCH_PARSE_MULTI_ID]     = { "parse_multi_pid_line" },
+};
+
+static volatile uint32_t calibration_sink;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Fixed string workload of roughly the hot path's size (scan + hash a line)
+static void calibration_once(void) {
+    static const char line[] = BENCH_RX_MULTI_FRAME;
+    uint32_t hash = 2166136261u;
+    for (int pass = 0; pass < 4; pass++) {
+        for (const char *c = line; *c; c++) {
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+        hash += (uint32_t)strlen(line) + (uint32_t)(strchr(line, '>') - line);
+    }
+    calibration_sink = hash;
+}
+
+static void reset_state(void) {
+    elm327_link_reset(&elm327_links[ELM327_LINK_PRIMARY]);
+    obd_data_init();
+    launch_control_init();
+    freeze_frame_init();
+#if ROLLING_STATS_ENABLED
+    rolling_stats_init();
+#endif
+#if PUBLISH_POLICY_ENABLED
+    publish_policy_init();
+#endif
+}
+
+// One timed batch; returns ns per call
+static double bench_batch(bench_id_t id) {
+    static char lines[BENCH_BATCH][sizeof(BENCH_RESPONSE)];
+
+    reset_state();
+    if (id == BENCH_PARSE_MULTI_ID) {
+        // The parser tokenizes in place, so the copies stay outside the timed region
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            memcpy(lines[i], BENCH_RESPONSE, sizeof(BENCH_RESPONSE));
+        }
+    }
+
+    int64_t start = now_ns();
+    for (int i = 0; i < BENCH_BATCH; i++) {
+        switch (id) {
+            case BENCH_CALIBRATION:
+                calibration_once();
+                break;
+            case BENCH_RX_CHUNK_ID:
+                process_received_data(BENCH_RX_CHUNK, sizeof(BENCH_RX_CHUNK) - 1);
+                break;
+            case BENCH_RX_MULTI_FRAME_ID:
+                process_received_data(BENCH_RX_MULTI_FRAME, sizeof(BENCH_RX_MULTI_FRAME) - 1);
+                break;
+            case BENCH_HANDLE_RESPONSE_ID:
+                elm327_handle_response(BENCH_RESPONSE);
+                break;
+            case BENCH_HANDLE_COMPACT_ID:
+                elm327_handle_response(BENCH_RESPONSE_COMPACT);
+                break;
+            case BENCH_PARSE_MULTI_ID:
+            default:
+                parse_multi_pid_line(lines[i]);
+                break;
+        }
+    }
+    return (double)(now_ns() - start) / BENCH_BATCH;
+}
+
+// Every benchmark batch is paired with a calibration batch run just before it,
+// so both see the same clock speed and machine load; the relative cost is
+// best benchmark batch over best calibration batch
+static void run_benchmark(bench_id_t id) {
+    double best = 0.0;
+    double reference = 0.0;
+
+    for (int i = 0; i < BENCH_BATCHES; i++) {
+        double calibration = bench_batch(BENCH_CALIBRATION);
+        double ns = bench_batch(id);
+        if (i == 0 || calibration < reference) {
+            reference = calibration;
+        }
+        if (i == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    bench_result_t *r = &results[id];
+    if (r->relative == 0.0 || best / reference < r->relative) {
+        r->ns = best;
+        r->relative = best / reference;
+    }
+    if (results[BENCH_CALIBRATION].ns == 0.0 || reference < results[BENCH_CALIBRATION].ns) {
+        results[BENCH_CALIBRATION].ns = reference;
+    }
+    reset_state();
+}
+
+static bool is_regression(const bench_result_t *r) {
+    return r->baseline > 0.0 && (r->relative - r->baseline) * 100.0 / r->baseline > r->tolerance_pct;
+}
+
+static bench_result_t *find_result(const char *name) {
+    for (int b = 1; b < BENCH_COUNT; b++) {
+        if (strcmp(results[b].name, name) == 0) {
+            return &results[b];
+        }
+    }
+    return NULL;
+}
+
+// "<name> <relative cost> <tolerance %>" per line, '#' starts a comment
+static bool load_baselines(const char *path, bool required) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        if (required) {
+            fprintf(stderr, "cannot open baselines %s\n", path);
+        }
+        return false;
+    }
+    char line[LINE_MAX_LEN];
+    int line_no = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        char name[64];
+        double relative;
+        unsigned tolerance;
+        if (sscanf(line, "%63s %lf %u", name, &relative, &tolerance) != 3 || relative <= 0.0) {
+            fprintf(stderr, "%s:%d: malformed baseline\n", path, line_no);
+            ok = false;
+            continue;
+        }
+        bench_result_t *result = find_result(name);
+        if (result == NULL) {
+            fprintf(stderr, "%s:%d: unknown benchmark %s (removed? re-record)\n", path, line_no, name);
+            ok = false;
+            continue;
+        }
+        result->baseline = relative;
+        result->tolerance_pct = tolerance;
+    }
+    fclose(file);
+    return ok;
+}
+
+// Keeps existing tolerances; absolute ns go into comments for reference only
+static bool record_baselines(const char *path) {
+    load_baselines(path, false);
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "cannot write baselines %s\n", path);
+        return false;
+    }
+    fprintf(file, "# Hot-path benchmark baselines (test/host/bench/hotpath_bench.c)\n");
+    fprintf(file, "# <benchmark> <cost relative to the calibration loop> <tolerance %%>\n");
+    fprintf(file, "# Recorded with hotpath_bench --record; calibration loop %.1f ns on that machine\n",
+            results[BENCH_CALIBRATION].ns);
+    fprintf(file, "# Tolerances are kept across --record. The process_received_data ones are wider:\n");
+    fprintf(file, "# the receive path reads the clock twice per chunk, and host clock reads vary\n");
+    fprintf(file, "# more between runs than plain code does.\n");
+    for (int b = 1; b < BENCH_COUNT; b++) {
+        bench_result_t *r = &results[b];
+        uint32_t tolerance = r->tolerance_pct ? r->tolerance_pct : DEFAULT_TOLERANCE;
+        fprintf(file, "%-36s %8.3f %4u    # %.1f ns\n", r->name, r->relative, tolerance, r->ns);
+        printf("%-36s %8.3f (%.1f ns)\n", r->name, r->relative, r->ns);
+    }
+    fclose(file);
+    printf("Baselines written to %s\n", path);
+    return true;
+}
+
+// Diff table on stdout, BENCH lines to the results file; false on regression
+static bool compare_baselines(FILE *out) {
+    uint32_t regressions = 0;
+
+    printf("Hot-path benchmarks (best of %d batches x %d calls, calibration loop %.1f ns)\n",
+           BENCH_BATCHES, BENCH_BATCH, results[BENCH_CALIBRATION].ns);
+    printf("%-36s | %8s | %8s | %8s | %8s | %4s | %s\n",
+           "benchmark", "ns/call", "relative", "baseline", "delta", "tol", "status");
+    for (int b = 1; b < BENCH_COUNT; b++) {
+        bench_result_t *r = &results[b];
+        const char *status = "ok";
+        const char *verdict = "pass";
+        double delta_pct = 0.0;
+        if (r->baseline == 0.0) {
+            status = "new (record a baseline)";
+            verdict = "new";
+        } else {
+            delta_pct = (r->relative - r->baseline) * 100.0 / r->baseline;
+            if (delta_pct > r->tolerance_pct) {
+                status = "REGRESSION";
+                verdict = "fail";
+                regressions++;
+            } else if (delta_pct < -(double)r->tolerance_pct) {
+                status = "faster (re-record baseline)";
+            }
+        }
+        printf("%-36s | %8.1f | %8.3f | %8.3f | %+7.1f%% | %3u%% | %s\n",
+               r->name, r->ns, r->relative, r->baseline, delta_pct, r->tolerance_pct, status);
+        if (out != NULL) {
+            fprintf(out, "BENCH name=%s ns=%.1f relative=%.3f baseline=%.3f delta_pct=%.1f status=%s\n",
+                    r->name, r->ns, r->relative, r->baseline, delta_pct, verdict);
+        }
+    }
+    if (regressions > 0) {
+        printf("%u benchmark(s) regressed beyond tolerance\n", regressions);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool record = argc > 1 && strcmp(argv[1], "--record") == 0;
+    const char *baseline_path = argc > (record ? 2 : 1) ? argv[record ? 2 : 1] : NULL;
+    if (baseline_path == NULL) {
+        fprintf(stderr, "usage: %s <baseline file> [results file] | --record <baseline file>\n", argv[0]);
+        return 2;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    host_log_set_level(ESP_LOG_ERROR);
+    elm327_init_system();
+
+    if (record) {
+        for (int b = 1; b < BENCH_COUNT; b++) {
+            for (int attempt = 0; attempt < BENCH_ATTEMPTS; attempt++) {
+                run_benchmark((bench_id_t)b);
+            }
+        }
+        return record_baselines(baseline_path) ? 0 : 1;
+    }
+
+    // Load from other processes can slow a whole run down; a regression has
+    // to persist over BENCH_ATTEMPTS measurements (the best one counts)
+    bool ok = load_baselines(baseline_path, true);
+    for (int b = 1; b < BENCH_COUNT; b++) {
+        for (int attempt = 0; attempt < BENCH_ATTEMPTS && (attempt == 0 || is_regression(&results[b])); attempt++) {
+            run_benchmark((bench_id_t)b);
+        }
+    }
+    FILE *out = NULL;
+    if (argc > 2) {
+        out = fopen(argv[2], "w");
+        if (out == NULL) {
+            fprintf(stderr, "cannot write results %s\n", argv[2]);
+            ok = false;
+        }
+    }
+    ok &= compare_baselines(out);
+    if (out != NULL) {
+        fclose(out);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+// WebSocket dashboard against stand-in clients, in virtual time.
+//
+//   ws_client
+//
+// wifi_dashboard_task runs as on the target; the clients open sessions on
+// /ws through the httpd stand-in and decode every delivered frame the way the
+// dashboard page does. A fast client takes its frames every 10 ms, a slow one
+// once a second, so its frames back up and get dropped. Checks:
+// - sessions past WIFI_DASHBOARD_MAX_CLIENTS are refused
+// - the first frame of a session is a key frame, sequence numbers increase,
+//   and delta frames carry only channels that changed
+// - the slow client drops frames, and once the values hold still both
+//   clients' decoded channels match the firmware's values
+// - a closed session frees its slot for a new client, which starts with a key
+// - SPP round trips slowed while streaming show up as a median shift
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host.h"
+#include "wifi_dashboard.h"
+#include "obd_data.h"
+#include "launch_control.h"
+#include "power_manager.h"
+
+#define FAST_PERIOD_MS      10
+#define SLOW_PERIOD_MS      1000
+#define STREAM_MS           6000
+#define RUN_SECONDS         10
+
+typedef struct {
+    const char *name;
+    int fd;
+    bool synced;                        // Key frame applied
+    int32_t values[DASH_CH_COUNT];
+    uint32_t frames;
+    uint32_t keyframes;
+    int32_t last_seq;
+    uint32_t errors;
+    uint32_t dropped;                   // From the firmware's report
+} ws_client_t;
+
+static ws_client_t fast = { "fast", -1 };
+static ws_client_t slow = { "slow", -1 };
+static ws_client_t late = { "late", -1 };
+static ws_client_t *const clients[] = { &fast, &slow, &late };
+static bool script_done = false;
+static bool shift_warned = false;
+
+static void fail(ws_client_t *client, const char *what) {
+    if (client->errors++ == 0) {
+        host_rtos_fail("%s client: %s", client->name, what);
+    }
+}
+
+// Decode one delivered frame (dashboard page semantics)
+static void on_frame(int fd, const uint8_t *payload, size_t len) {
+    ws_client_t *client = NULL;
+    for (size_t i = 0; i < sizeof(clients) / sizeof(clients[0]); i++) {
+        if (clients[i]->fd == fd) {
+            client = clients[i];
+        }
+    }
+    if (client == NULL) {
+        return;
+    }
+    const dash_frame_header_t *header = (const dash_frame_header_t *)payload;
+    const dash_frame_entry_t *entries = (const dash_frame_entry_t *)(payload + sizeof(*header));
+    if (len < sizeof(*header) || len != sizeof(*header) + header->count * sizeof(dash_frame_entry_t)) {
+        fail(client, "frame length does not match its entry count");
+        return;
+    }
+    if (header->type == DASH_FRAME_KEY) {
+        if (header->count != DASH_CH_COUNT) {
+            fail(client, "key frame without every channel");
+        }
+        client->keyframes++;
+        client->synced = true;
+    } else if (!client->synced) {
+        fail(client, "delta frame before the first key frame");
+    }
+    if (client->frames > 0 && (int32_t)header->seq <= client->last_seq) {
+        fail(client, "sequence number went backwards");
+    }
+    for (int i = 0; i < header->count; i++) {
+        if (entries[i].channel >= DASH_CH_COUNT) {
+            fail(client, "unknown channel");
+            continue;
+        }
+        if (header->type == DASH_FRAME_DELTA && entries[i].value == client->values[entries[i].channel]) {
+            fail(client, "delta frame repeats an unchanged channel");
+        }
+        client->values[entries[i].channel] = entries[i].value;
+    }
+    client->last_seq = header->seq;
+    client->frames++;
+}
+
+static void on_log(esp_log_level_t level, const char *tag, const char *message) {
+    if (strcmp(tag, "DASHBOARD") != 0) {
+        return;
+    }
+    int fd;
+    unsigned long sent;
+    unsigned long dropped;
+    if (sscanf(message, " fd %d: %lu frames sent, %lu dropped", &fd, &sent, &dropped) == 3) {
+        for (size_t i = 0; i < sizeof(clients) / sizeof(clients[0]); i++) {
+            if (clients[i]->fd == fd) {
+                clients[i]->dropped = dropped;
+            }
+        }
+    } else if (level == ESP_LOG_WARN && strstr(message, "median shifted") != NULL) {
+        shift_warned = true;
+    }
+}
+
+// What the firmware pushes (mirrors snapshot_channels)
+static void expected_values(int32_t *values) {
+    values[DASH_CH_RPM] = (int32_t)vehicle_data.rpm;
+    values[DASH_CH_THROTTLE] = vehicle_data.throttle_position;
+    values[DASH_CH_SPEED] = vehicle_data.vehicle_speed;
+    values[DASH_CH_TIMING] = vehicle_data.timing_advance;
+    values[DASH_CH_COOLANT] = vehicle_data.coolant_temp;
+    values[DASH_CH_BOTTLE_PSI] = vehicle_data.bottle_pressure_psi;
+    values[DASH_CH_AFR_X10] = vehicle_data.afr_x10;
+    values[DASH_CH_INTERLOCK] = vehicle_data.analog_interlock_ok ? 1 : 0;
+    values[DASH_CH_LAUNCH_STATE] = (int32_t)launch_control_get_state();
+    values[DASH_CH_BATTERY_MV] = (int32_t)power_manager_get_voltage_mv();
+}
+
+static void check_converged(ws_client_t *client) {
+    int32_t want[DASH_CH_COUNT];
+    expected_values(want);
+    if (!client->synced || memcmp(client->values, want, sizeof(want)) != 0) {
+        fail(client, "decoded channels differ from the firmware's values");
+    }
+}
+
+// Deliver queued frames, then wait one push period, a few times over
+static void settle(ws_client_t *a, ws_client_t *b) {
+    for (int i = 0; i < 3; i++) {
+        host_httpd_ws_complete(a->fd);
+        if (b != NULL) {
+            host_httpd_ws_complete(b->fd);
+        }
+        vTaskDelay(pdMS_TO_TICKS(WIFI_DASHBOARD_PUSH_INTERVAL_MS));
+    }
+    host_httpd_ws_complete(a->fd);
+    if (b != NULL) {
+        host_httpd_ws_complete(b->fd);
+    }
+}
+
+static void client_task(void *pv) {
+    // Polling with the AP idle: 20-25 ms round trips
+    for (int i = 0; i < 200; i++) {
+        wifi_dashboard_on_spp_rtt(20000 + (i % 10) * 500);
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    fast.fd = host_httpd_ws_open("/ws");
+    slow.fd = host_httpd_ws_open("/ws");
+    if (fast.fd < 0 || slow.fd < 0) {
+        host_rtos_fail("WebSocket handshake refused with free sessions");
+    }
+    int extra = host_httpd_ws_open("/ws");
+    if (extra >= 0) {
+        host_rtos_fail("session %d accepted past WIFI_DASHBOARD_MAX_CLIENTS", extra);
+    }
+
+    // Streaming: RPM moves every 10 ms, throttle every 500 ms, and the SPP
+    // round trips stretch to 45-50 ms
+    for (int t = 0; t < STREAM_MS; t += FAST_PERIOD_MS) {
+        vehicle_data.rpm = 800 + t / 2;
+        if (t % 500 == 0) {
+            vehicle_data.throttle_position = (uint8_t)((t / 100) % 100);
+        }
+        wifi_dashboard_on_spp_rtt(45000 + (t % 50) * 100);
+        host_httpd_ws_complete(fast.fd);
+        if (t % SLOW_PERIOD_MS == 0) {
+            host_httpd_ws_complete(slow.fd);
+        }
+        vTaskDelay(pdMS_TO_TICKS(FAST_PERIOD_MS));
+    }
+
+    // Values hold still: dropped changes must roll into the next delta
+    settle(&fast, &slow);
+    check_converged(&fast);
+    check_converged(&slow);
+
+    // Incoming frames are drained without touching the session
+    static const uint8_t ping[] = "ping";
+    if (host_httpd_ws_receive(fast.fd, "/ws", ping, sizeof(ping) - 1) != ESP_OK) {
+        host_rtos_fail("incoming WebSocket frame not accepted");
+    }
+
+    // Report before the fast client leaves (per-session drop counters)
+    wifi_dashboard_log_report();
+
+    // The fast client leaves; its slot goes to a new client
+    host_httpd_close(fast.fd);
+    fast.fd = -1;                       // The descriptor number gets reused
+    late.fd = host_httpd_ws_open("/ws");
+    if (late.fd < 0) {
+        host_rtos_fail("closed session's slot was not freed");
+    }
+    settle(&late, &slow);
+    vehicle_data.vehicle_speed = 42;
+    settle(&late, &slow);
+    check_converged(&late);
+    check_converged(&slow);
+
+    script_done = true;
+    vTaskDelete(NULL);
+}
+
+static void report(void) {
+    printf("%-6s | %7s | %6s | %8s | %6s\n", "client", "frames", "keys", "dropped", "errors");
+    for (size_t i = 0; i < sizeof(clients) / sizeof(clients[0]); i++) {
+        printf("%-6s | %7lu | %6lu | %8lu | %6lu\n", clients[i]->name, (unsigned long)clients[i]->frames,
+               (unsigned long)clients[i]->keyframes, (unsigned long)clients[i]->dropped,
+               (unsigned long)clients[i]->errors);
+    }
+    if (!script_done) {
+        host_rtos_fail("client script did not finish in %d s", RUN_SECONDS);
+    }
+    if (fast.dropped != 0) {
+        host_rtos_fail("fast client dropped %lu frames", (unsigned long)fast.dropped);
+    }
+    if (slow.dropped == 0 || slow.frames >= fast.frames) {
+        host_rtos_fail("slow client never fell behind (%lu dropped)", (unsigned long)slow.dropped);
+    }
+    if (late.frames == 0) {
+        host_rtos_fail("late client received nothing");
+    }
+    if (!shift_warned) {
+        host_rtos_fail("SPP RTT shift while streaming was not reported");
+    }
+    if (!host_rtos_failed()) {
+        printf("WebSocket dashboard checks passed\n");
+    }
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    host_log_set_level(getenv("WS_VERBOSE") ? ESP_LOG_INFO : ESP_LOG_ERROR);
+    host_log_set_sink(on_log);
+    host_httpd_set_ws_hook(on_frame);
+
+    wifi_dashboard_init();
+    xTaskCreate(wifi_dashboard_task, "dashboard", 3072, NULL, 3, NULL);
+    xTaskCreate(client_task, "client", 3072, NULL, 2, NULL);
+    host_rtos_at_end(report);
+    host_rtos_run(RUN_SECONDS * 1000000LL);
+    return 0;
+}
@@ -0,0 +1,293 @@
+// Receive path cost property: no input makes process_received_data
+// superlinear or much slower per byte than ordinary adapter traffic.
+//
+//   rx_fuzz <inputs> <slowest dir>     deterministic driver (ctest)
+//   libFuzzer: build with -DRX_FUZZ_LIBFUZZER=ON, run rx_fuzz_libfuzzer
+//
+// The bound mirrors the documented budget in elm327.h (a cost per chunk plus
+// a cost per byte), relative to the host instead of in target cycles:
+//   cost <= RX_FUZZ_K * (chunks * benign chunk cost + bytes * benign byte cost)
+// Benign costs come from replayed Mode 01 replies; every cost is the minimum
+// of RX_FUZZ_REPEATS runs with fresh link and vehicle state.
+//
+// The deterministic driver generates inputs from a fixed seed (random bytes,
+// floods without terminators, line storms, mutated replies, segment and
+// compact-hex abuse), fails on any input over the bound, and saves the
+// RX_FUZZ_KEEP slowest inputs relative to their bound as slowest-<rank>.bin.
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host.h"
+#include "elm327.h"
+#include "obd_data.h"
+#include "launch_control.h"
+#include "freeze_frame.h"
+
+#define RX_FUZZ_K           4       // Allowed slowdown against benign traffic
+#define RX_FUZZ_REPEATS     5       // Runs per input; the fastest counts
+#define RX_FUZZ_KEEP        5       // Slowest inputs saved
+#define RX_FUZZ_MAX_INPUT   4096
+#define RX_FUZZ_SEED        0x5EED1234u
+
+typedef struct {
+    double ratio;                   // Cost over its bound
+    uint16_t chunk;
+    size_t size;
+    uint8_t data[RX_FUZZ_MAX_INPUT];
+} slow_input_t;
+
+static double benign_chunk_ns = 0.0;
+static double benign_byte_ns = 0.0;
+static slow_input_t slowest[RX_FUZZ_KEEP];
+static uint32_t rng_state = RX_FUZZ_SEED;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void reset_state(void) {
+    elm327_link_reset(&elm327_links[ELM327_LINK_PRIMARY]);
+    obd_data_init();
+    launch_control_init();
+    freeze_frame_init();
+}
+
+// Fastest of RX_FUZZ_REPEATS runs of the input, split into chunk-byte reads
+static double feed_ns(const uint8_t *data, size_t size, uint16_t chunk) {
+    double best = 0.0;
+    for (int r = 0; r < RX_FUZZ_REPEATS; r++) {
+        reset_state();
+        int64_t start = now_ns();
+        for (size_t pos = 0; pos < size; pos += chunk) {
+            size_t len = size - pos < chunk ? size - pos : chunk;
+            process_received_data((const char *)data + pos, (uint16_t)len);
+        }
+        double ns = (double)(now_ns() - start);
+        if (r == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+static size_t chunk_count(size_t size, uint16_t chunk) {
+    return (size + chunk - 1) / chunk;
+}
+
+// Benign traffic: polled replies, one per chunk, as the adapter sends them
+static void measure_benign(void) {
+    static const char *const replies[] = {
+        "41 0C 1A F8 11 5A \r\r>",
+        "41 0D 3C \r\r>",
+        "008\r0: 41 0C 0F A0 11 33\r1: 0D 28 55 55 55 55 55\r\r>",
+        "41 0C 0B B8 0E 8C \r\r>",
+        "12.6V\r\r>",
+    };
+    static uint8_t stream[RX_FUZZ_MAX_INPUT];
+    size_t size = 0;
+    size_t chunks = 0;
+    while (size + 64 < sizeof(stream)) {
+        const char *reply = replies[chunks % (sizeof(replies) / sizeof(replies[0]))];
+        memcpy(stream + size, reply, strlen(reply));
+        size += strlen(reply);
+        chunks++;
+    }
+
+    // Per-chunk cost from one-byte chunks, per-byte cost from whole replies
+    static uint8_t small[256];
+    memset(small, '4', sizeof(small));
+    double small_ns = feed_ns(small, sizeof(small), 1) / sizeof(small);
+    double whole_ns = 0.0;
+    for (int r = 0; r < RX_FUZZ_REPEATS; r++) {
+        reset_state();
+        int64_t start = now_ns();
+        size_t pos = 0;
+        for (size_t i = 0; i < chunks; i++) {
+            const char *reply = replies[i % (sizeof(replies) / sizeof(replies[0]))];
+            process_received_data((const char *)stream + pos, (uint16_t)strlen(reply));
+            pos += strlen(reply);
+        }
+        double ns = (double)(now_ns() - start);
+        if (r == 0 || ns < whole_ns) {
+            whole_ns = ns;
+        }
+    }
+    benign_chunk_ns = small_ns;
+    benign_byte_ns = (whole_ns - chunks * small_ns) / size;
+    if (benign_byte_ns < small_ns / 64) {
+        benign_byte_ns = small_ns / 64;     // Clock resolution floor
+    }
+}
+
+// Cost of one input over its bound (> 1.0 violates the property)
+static double check_input(const uint8_t *data, size_t size, uint16_t chunk) {
+    if (benign_byte_ns == 0.0) {
+        host_log_set_level(ESP_LOG_NONE);
+        elm327_init_system();
+        measure_benign();
+    }
+    double ns = feed_ns(data, size, chunk);
+    double bound = RX_FUZZ_K * (chunk_count(size, chunk) * benign_chunk_ns + size * benign_byte_ns);
+    if (ns > bound) {
+        // Confirm before reporting: other processes can slow a whole measurement down
+        double again = feed_ns(data, size, chunk);
+        ns = again < ns ? again : ns;
+    }
+    double ratio = ns / bound;
+
+    // Keep the slowest inputs, worst first
+    for (int i = 0; i < RX_FUZZ_KEEP; i++) {
+        if (ratio > slowest[i].ratio) {
+            memmove(&slowest[i + 1], &slowest[i], (RX_FUZZ_KEEP - 1 - i) * sizeof(slowest[0]));
+            slowest[i].ratio = ratio;
+            slowest[i].chunk = chunk;
+            slowest[i].size = size;
+            memcpy(slowest[i].data, data, size);
+            break;
+        }
+    }
+    return ratio;
+}
+
+// Chunk size from a selector byte: 1 to 946 bytes in steps of 15
+static uint16_t chunk_from_selector(uint8_t selector) {
+    return (uint16_t)(1 + (selector % 64) * 15);
+}
+
+// libFuzzer entry: first byte selects the chunk size, the rest is the stream
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 2 || size > RX_FUZZ_MAX_INPUT) {
+        return 0;
+    }
+    uint16_t chunk = chunk_from_selector(data[0]);
+    if (check_input(data + 1, size - 1, chunk) > 1.0) {
+        fprintf(stderr, "receive path cost over %dx benign bound (%zu bytes, chunk %u)\n",
+                RX_FUZZ_K, size - 1, chunk);
+        abort();
+    }
+    return 0;
+}
+
+#ifndef RX_FUZZ_LIBFUZZER
+static const char *const tokens[] = {
+    "41 ", "0C ", "1A ", "F8 ", "11 ", "0D ", "55 ", "008", "FFF", "0: ", "1: ", "F: ",
+    "SEARCHING...", "NO DATA", "CAN ERROR", "ERROR", "OK", "ELM327 v1.5", "12.6V",
+    "410C1AF8", "49 02 01 ", "\r", "\n", ">", " ", "\0",
+};
+
+// One generated input; returns its size
+static size_t generate(uint32_t kind, uint8_t *out, size_t size) {
+    size_t n = 0;
+    switch (kind) {
+        case 0:     // Random bytes
+            for (; n < size; n++) out[n] = (uint8_t)rng();
+            break;
+        case 1:     // Printable flood without terminator (overlong lines)
+            for (; n < size; n++) out[n] = (uint8_t)(32 + rng() % 95);
+            break;
+        case 2:     // Line storm: one- and two-character lines
+            for (; n < size; n++) out[n] = (n % 2) ? '\r' : "4>10:"[rng() % 5];
+            break;
+        case 3: {   // Mutated replies from adapter tokens
+            while (n < size) {
+                const char *tok = tokens[rng() % (sizeof(tokens) / sizeof(tokens[0]))];
+                size_t len = tok[0] ? strlen(tok) : 1;
+                if (n + len > size) {
+                    break;
+                }
+                memcpy(out + n, tok, len);
+                n += len;
+            }
+            break;
+        }
+        case 4:     // Segment abuse: maximal length, endless hex segments
+            n = (size_t)snprintf((char *)out, size, "FFF\r");
+            while (n + 8 < size) {
+                out[n++] = "0123456789ABCDEF"[rng() % 16];
+                out[n++] = ':';
+                while (n + 4 < size && rng() % 64) {
+                    out[n++] = ' ';
+                    out[n++] = "0123456789ABCDEF"[rng() % 16];
+                    out[n++] = "0123456789ABCDEF"[rng() % 16];
+                }
+                out[n++] = '\r';
+            }
+            break;
+        case 5:     // Compact hex lines just under the buffer size
+        default:
+            while (n + 2 < size) {
+                size_t line = 2 + (rng() % (RX_BUFFER_SIZE / 2)) * 2;
+                for (size_t i = 0; i < line && n + 1 < size; i++) {
+                    out[n++] = i < 2 ? "41"[i] : "0123456789ABCDEF"[rng() % 16];
+                }
+                out[n++] = '\r';
+            }
+            break;
+    }
+    return n;
+}
+
+static bool save_slowest(const char *dir) {
+    char command[512];
+    snprintf(command, sizeof(command), "mkdir -p '%s'", dir);
+    if (system(command) != 0) {
+        fprintf(stderr, "cannot create %s\n", dir);
+        return false;
+    }
+    printf("Slowest inputs (cost / bound), saved to %s:\n", dir);
+    for (int i = 0; i < RX_FUZZ_KEEP && slowest[i].size > 0; i++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/slowest-%d.bin", dir, i + 1);
+        FILE *file = fopen(path, "wb");
+        if (file == NULL) {
+            fprintf(stderr, "cannot write %s\n", path);
+            return false;
+        }
+        // Same layout as a libFuzzer input: chunk selector byte, then the stream
+        uint8_t selector = (uint8_t)((slowest[i].chunk - 1) / 15);
+        fwrite(&selector, 1, 1, file);
+        fwrite(slowest[i].data, 1, slowest[i].size, file);
+        fclose(file);
+        printf("  %d: %.2f (%zu bytes, chunk %u)\n", i + 1, slowest[i].ratio, slowest[i].size, slowest[i].chunk);
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    static uint8_t input[RX_FUZZ_MAX_INPUT];
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <inputs> <slowest dir>\n", argv[0]);
+        return 2;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    uint32_t count = (uint32_t)atol(argv[1]);
+    uint32_t violations = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        size_t size = generate(i % 6, input, 64 + rng() % (RX_FUZZ_MAX_INPUT - 64));
+        uint16_t chunk = chunk_from_selector((uint8_t)rng());
+        if (size == 0) {
+            continue;
+        }
+        if (check_input(input, size, chunk) > 1.0) {
+            violations++;
+        }
+    }
+    printf("Receive path: %u inputs, benign %.1f ns/chunk + %.2f ns/byte, bound %dx, %u over\n",
+           count, benign_chunk_ns, benign_byte_ns, RX_FUZZ_K, violations);
+    bool saved = save_slowest(argv[2]);
+    return violations == 0 && saved ? 0 : 1;
+}
+#endif
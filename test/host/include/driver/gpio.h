@@ -0,0 +1,11 @@
+#pragma once
+#include "esp_err.h"
+typedef enum {GPIO_NUM_NC=-1,GPIO_NUM_0=0,GPIO_NUM_2=2,GPIO_NUM_4=4,GPIO_NUM_5=5,GPIO_NUM_12=12,GPIO_NUM_13=13,GPIO_NUM_14=14,GPIO_NUM_15=15,GPIO_NUM_16=16,GPIO_NUM_17=17,GPIO_NUM_18=18,GPIO_NUM_19=19,GPIO_NUM_21=21,GPIO_NUM_22=22,GPIO_NUM_23=23,GPIO_NUM_25=25,GPIO_NUM_26=26,GPIO_NUM_27=27,GPIO_NUM_32=32,GPIO_NUM_33=33,GPIO_NUM_34=34,GPIO_NUM_35=35,GPIO_NUM_36=36,GPIO_NUM_39=39} gpio_num_t;
+typedef enum {GPIO_INTR_DISABLE, GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE, GPIO_INTR_ANYEDGE} gpio_int_type_t;
+typedef enum {GPIO_MODE_INPUT=1, GPIO_MODE_OUTPUT=2} gpio_mode_t;
+typedef enum {GPIO_PULLUP_DISABLE, GPIO_PULLUP_ENABLE} gpio_pullup_t;
+typedef enum {GPIO_PULLDOWN_DISABLE, GPIO_PULLDOWN_ENABLE} gpio_pulldown_t;
+typedef struct { uint64_t pin_bit_mask; gpio_mode_t mode; gpio_pullup_t pull_up_en; gpio_pulldown_t pull_down_en; gpio_int_type_t intr_type; } gpio_config_t;
+esp_err_t gpio_config(const gpio_config_t*);
+esp_err_t gpio_set_level(gpio_num_t, uint32_t);
+int gpio_get_level(gpio_num_t);
@@ -0,0 +1,4 @@
+#pragma once
+#include "esp_adc/adc_continuous.h"
+typedef struct adc_cali_scheme_t *adc_cali_handle_t;
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t, int, int*);
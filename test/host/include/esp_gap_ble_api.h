@@ -0,0 +1,25 @@
+#pragma once
+#include "esp_bt.h"
+#include "esp_gap_bt_api.h"
+typedef enum {ESP_GAP_BLE_ADV_DATA_RAW_SET_COMPLETE_EVT, ESP_GAP_BLE_SCAN_RSP_DATA_RAW_SET_COMPLETE_EVT, ESP_GAP_BLE_ADV_START_COMPLETE_EVT, ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT} esp_gap_ble_cb_event_t;
+typedef union {
+  struct { esp_bt_status_t status; } adv_start_cmpl;
+  struct { esp_bt_status_t status; esp_bd_addr_t bda; uint16_t min_int, max_int, latency, conn_int, timeout; } update_conn_params;
+} esp_ble_gap_cb_param_t;
+typedef void (*esp_gap_ble_cb_t)(esp_gap_ble_cb_event_t, esp_ble_gap_cb_param_t*);
+#define ESP_BLE_AD_TYPE_FLAG 0x01
+#define ESP_BLE_AD_TYPE_128SRV_CMPL 0x07
+#define ESP_BLE_AD_TYPE_NAME_CMPL 0x09
+#define ESP_BLE_ADV_FLAG_GEN_DISC (1<<1)
+#define ESP_BLE_ADV_FLAG_BREDR_NOT_SPT (1<<2)
+typedef enum {ADV_TYPE_IND} esp_ble_adv_type_t;
+typedef enum {BLE_ADDR_TYPE_PUBLIC} esp_ble_addr_type_t;
+typedef enum {ADV_CHNL_ALL=7} esp_ble_adv_channel_t;
+typedef enum {ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY} esp_ble_adv_filter_t;
+typedef struct { uint16_t adv_int_min, adv_int_max; esp_ble_adv_type_t adv_type; esp_ble_addr_type_t own_addr_type; esp_bd_addr_t peer_addr; int peer_addr_type; esp_ble_adv_channel_t channel_map; esp_ble_adv_filter_t adv_filter_policy; } esp_ble_adv_params_t;
+typedef struct { esp_bd_addr_t bda; uint16_t min_int, max_int, latency, timeout; } esp_ble_conn_update_params_t;
+esp_err_t esp_ble_gap_register_callback(esp_gap_ble_cb_t);
+esp_err_t esp_ble_gap_config_adv_data_raw(uint8_t*, uint32_t);
+esp_err_t esp_ble_gap_config_scan_rsp_data_raw(uint8_t*, uint32_t);
+esp_err_t esp_ble_gap_start_advertising(esp_ble_adv_params_t*);
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t*);
@@ -0,0 +1,35 @@
+#pragma once
+#include "esp_bt.h"
+typedef enum {ESP_BT_GAP_DISC_RES_EVT, ESP_BT_GAP_DISC_STATE_CHANGED_EVT, ESP_BT_GAP_MODE_CHG_EVT, ESP_BT_GAP_QOS_CMPL_EVT, ESP_BT_GAP_ACL_CONN_CMPL_STAT_EVT, ESP_BT_GAP_ACL_DISCONN_CMPL_STAT_EVT} esp_bt_gap_cb_event_t;
+typedef enum {ESP_BT_GAP_DISCOVERY_STOPPED, ESP_BT_GAP_DISCOVERY_STARTED} esp_bt_gap_discovery_state_t;
+typedef enum {ESP_BT_PM_MD_ACTIVE=0, ESP_BT_PM_MD_HOLD, ESP_BT_PM_MD_SNIFF, ESP_BT_PM_MD_PARK} esp_bt_pm_mode_t;
+typedef enum {ESP_BT_STATUS_SUCCESS=0} esp_bt_status_t;
+typedef enum {ESP_BT_INQ_MODE_GENERAL_INQUIRY} esp_bt_inq_mode_t;
+#define ESP_BT_GAP_TPOLL_MIN 0x0006
+#define ESP_BT_GAP_TPOLL_DFT 0x0028
+#define ESP_BT_GAP_TPOLL_MAX 0x1000
+typedef union {
+  struct { esp_bd_addr_t bda; int num_prop; void *prop; } disc_res;
+  struct { esp_bt_gap_discovery_state_t state; } disc_st_chg;
+  struct { esp_bd_addr_t bda; esp_bt_pm_mode_t mode; } mode_chg;
+  struct { esp_bt_status_t stat; esp_bd_addr_t bda; uint32_t t_poll; } qos_cmpl;
+} esp_bt_gap_cb_param_t;
+typedef void (*esp_bt_gap_cb_t)(esp_bt_gap_cb_event_t, esp_bt_gap_cb_param_t*);
+esp_err_t esp_bt_gap_register_callback(esp_bt_gap_cb_t);
+esp_err_t esp_bt_gap_start_discovery(esp_bt_inq_mode_t, uint8_t, uint8_t);
+esp_err_t esp_bt_gap_cancel_discovery(void);
+esp_err_t esp_bt_gap_set_qos(esp_bd_addr_t, uint32_t);
+typedef enum {ESP_BT_NON_CONNECTABLE, ESP_BT_CONNECTABLE} esp_bt_connection_mode_t;
+typedef enum {ESP_BT_NON_DISCOVERABLE, ESP_BT_LIMITED_DISCOVERABLE, ESP_BT_GENERAL_DISCOVERABLE} esp_bt_discovery_mode_t;
+esp_err_t esp_bt_gap_set_scan_mode(esp_bt_connection_mode_t, esp_bt_discovery_mode_t);
+esp_err_t esp_bt_gap_set_device_name(const char*);
+typedef enum {ESP_BT_PIN_TYPE_VARIABLE, ESP_BT_PIN_TYPE_FIXED} esp_bt_pin_type_t;
+typedef uint8_t esp_bt_pin_code_t[16];
+typedef enum {ESP_BT_SP_IOCAP_MODE} esp_bt_sp_param_t;
+typedef uint8_t esp_bt_io_cap_t;
+#define ESP_BT_IO_CAP_OUT 0
+#define ESP_BT_IO_CAP_IO 1
+#define ESP_BT_IO_CAP_IN 2
+#define ESP_BT_IO_CAP_NONE 3
+esp_err_t esp_bt_gap_set_pin(esp_bt_pin_type_t, uint8_t, esp_bt_pin_code_t);
+esp_err_t esp_bt_gap_set_security_param(esp_bt_sp_param_t, void*, uint8_t);
@@ -0,0 +1,3 @@
+#pragma once
+#include "esp_gatt_defs.h"
+esp_err_t esp_ble_gatt_set_local_mtu(uint16_t);
@@ -0,0 +1,17 @@
+#pragma once
+#include "esp_bt.h"
+typedef uint8_t esp_gatt_if_t;
+#define ESP_GATT_IF_NONE 0xff
+typedef enum {ESP_GATT_OK=0} esp_gatt_status_t;
+#define ESP_GATT_UUID_PRI_SERVICE 0x2800
+#define ESP_GATT_UUID_CHAR_DECLARE 0x2803
+#define ESP_GATT_UUID_CHAR_CLIENT_CONFIG 0x2902
+#define ESP_GATT_CHAR_PROP_BIT_NOTIFY (1<<4)
+#define ESP_GATT_PERM_READ (1<<0)
+#define ESP_GATT_PERM_WRITE (1<<4)
+#define ESP_GATT_AUTO_RSP 2
+#define ESP_UUID_LEN_16 2
+#define ESP_UUID_LEN_128 16
+typedef struct { uint8_t auto_rsp; } esp_attr_control_t;
+typedef struct { uint16_t uuid_length; uint8_t *uuid_p; uint16_t perm; uint16_t max_length; uint16_t length; uint8_t *value; } esp_attr_desc_t;
+typedef struct { esp_attr_control_t attr_control; esp_attr_desc_t att_desc; } esp_gatts_attr_db_t;
@@ -0,0 +1,18 @@
+#pragma once
+#include "esp_gatt_defs.h"
+typedef enum {ESP_GATTS_REG_EVT, ESP_GATTS_CREAT_ATTR_TAB_EVT, ESP_GATTS_CONNECT_EVT, ESP_GATTS_DISCONNECT_EVT, ESP_GATTS_MTU_EVT, ESP_GATTS_WRITE_EVT, ESP_GATTS_CONGEST_EVT} esp_gatts_cb_event_t;
+typedef union {
+  struct { esp_gatt_status_t status; uint16_t app_id; } reg;
+  struct { esp_gatt_status_t status; uint16_t num_handle; uint16_t *handles; } add_attr_tab;
+  struct { uint16_t conn_id; esp_bd_addr_t remote_bda; } connect;
+  struct { uint16_t conn_id; esp_bd_addr_t remote_bda; int reason; } disconnect;
+  struct { uint16_t conn_id; uint16_t mtu; } mtu;
+  struct { uint16_t conn_id; uint16_t handle; uint16_t len; uint8_t *value; } write;
+  struct { uint16_t conn_id; bool congested; } congest;
+} esp_ble_gatts_cb_param_t;
+typedef void (*esp_gatts_cb_t)(esp_gatts_cb_event_t, esp_gatt_if_t, esp_ble_gatts_cb_param_t*);
+esp_err_t esp_ble_gatts_register_callback(esp_gatts_cb_t);
+esp_err_t esp_ble_gatts_app_register(uint16_t);
+esp_err_t esp_ble_gatts_create_attr_tab(const esp_gatts_attr_db_t*, esp_gatt_if_t, uint16_t, uint8_t);
+esp_err_t esp_ble_gatts_start_service(uint16_t);
+esp_err_t esp_ble_gatts_send_indicate(esp_gatt_if_t, uint16_t, uint16_t, uint16_t, uint8_t*, bool);
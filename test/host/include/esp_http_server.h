@@ -0,0 +1,19 @@
+#pragma once
+#include "esp_err.h"
+typedef void *httpd_handle_t;
+typedef enum {HTTP_GET=1} httpd_method_t;
+typedef struct httpd_req { httpd_handle_t handle; int method; const char uri[513]; void *aux; } httpd_req_t;
+typedef void (*httpd_close_func_t)(httpd_handle_t, int);
+typedef struct { uint16_t max_open_sockets; bool lru_purge_enable; httpd_close_func_t close_fn; } httpd_config_t;
+#define HTTPD_DEFAULT_CONFIG() {7, false, NULL}
+typedef struct { const char *uri; httpd_method_t method; esp_err_t (*handler)(httpd_req_t*); void *user_ctx; bool is_websocket; } httpd_uri_t;
+typedef enum {HTTPD_WS_TYPE_BINARY=2} httpd_ws_type_t;
+typedef struct { bool final; bool fragmented; httpd_ws_type_t type; uint8_t *payload; size_t len; } httpd_ws_frame_t;
+typedef void (*transfer_complete_cb)(esp_err_t, int, void*);
+esp_err_t httpd_start(httpd_handle_t*, const httpd_config_t*);
+esp_err_t httpd_register_uri_handler(httpd_handle_t, const httpd_uri_t*);
+esp_err_t httpd_resp_set_type(httpd_req_t*, const char*);
+esp_err_t httpd_resp_send(httpd_req_t*, const char*, ssize_t);
+int httpd_req_to_sockfd(httpd_req_t*);
+esp_err_t httpd_ws_recv_frame(httpd_req_t*, httpd_ws_frame_t*, size_t);
+esp_err_t httpd_ws_send_data_async(httpd_handle_t, int, httpd_ws_frame_t*, transfer_complete_cb, void*);
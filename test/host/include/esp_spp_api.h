@@ -0,0 +1,28 @@
+#pragma once
+#include "esp_bt.h"
+typedef enum {ESP_SPP_SUCCESS=0} esp_spp_status_t;
+typedef enum {ESP_SPP_INIT_EVT, ESP_SPP_UNINIT_EVT, ESP_SPP_DISCOVERY_COMP_EVT, ESP_SPP_OPEN_EVT, ESP_SPP_CLOSE_EVT, ESP_SPP_START_EVT, ESP_SPP_CL_INIT_EVT, ESP_SPP_DATA_IND_EVT, ESP_SPP_CONG_EVT, ESP_SPP_WRITE_EVT, ESP_SPP_SRV_OPEN_EVT, ESP_SPP_SRV_STOP_EVT} esp_spp_cb_event_t;
+typedef enum {ESP_SPP_MODE_CB, ESP_SPP_MODE_VFS} esp_spp_mode_t;
+typedef enum {ESP_SPP_ROLE_MASTER, ESP_SPP_ROLE_SLAVE} esp_spp_role_t;
+#define ESP_SPP_SEC_NONE 0x0000
+#define ESP_SPP_SEC_AUTHORIZE 0x0001
+#define ESP_SPP_SEC_AUTHENTICATE 0x0012
+#define ESP_SPP_SEC_ENCRYPT 0x0024
+typedef union {
+  struct { esp_spp_status_t status; uint32_t handle; uint32_t sec_id; bool use_co; } cl_init;
+  struct { esp_spp_status_t status; uint32_t handle; int fd; esp_bd_addr_t rem_bda; } open;
+  struct { esp_spp_status_t status; uint32_t handle; uint32_t new_listen_handle; int fd; esp_bd_addr_t rem_bda; } srv_open;
+  struct { esp_spp_status_t status; uint32_t port_status; uint32_t handle; bool async; } close;
+  struct { esp_spp_status_t status; uint32_t handle; uint8_t sec_id; uint8_t scn; bool use_co; } start;
+  struct { esp_spp_status_t status; uint32_t handle; uint16_t len; uint8_t *data; } data_ind;
+  struct { esp_spp_status_t status; uint32_t handle; bool cong; } cong;
+  struct { esp_spp_status_t status; uint32_t handle; int len; bool cong; } write;
+} esp_spp_cb_param_t;
+typedef void (esp_spp_cb_t)(esp_spp_cb_event_t, esp_spp_cb_param_t*);
+esp_err_t esp_spp_init(esp_spp_mode_t);
+esp_err_t esp_spp_deinit(void);
+esp_err_t esp_spp_register_callback(esp_spp_cb_t*);
+esp_err_t esp_spp_connect(int, esp_spp_role_t, uint8_t, esp_bd_addr_t);
+esp_err_t esp_spp_disconnect(uint32_t);
+esp_err_t esp_spp_start_srv(int, esp_spp_role_t, uint8_t, const char*);
+esp_err_t esp_spp_write(uint32_t, int, uint8_t*);
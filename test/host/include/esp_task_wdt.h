@@ -0,0 +1,9 @@
+#pragma once
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+typedef struct esp_task_wdt_user_handle_s *esp_task_wdt_user_handle_t;
+esp_err_t esp_task_wdt_add(TaskHandle_t);
+esp_err_t esp_task_wdt_reset(void);
+esp_err_t esp_task_wdt_add_user(const char*, esp_task_wdt_user_handle_t*);
+esp_err_t esp_task_wdt_reset_user(esp_task_wdt_user_handle_t);
@@ -0,0 +1,15 @@
+#pragma once
+#include "esp_err.h"
+#include "esp_event.h"
+extern esp_event_base_t WIFI_EVENT;
+typedef enum {WIFI_EVENT_AP_STACONNECTED=14, WIFI_EVENT_AP_STADISCONNECTED} wifi_event_t;
+typedef struct { int dummy; } wifi_init_config_t;
+#define WIFI_INIT_CONFIG_DEFAULT() {0}
+typedef enum {WIFI_MODE_AP=2} wifi_mode_t;
+typedef enum {WIFI_IF_AP=1} wifi_interface_t;
+typedef enum {WIFI_AUTH_WPA2_PSK=3} wifi_auth_mode_t;
+typedef union { struct { uint8_t ssid[32]; uint8_t password[64]; uint8_t ssid_len; uint8_t channel; wifi_auth_mode_t authmode; uint8_t max_connection; } ap; } wifi_config_t;
+esp_err_t esp_wifi_init(const wifi_init_config_t*);
+esp_err_t esp_wifi_set_mode(wifi_mode_t);
+esp_err_t esp_wifi_set_config(wifi_interface_t, wifi_config_t*);
+esp_err_t esp_wifi_start(void);
@@ -0,0 +1,6 @@
+#pragma once
+// Host build: the subset of sdkconfig.esp32dev the firmware sources test
+#define CONFIG_FREERTOS_HZ              100
+#define CONFIG_PM_ENABLE                1
+#define CONFIG_HTTPD_WS_SUPPORT         1
+#define CONFIG_BT_SSP_ENABLED           1
@@ -0,0 +1,122 @@
+// ECU->GPIO latency for one obd_task configuration, in virtual time.
+//
+//   latency_<config> <seconds>
+//
+// The whole firmware runs against the simulated adapter. The driver holds
+// the clutch input while the vehicle model idles and stages, so launch
+// control arms the way it does in the car. The time of every rising edge of
+// the launch output (gpio_set_level inside gpio_output_set) is compared with
+// the model's true crossing of LAUNCH_RPM_LIMIT.
+//
+// Prints one machine-readable row for latency_report:
+//   LATENCY_ROW|<config>|<stagings>|<edges>|<p50 ms>|<p95 ms>|<p99 ms>|<max ms>
+// Fails if no staging produced an edge, or any staging with the link up
+// produced none.
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host.h"
+#include "elm327.h"
+#include "elm327_sim.h"
+#include "obd_data.h"
+#include "power_manager.h"
+#include "launch_control.h"
+#include "analog_input.h"
+#include "vehicle_model.h"
+
+#define MAX_EDGES 1024
+#define DRIVER_PERIOD_MS 10
+
+void app_main(void);
+
+static int64_t latencies_us[MAX_EDGES];
+static uint32_t edge_count = 0;
+static uint32_t staging_count = 0;
+static int64_t last_crossing_us = 0;
+
+// Output pin edge: the moment gpio_output_set drives the limiter on
+static void on_edge(int pin, int level, int64_t time_us) {
+    if (pin != LAUNCH_OUTPUT_PIN || level != 1) {
+        return;
+    }
+    int64_t crossing_us = elm327_sim_crossing_us();
+    if (crossing_us <= last_crossing_us || crossing_us > time_us) {
+        host_rtos_fail("output edge at %lld us without a new crossing (last %lld us)",
+                       (long long)time_us, (long long)crossing_us);
+        return;
+    }
+    last_crossing_us = crossing_us;
+    if (edge_count < MAX_EDGES) {
+        latencies_us[edge_count++] = time_us - crossing_us;
+    }
+}
+
+static void main_task(void *pv) {
+    app_main();
+    vTaskDelete(NULL);
+}
+
+// Driver: clutch held while idling and staging, released for the launch
+static void driver_task(void *pv) {
+    vehicle_phase_t prev = VEHICLE_PHASE_IDLE;
+    while (1) {
+        vehicle_phase_t phase = vehicle_model_state()->phase;
+        bool staged = phase == VEHICLE_PHASE_IDLE || phase == VEHICLE_PHASE_STAGE;
+        host_gpio_drive(LAUNCH_CLUTCH_PIN, staged ? 0 : 1);
+        // Stagings before the adapter finished initializing cannot produce an edge
+        if (prev == VEHICLE_PHASE_IDLE && phase == VEHICLE_PHASE_STAGE && elm327_link_is_up(ELM327_LINK_PRIMARY)) {
+            staging_count++;
+        }
+        prev = phase;
+        vTaskDelay(pdMS_TO_TICKS(DRIVER_PERIOD_MS));
+    }
+}
+
+static int compare_latency(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile in ms
+static long percentile_ms(uint32_t percent) {
+    uint32_t rank = (edge_count * percent + 99) / 100;
+    return (long)(latencies_us[rank > 0 ? rank - 1 : 0] / 1000);
+}
+
+static void report(void) {
+    char config[64];
+    snprintf(config, sizeof(config), "%s, slot %d ms, ATST %s",
+             OBD_INDIVIDUAL_PIDS ? "individual" : "multi-PID", POWER_SLOT_RUNNING_MS, ELM327_ATST_VALUE);
+
+    if (edge_count == 0) {
+        host_rtos_fail("%s: no output edge in %u stagings", config, staging_count);
+        return;
+    }
+    qsort(latencies_us, edge_count, sizeof(latencies_us[0]), compare_latency);
+    printf("LATENCY_ROW|%s|%u|%u|%ld|%ld|%ld|%ld\n", config, staging_count, edge_count,
+           percentile_ms(50), percentile_ms(95), percentile_ms(99), percentile_ms(100));
+
+    // A staging still in progress at the end may not have crossed yet
+    if (edge_count + 1 < staging_count) {
+        host_rtos_fail("%s: %u stagings but only %u output edges", config, staging_count, edge_count);
+    }
+}
+
+int main(int argc, char **argv) {
+    int64_t seconds = argc > 1 ? atoll(argv[1]) : 1800;
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    host_log_set_level(getenv("LATENCY_VERBOSE") ? ESP_LOG_INFO : ESP_LOG_WARN);
+
+    // Interlock sensors in range: 1000 psi bottle, AFR 12.5 (uncalibrated ADC path)
+    host_adc_set_raw(ANALOG_PRESSURE_CHANNEL, 2535);
+    host_adc_set_raw(ANALOG_AFR_CHANNEL, 1001);
+    host_gpio_set_edge_hook(on_edge);
+
+    xTaskCreate(main_task, "main", 3584, NULL, 1, NULL);
+    xTaskCreate(driver_task, "driver", 2048, NULL, 7, NULL);
+    host_rtos_at_end(report);
+    host_rtos_run(seconds * 1000000LL);
+    return 0;
+}
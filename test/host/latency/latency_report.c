@@ -0,0 +1,66 @@
+// Runs every latency_<config> binary and prints one table to track across
+// releases.
+//
+//   latency_report <seconds> <latency binary> ...
+//
+// Fails if any configuration fails (no edges, missed stagings, crash).
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#define LINE_MAX_LEN 512
+
+// Run one configuration; prints its row, returns false on failure
+static bool run_config(const char *binary, const char *seconds) {
+    char command[LINE_MAX_LEN];
+    char line[LINE_MAX_LEN];
+    bool have_row = false;
+
+    snprintf(command, sizeof(command), "'%s' %s", binary, seconds);
+    FILE *out = popen(command, "r");
+    if (out == NULL) {
+        fprintf(stderr, "cannot run %s\n", binary);
+        return false;
+    }
+    while (fgets(line, sizeof(line), out) != NULL) {
+        if (strncmp(line, "LATENCY_ROW|", 12) != 0) {
+            fputs(line, stderr);    // Warnings and failures from the run
+            continue;
+        }
+        char *fields[8];
+        int n = 0;
+        for (char *tok = strtok(line + 12, "|\n"); tok != NULL && n < 8; tok = strtok(NULL, "|\n")) {
+            fields[n++] = tok;
+        }
+        if (n == 7) {
+            printf("%-36s | %8s | %5s | %5s | %5s | %5s | %5s\n",
+                   fields[0], fields[1], fields[2], fields[3], fields[4], fields[5], fields[6]);
+            have_row = true;
+        }
+    }
+    int status = pclose(out);
+    if (!have_row || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        printf("%-36s | FAILED (%s)\n", binary, have_row ? "see above" : "no result");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <seconds> <latency binary> ...\n", argv[0]);
+        return 2;
+    }
+
+    printf("ECU->GPIO latency (true RPM crossing -> launch output edge, %s s simulated per configuration)\n", argv[1]);
+    printf("%-36s | %8s | %5s | %5s | %5s | %5s | %5s\n",
+           "configuration", "stagings", "edges", "p50", "p95", "p99", "max");
+    bool ok = true;
+    for (int i = 2; i < argc; i++) {
+        ok &= run_config(argv[i], argv[1]);
+    }
+    printf("(latencies in ms)\n");
+    return ok ? 0 : 1;
+}
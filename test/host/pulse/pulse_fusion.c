@@ -0,0 +1,155 @@
+// Tach/OBD fusion with synthetic edges, in virtual time.
+//
+//   pulse_fusion
+//
+// Edges are fed to the tach PCNT unit (host_pcnt_pulses) every millisecond at
+// the rate of a true engine speed, with a sensor that reads 5 % high. OBD RPM
+// replies go through parse_multi_pid_line every OBD_PERIOD_MS and report the
+// true speed OBD_LAG_MS late. Checks, in order:
+// - the tach is trusted after PULSE_TRUST_COUNT agreeing OBD samples
+// - calibration takes out the 5 % error
+// - during a ramp the published RPM is closer to the truth than OBD
+// - when the edges stop with the engine running, trust drops within
+//   PULSE_LOSS_PERIODS pulse intervals and the channel falls back to OBD
+//   instead of the decaying pulse estimate
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+#include "elm327.h"
+#include "obd_data.h"
+#include "pulse_input.h"
+#include "launch_control.h"
+#include "freeze_frame.h"
+#include "publish_policy.h"
+#include "rolling_stats.h"
+
+#define STEP_US             1000
+#define OBD_PERIOD_MS       100
+#define OBD_LAG_MS          100
+#define SENSOR_GAIN         1.05    // Tach reads 5 % high
+#define HISTORY_MS          1000
+
+static double true_rpm_at[HISTORY_MS];  // Ring of the true RPM per ms (OBD lag)
+static double edge_fraction = 0.0;
+static bool signal_present = true;
+static int64_t now_ms = 0;
+static uint32_t obd_rpm = 0;
+static int failures = 0;
+static int64_t trusted_ms = -1;         // From the PULSE log lines
+static int64_t lost_ms = -1;
+
+static void on_log(esp_log_level_t level, const char *tag, const char *message) {
+    if (strcmp(tag, "PULSE") != 0 || strncmp(message, "tach ", 5) != 0) {
+        return;
+    }
+    if (strstr(message, "trusted") != NULL && trusted_ms < 0) {
+        trusted_ms = now_ms;
+    } else if (strstr(message, "lost") != NULL && lost_ms < 0) {
+        lost_ms = now_ms;
+    }
+}
+
+static void check(bool ok, const char *what, double got, double want) {
+    printf("%-52s %8.0f (want %s%.0f)\n", what, got, ok ? "" : "FAILED ", want);
+    if (!ok) {
+        failures++;
+    }
+}
+
+// Advance one millisecond of engine time: edges, PCNT sampling timer, OBD slot
+static void step(double rpm) {
+    true_rpm_at[now_ms % HISTORY_MS] = rpm;
+    if (signal_present) {
+        edge_fraction += rpm * SENSOR_GAIN * PULSE_TACH_PER_REV / 60000.0;
+        int edges = (int)edge_fraction;
+        edge_fraction -= edges;
+        host_pcnt_pulses(PULSE_TACH_PIN, edges);
+    }
+    host_advance_us(STEP_US);
+    now_ms++;
+
+    if (now_ms % OBD_PERIOD_MS == 0 && now_ms > OBD_LAG_MS) {
+        char line[32];
+        obd_rpm = (uint32_t)true_rpm_at[(now_ms - OBD_LAG_MS) % HISTORY_MS];
+        uint32_t raw = obd_rpm * 4;
+        snprintf(line, sizeof(line), "41 0C %02X %02X", (unsigned)(raw >> 8), (unsigned)(raw & 0xFF));
+        parse_multi_pid_line(line);
+    }
+}
+
+static void run_ms(int64_t ms, double from_rpm, double to_rpm) {
+    for (int64_t i = 0; i < ms; i++) {
+        step(from_rpm + (to_rpm - from_rpm) * (double)(i + 1) / ms);
+    }
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    host_log_set_level(getenv("PULSE_VERBOSE") ? ESP_LOG_INFO : ESP_LOG_ERROR);
+    host_log_set_sink(on_log);
+
+    elm327_init_system();
+    obd_data_init();
+    launch_control_init();
+    freeze_frame_init();
+#if ROLLING_STATS_ENABLED
+    rolling_stats_init();
+#endif
+#if PUBLISH_POLICY_ENABLED
+    publish_policy_init();
+#endif
+    pulse_input_init();
+
+    // Steady 3000 RPM: agreement, trust, calibration. One window holds about
+    // a dozen pulses, so single values carry quantization noise; compare means
+    run_ms(3000, 3000, 3000);
+    check(trusted_ms >= 0 && trusted_ms <= OBD_LAG_MS + (PULSE_TRUST_COUNT + 1) * OBD_PERIOD_MS,
+          "steady 3000 RPM, ms until the tach is trusted", (double)trusted_ms,
+          OBD_LAG_MS + (PULSE_TRUST_COUNT + 1) * OBD_PERIOD_MS);
+    double sum = 0.0;
+    for (int i = 0; i < 1000; i++) {
+        step(3000);
+        sum += vehicle_data.rpm;
+    }
+    check(fabs(sum / 1000 - 3000.0) <= 3000.0 * 0.02,
+          "steady 3000 RPM, mean published RPM", sum / 1000, 3000);
+
+    // Ramp 3000 -> 5000 RPM in 500 ms: pulses lead the lagging OBD replies
+    double pulse_error = 0.0;
+    double obd_error = 0.0;
+    for (int i = 1; i <= 500; i++) {
+        double rpm = 3000.0 + 2000.0 * i / 500;
+        step(rpm);
+        pulse_error += fabs(vehicle_data.rpm - rpm) / 500;
+        obd_error += fabs(obd_rpm - rpm) / 500;
+    }
+    check(pulse_error < obd_error * 0.75, "ramp, mean published RPM error", pulse_error, obd_error * 0.75);
+    run_ms(500, 5000, 5000);
+
+    // Tach wire lost at 5000 RPM: the interval is 6 ms, so trust must drop
+    // within a few sample periods. The window estimate only decays until then
+    signal_present = false;
+    double lowest = vehicle_data.rpm;
+    int64_t cut_ms = now_ms;
+    for (int i = 0; i < 300; i++) {
+        step(5000);
+        if (vehicle_data.rpm < lowest) {
+            lowest = vehicle_data.rpm;
+        }
+    }
+    int64_t fallback_ms = lost_ms >= 0 ? lost_ms - cut_ms : -1;
+    check(fallback_ms >= 0 && fallback_ms <= 2 * PULSE_SAMPLE_PERIOD_MS + PULSE_LOSS_PERIODS * 6,
+          "signal loss, ms until OBD owns RPM", (double)fallback_ms,
+          2 * PULSE_SAMPLE_PERIOD_MS + PULSE_LOSS_PERIODS * 6);
+    check(lowest >= 5000.0 * 0.7, "signal loss, lowest published RPM", lowest, 5000.0 * 0.7);
+    check(vehicle_data.rpm == obd_rpm, "signal loss, RPM after 300 ms (OBD)", vehicle_data.rpm, obd_rpm);
+
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("Pulse fusion checks passed\n");
+    return 0;
+}
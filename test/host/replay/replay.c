@@ -0,0 +1,379 @@
+// Replays the adapter session corpus through the receive path and reports
+// per-trace throughput.
+//
+//   replay <corpus dir>
+//
+// Every *.trace file is replayed three ways on the firmware build without
+// the simulator:
+// - process_received_data: the RX chunks exactly as they arrived over RFCOMM
+// - elm327_handle_response: the same bytes pre-split into lines
+// - parse_multi_pid_line: only the Mode 01 reply lines
+// The first pass also checks each EXPECT line against vehicle_data. Fails on
+// a mismatch, an unreadable trace or an empty corpus.
+//
+// Trace format (one event per line, '#' starts a comment):
+//   <ms> TX <hex>    bytes written to the adapter (sets the echo filter)
+//   <ms> RX <hex>    one chunk received from the adapter
+//   EXPECT <field>=<value> ...   rpm, throttle, speed, timing, coolant
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host.h"
+#include "elm327.h"
+#include "obd_data.h"
+#include "launch_control.h"
+#include "freeze_frame.h"
+#include "publish_policy.h"
+#include "rolling_stats.h"
+
+#define MAX_TRACES 64
+#define MAX_EVENTS 1024
+#define EVENT_MAX_BYTES 256
+#define PATH_MAX_LEN 512
+#define MIN_MEASURE_NS 50000000LL   // Repeat each layer for at least 50 ms
+
+typedef enum {
+    EVENT_TX,
+    EVENT_RX,
+    EVENT_LINE,         // Derived: one complete line from the RX stream
+    EVENT_EXPECT
+} event_type_t;
+
+typedef struct {
+    event_type_t type;
+    int64_t time_ms;
+    uint16_t len;
+    char data[EVENT_MAX_BYTES];
+} event_t;
+
+typedef struct {
+    char name[64];
+    event_t events[MAX_EVENTS];
+    uint32_t event_count;
+    uint32_t rx_bytes;
+    uint32_t line_bytes;
+    uint32_t reply_bytes;
+} trace_t;
+
+static trace_t trace;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static bool add_event(event_type_t type, int64_t time_ms, const char *data, uint16_t len) {
+    if (trace.event_count >= MAX_EVENTS || len >= EVENT_MAX_BYTES) {
+        fprintf(stderr, "%s: trace too large\n", trace.name);
+        return false;
+    }
+    event_t *event = &trace.events[trace.event_count++];
+    event->type = type;
+    event->time_ms = time_ms;
+    event->len = len;
+    memcpy(event->data, data, len);
+    event->data[len] = '\0';
+    return true;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Lines as the receive path would dispatch them (terminators, prompt and
+// non-printable bytes dropped), for the line-level layers
+static char line_buffer[RX_BUFFER_SIZE];
+static uint16_t line_len = 0;
+
+static bool split_lines(int64_t time_ms, const char *data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\r' || c == '\n') {
+            if (line_len > 0) {
+                if (!add_event(EVENT_LINE, time_ms, line_buffer, line_len)) {
+                    return false;
+                }
+                trace.line_bytes += line_len;
+                if (strstr(trace.events[trace.event_count - 1].data, "41 ") != NULL) {
+                    trace.reply_bytes += line_len;
+                }
+            }
+            line_len = 0;
+        } else if (c >= 32 && c <= 126 && line_len < RX_BUFFER_SIZE - 1) {
+            line_buffer[line_len++] = c;
+        }
+    }
+    return true;
+}
+
+static bool load_trace(const char *path, const char *name) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    memset(&trace, 0, sizeof(trace));
+    snprintf(trace.name, sizeof(trace.name), "%.*s", (int)(strcspn(name, ".")), name);
+    line_len = 0;
+
+    char line[2 * EVENT_MAX_BYTES + 64];
+    int line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != NULL) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0') {
+            continue;
+        }
+        if (strncmp(line, "EXPECT ", 7) == 0) {
+            ok = add_event(EVENT_EXPECT, 0, line + 7, (uint16_t)strlen(line + 7));
+            continue;
+        }
+
+        long long time_ms;
+        char direction[3];
+        char hex[2 * EVENT_MAX_BYTES + 2];
+        if (sscanf(line, "%lld %2s %513s", &time_ms, direction, hex) != 3 || strlen(hex) % 2 != 0) {
+            fprintf(stderr, "%s:%d: malformed event\n", path, line_no);
+            ok = false;
+            break;
+        }
+        char bytes[EVENT_MAX_BYTES];
+        uint16_t len = 0;
+        for (size_t i = 0; hex[i] && ok; i += 2) {
+            int hi = hex_value(hex[i]);
+            int lo = hex_value(hex[i + 1]);
+            if (hi < 0 || lo < 0 || len >= EVENT_MAX_BYTES - 1) {
+                fprintf(stderr, "%s:%d: bad hex payload\n", path, line_no);
+                ok = false;
+            } else {
+                bytes[len++] = (char)(hi << 4 | lo);
+            }
+        }
+        if (!ok) {
+            break;
+        }
+        if (strcmp(direction, "TX") == 0) {
+            ok = add_event(EVENT_TX, time_ms, bytes, len);
+        } else if (strcmp(direction, "RX") == 0) {
+            trace.rx_bytes += len;
+            ok = add_event(EVENT_RX, time_ms, bytes, len) && split_lines(time_ms, bytes, len);
+        } else {
+            fprintf(stderr, "%s:%d: unknown direction %s\n", path, line_no, direction);
+            ok = false;
+        }
+    }
+    fclose(file);
+    if (ok && trace.rx_bytes == 0) {
+        fprintf(stderr, "%s: no RX events\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+// Fresh adapter connection and vehicle state before every pass
+static void reset_state(void) {
+    elm327_link_reset(&elm327_links[ELM327_LINK_PRIMARY]);
+    obd_data_init();
+    launch_control_init();
+}
+
+// Command as elm327_link_send records it for the echo filter
+static void apply_tx(const event_t *event) {
+    elm327_link_t *link = &elm327_links[ELM327_LINK_PRIMARY];
+    size_t len = strcspn(event->data, "\r");
+    if (len >= sizeof(link->last_command)) {
+        len = sizeof(link->last_command) - 1;
+    }
+    memcpy(link->last_command, event->data, len);
+    link->last_command[len] = '\0';
+}
+
+static bool check_expect(const event_t *event) {
+    char fields[EVENT_MAX_BYTES];
+    bool ok = true;
+
+    strcpy(fields, event->data);
+    for (char *tok = strtok(fields, " "); tok != NULL; tok = strtok(NULL, " ")) {
+        char *eq = strchr(tok, '=');
+        if (eq == NULL) {
+            fprintf(stderr, "%s: malformed EXPECT field '%s'\n", trace.name, tok);
+            return false;
+        }
+        *eq = '\0';
+        long want = atol(eq + 1);
+        long got;
+        if (strcmp(tok, "rpm") == 0) got = (long)vehicle_data.rpm;
+        else if (strcmp(tok, "throttle") == 0) got = vehicle_data.throttle_position;
+        else if (strcmp(tok, "speed") == 0) got = vehicle_data.vehicle_speed;
+        else if (strcmp(tok, "timing") == 0) got = vehicle_data.timing_advance;
+        else if (strcmp(tok, "coolant") == 0) got = vehicle_data.coolant_temp;
+        else {
+            fprintf(stderr, "%s: unknown EXPECT field '%s'\n", trace.name, tok);
+            return false;
+        }
+        if (got != want) {
+            fprintf(stderr, "%s: EXPECT %s=%ld, decoded %ld\n", trace.name, tok, want, got);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Golden pass: chunks in order on the virtual clock, EXPECT lines checked
+static bool replay_checked(void) {
+    bool ok = true;
+    uint32_t expects = 0;
+
+    reset_state();
+    for (uint32_t i = 0; i < trace.event_count; i++) {
+        const event_t *event = &trace.events[i];
+        int64_t event_us = event->time_ms * 1000;
+        if (event->type != EVENT_EXPECT && event_us > host_now_us()) {
+            host_advance_us(event_us - host_now_us());
+        }
+        switch (event->type) {
+            case EVENT_TX: apply_tx(event); break;
+            case EVENT_RX: process_received_data(event->data, event->len); break;
+            case EVENT_EXPECT: ok &= check_expect(event); expects++; break;
+            default: break;
+        }
+    }
+    if (expects == 0) {
+        fprintf(stderr, "%s: no EXPECT lines\n", trace.name);
+        ok = false;
+    }
+    return ok;
+}
+
+// One pass over RX chunks or pre-split lines; returns the time spent in the layer
+static int64_t replay_layer(event_type_t layer) {
+    int64_t spent = 0;
+
+    reset_state();
+    for (uint32_t i = 0; i < trace.event_count; i++) {
+        const event_t *event = &trace.events[i];
+        if (event->type == EVENT_TX) {
+            apply_tx(event);
+            continue;
+        }
+        if (event->type != layer) {
+            continue;
+        }
+        int64_t start = now_ns();
+        if (layer == EVENT_RX) {
+            process_received_data(event->data, event->len);
+        } else {
+            elm327_handle_response(event->data);
+        }
+        spent += now_ns() - start;
+    }
+    return spent;
+}
+
+// Mode 01 reply lines only, straight into the decoder (it tokenizes in place)
+static int64_t replay_replies(void) {
+    char reply[EVENT_MAX_BYTES];
+    int64_t spent = 0;
+
+    reset_state();
+    for (uint32_t i = 0; i < trace.event_count; i++) {
+        const event_t *event = &trace.events[i];
+        if (event->type != EVENT_LINE || strstr(event->data, "41 ") == NULL) {
+            continue;
+        }
+        memcpy(reply, event->data, event->len + 1);
+        int64_t start = now_ns();
+        parse_multi_pid_line(reply);
+        spent += now_ns() - start;
+    }
+    return spent;
+}
+
+// ns per byte over repeated passes (0 when the layer sees no bytes)
+static double measure(int layer, uint32_t bytes) {
+    if (bytes == 0) {
+        return 0.0;
+    }
+    int64_t spent = 0;
+    uint32_t passes = 0;
+    while (spent < MIN_MEASURE_NS || passes < 3) {
+        spent += layer == 2 ? replay_replies() : replay_layer(layer == 0 ? EVENT_RX : EVENT_LINE);
+        passes++;
+    }
+    return (double)spent / ((double)bytes * passes);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <corpus dir>\n", argv[0]);
+        return 2;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    host_log_set_level(getenv("REPLAY_VERBOSE") ? ESP_LOG_INFO : ESP_LOG_ERROR);
+
+    DIR *dir = opendir(argv[1]);
+    if (dir == NULL) {
+        fprintf(stderr, "cannot open corpus %s\n", argv[1]);
+        return 1;
+    }
+    char *names[MAX_TRACES];
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && count < MAX_TRACES) {
+        size_t len = strlen(entry->d_name);
+        if (len > 6 && strcmp(entry->d_name + len - 6, ".trace") == 0) {
+            names[count++] = strdup(entry->d_name);
+        }
+    }
+    closedir(dir);
+    if (count == 0) {
+        fprintf(stderr, "no .trace files in %s\n", argv[1]);
+        return 1;
+    }
+    qsort(names, count, sizeof(names[0]), compare_names);
+
+    elm327_init_system();
+    freeze_frame_init();
+#if ROLLING_STATS_ENABLED
+    rolling_stats_init();
+#endif
+#if PUBLISH_POLICY_ENABLED
+    publish_policy_init();
+#endif
+
+    printf("Replay corpus %s (ns/byte per layer)\n", argv[1]);
+    printf("%-16s | %6s | %-6s | %12s | %8s | %12s | %12s\n",
+           "trace", "bytes", "golden", "rx chunks", "MB/s", "lines", "01 replies");
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+        char path[PATH_MAX_LEN];
+        snprintf(path, sizeof(path), "%s/%s", argv[1], names[i]);
+        if (!load_trace(path, names[i])) {
+            ok = false;
+            continue;
+        }
+        bool golden = replay_checked();
+        ok &= golden;
+        double rx_ns = measure(0, trace.rx_bytes);
+        double line_ns = measure(1, trace.line_bytes);
+        double reply_ns = measure(2, trace.reply_bytes);
+        // 0.0: the layer saw no bytes (compact hex replies never reach parse_multi_pid_line)
+        printf("%-16s | %6u | %-6s | %12.1f | %8.1f | %12.1f | %12.1f\n",
+               trace.name, trace.rx_bytes, golden ? "ok" : "FAIL",
+               rx_ns, rx_ns > 0 ? 1000.0 / rx_ns : 0.0, line_ns, reply_ns);
+        free(names[i]);
+    }
+    return ok ? 0 : 1;
+}
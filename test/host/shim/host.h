@@ -0,0 +1,51 @@
+#pragma once
+// Host harness API: virtual clock, scheduler control and peripheral stand-ins.
+// Firmware sources never include this; tests and scenario runners do.
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+// Scheduler. Tasks run one at a time (highest priority first, FIFO among
+// equals) and the virtual clock only moves when every task is blocked, so a
+// run is deterministic and as fast as the host can execute it.
+typedef void (*host_hook_t)(void);
+void host_rtos_run(int64_t end_us);             // Never returns: exits the process at end_us
+void host_rtos_at_end(host_hook_t hook);        // Called once the clock reaches end_us (no blocking calls)
+void host_rtos_fail(const char *format, ...) __attribute__((format(printf, 1, 2)));
+bool host_rtos_failed(void);
+
+// Virtual clock (esp_timer time base)
+int64_t host_now_us(void);
+void host_advance_us(int64_t us);               // Without the scheduler: move the clock, fire due timers
+
+// GPIO: outputs are recorded with the virtual time of every edge
+typedef void (*host_gpio_edge_hook_t)(int pin, int level, int64_t time_us);
+void host_gpio_set_edge_hook(host_gpio_edge_hook_t hook);
+void host_gpio_drive(int pin, int level);       // Input level seen by gpio_get_level
+int host_gpio_output_level(int pin);
+
+// ADC: continuous-mode frames are synthesized from these raw codes
+void host_adc_set_raw(int channel, uint16_t raw);
+
+// PCNT: edges counted by the unit whose channel watches this GPIO
+void host_pcnt_pulses(int gpio, int edges);
+
+// Logging: every formatted line can be captured (tests), level filters the console
+typedef void (*host_log_sink_t)(esp_log_level_t level, const char *tag, const char *message);
+void host_log_set_sink(host_log_sink_t sink);
+void host_log_set_level(esp_log_level_t level);
+
+// HTTP server: WebSocket sessions opened and closed by the test. Async sends
+// stay queued until host_httpd_ws_complete, which hands each frame to the hook
+typedef void (*host_ws_frame_hook_t)(int fd, const uint8_t *payload, size_t len);
+void host_httpd_set_ws_hook(host_ws_frame_hook_t hook);
+int host_httpd_ws_open(const char *uri);        // Handshake: session fd, -1 if the handler refused
+esp_err_t host_httpd_ws_receive(int fd, const char *uri, const uint8_t *data, size_t len);
+int host_httpd_ws_complete(int fd);             // Deliver the fd's queued frames; returns how many
+void host_httpd_close(int fd);                  // Client gone: queued frames fail, then close_fn
+
+// SPP: bytes the firmware writes to an RFCOMM handle (the simulator takes the adapter links)
+typedef void (*host_spp_write_hook_t)(uint32_t handle, const uint8_t *data, size_t len);
+void host_spp_set_write_hook(host_spp_write_hook_t hook);
@@ -0,0 +1,842 @@
+// Host stand-ins for the ESP-IDF drivers and services the firmware links
+// against. Radios and power management accept every call; logging, NVS,
+// GPIO, ADC, PCNT and the HTTP server keep enough state for tests to drive
+// and observe them.
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_pm.h"
+#include "esp_task_wdt.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "esp_http_server.h"
+#include "esp_bt.h"
+#include "esp_bt_main.h"
+#include "esp_gap_bt_api.h"
+#include "esp_gap_ble_api.h"
+#include "esp_gatts_api.h"
+#include "esp_gatt_common_api.h"
+#include "esp_spp_api.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "driver/gpio.h"
+#include "driver/pulse_cnt.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "host.h"
+
+// ---------------------------------------------------------------------------
+// Logging
+
+static esp_log_level_t console_level = ESP_LOG_INFO;
+static host_log_sink_t log_sink = NULL;
+
+void host_log_set_sink(host_log_sink_t sink) {
+    log_sink = sink;
+}
+
+void host_log_set_level(esp_log_level_t level) {
+    console_level = level;
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+}
+
+// vsnprintf with the target's ILP32 argument sizes: 'l' conversions take a
+// 32-bit value (the host's 64-bit slot is truncated, as long is 32 bits on
+// the ESP32), "ll" stays 64-bit
+static void format_ilp32(char *out, size_t size, const char *format, va_list args) {
+    size_t used = 0;
+    const char *p = format;
+
+    while (*p && used + 1 < size) {
+        if (*p != '%') {
+            out[used++] = *p++;
+            continue;
+        }
+        char spec[32];
+        size_t n = 0;
+        spec[n++] = *p++;
+        while (*p && strchr("-+ #0", *p) && n < sizeof(spec) - 8) {
+            spec[n++] = *p++;
+        }
+        int star_width = 0, star_precision = 0;
+        bool has_star_width = false, has_star_precision = false;
+        if (*p == '*') {
+            has_star_width = true;
+            star_width = va_arg(args, int);
+            spec[n++] = *p++;
+        }
+        while (*p >= '0' && *p <= '9' && n < sizeof(spec) - 8) {
+            spec[n++] = *p++;
+        }
+        if (*p == '.') {
+            spec[n++] = *p++;
+            if (*p == '*') {
+                has_star_precision = true;
+                star_precision = va_arg(args, int);
+                spec[n++] = *p++;
+            }
+            while (*p >= '0' && *p <= '9' && n < sizeof(spec) - 8) {
+                spec[n++] = *p++;
+            }
+        }
+        int longs = 0;
+        bool half = false, size_mod = false;
+        while (*p == 'l' || *p == 'h' || *p == 'z') {
+            longs += *p == 'l';
+            half |= *p == 'h';
+            size_mod |= *p == 'z';
+            p++;
+        }
+        char conv = *p ? *p++ : '\0';
+        char piece[256];
+        piece[0] = '\0';
+
+        #define EMIT(value) do {                                                            \
+            if (has_star_width && has_star_precision) {                                     \
+                snprintf(piece, sizeof(piece), spec, star_width, star_precision, value);    \
+            } else if (has_star_width) {                                                    \
+                snprintf(piece, sizeof(piece), spec, star_width, value);                    \
+            } else if (has_star_precision) {                                                \
+                snprintf(piece, sizeof(piece), spec, star_precision, value);                \
+            } else {                                                                        \
+                snprintf(piece, sizeof(piece), spec, value);                                \
+            }                                                                               \
+        } while (0)
+
+        switch (conv) {
+            case 'd':
+            case 'i':
+                if (longs >= 2) {
+                    strcpy(spec + n, "lld");
+                    EMIT(va_arg(args, long long));
+                } else if (size_mod) {
+                    strcpy(spec + n, "zd");
+                    EMIT(va_arg(args, ssize_t));
+                } else {
+                    strcpy(spec + n, "d");
+                    EMIT(longs == 1 ? (int32_t)va_arg(args, long) : va_arg(args, int));
+                }
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                if (longs >= 2) {
+                    snprintf(spec + n, 4, "ll%c", conv);
+                    EMIT(va_arg(args, unsigned long long));
+                } else if (size_mod) {
+                    snprintf(spec + n, 4, "z%c", conv);
+                    EMIT(va_arg(args, size_t));
+                } else {
+                    snprintf(spec + n, 2, "%c", conv);
+                    EMIT(longs == 1 ? (uint32_t)va_arg(args, unsigned long) : va_arg(args, unsigned int));
+                }
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+                snprintf(spec + n, 2, "%c", conv);
+                EMIT(va_arg(args, double));
+                break;
+            case 'c':
+                strcpy(spec + n, "c");
+                EMIT(va_arg(args, int));
+                break;
+            case 's':
+                strcpy(spec + n, "s");
+                EMIT(va_arg(args, const char *));
+                break;
+            case 'p':
+                strcpy(spec + n, "p");
+                EMIT(va_arg(args, void *));
+                break;
+            case '%':
+                strcpy(piece, "%");
+                break;
+            default:
+                break;
+        }
+        #undef EMIT
+        (void)half;
+        int len = snprintf(out + used, size - used, "%s", piece);
+        used += len > 0 ? (size_t)len : 0;
+        if (used >= size) {
+            used = size - 1;
+        }
+    }
+    out[used] = '\0';
+}
+
+void host_log(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char letters[] = "NEWIDV";
+    char message[1024];
+    va_list args;
+
+    if (level > console_level && log_sink == NULL) {
+        return;
+    }
+    va_start(args, format);
+    format_ilp32(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (log_sink != NULL) {
+        log_sink(level, tag, message);
+    }
+    if (level <= console_level) {
+        printf("%c (%lld) %s: %s\n", letters[level], (long long)(esp_timer_get_time() / 1000), tag, message);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Errors and system
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+void host_esp_error_check_failed(esp_err_t rc, const char *file, int line, const char *expression) {
+    fflush(stdout);
+    fprintf(stderr, "ESP_ERROR_CHECK failed: %s (%s) at %s:%d\n", esp_err_to_name(rc), expression, file, line);
+    abort();
+}
+
+uint32_t esp_get_free_heap_size(void) {
+    return 200000;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    return 180000;
+}
+
+esp_err_t esp_pm_configure(const void *config) { return ESP_OK; }
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t type, int arg, const char *name, esp_pm_lock_handle_t *out) {
+    *out = (esp_pm_lock_handle_t)calloc(1, 1);
+    return ESP_OK;
+}
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle) { return ESP_OK; }
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle) { return ESP_OK; }
+
+esp_err_t esp_task_wdt_add(TaskHandle_t task) { return ESP_OK; }
+esp_err_t esp_task_wdt_reset(void) { return ESP_OK; }
+esp_err_t esp_task_wdt_add_user(const char *name, esp_task_wdt_user_handle_t *out) {
+    *out = (esp_task_wdt_user_handle_t)calloc(1, 1);
+    return ESP_OK;
+}
+esp_err_t esp_task_wdt_reset_user(esp_task_wdt_user_handle_t user) { return ESP_OK; }
+
+// ---------------------------------------------------------------------------
+// Radios and network: accepted, nothing happens
+
+esp_event_base_t WIFI_EVENT = "WIFI_EVENT";
+
+esp_err_t esp_event_loop_create_default(void) { return ESP_OK; }
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler, void *arg) {
+    return ESP_OK;
+}
+esp_err_t esp_netif_init(void) { return ESP_OK; }
+esp_netif_t *esp_netif_create_default_wifi_ap(void) { return NULL; }
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) { return ESP_OK; }
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) { return ESP_OK; }
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *config) { return ESP_OK; }
+esp_err_t esp_wifi_start(void) { return ESP_OK; }
+
+// HTTP server: handlers are kept so tests can open WebSocket sessions on
+// real descriptors (/dev/null), and async sends queue until the test
+// completes them, which is when the client sees the frame
+#define HOST_HTTPD_MAX_URIS     8
+#define HOST_HTTPD_MAX_PENDING  16
+
+typedef struct {
+    int fd;                         // -1 = free
+    httpd_ws_frame_t frame;
+    transfer_complete_cb cb;
+    void *arg;
+} host_ws_send_t;
+
+// Per-request session state behind req->aux
+typedef struct {
+    int fd;
+    const uint8_t *data;            // Incoming frame, NULL on the handshake
+    size_t len;
+    size_t offset;
+} host_ws_session_t;
+
+static httpd_uri_t httpd_uris[HOST_HTTPD_MAX_URIS];
+static int httpd_uri_count = 0;
+static httpd_config_t httpd_config;
+static httpd_handle_t httpd_server = NULL;
+static host_ws_send_t ws_pending[HOST_HTTPD_MAX_PENDING];
+static host_ws_frame_hook_t ws_hook = NULL;
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config) {
+    httpd_config = *config;
+    httpd_server = (httpd_handle_t)calloc(1, 1);
+    for (int i = 0; i < HOST_HTTPD_MAX_PENDING; i++) {
+        ws_pending[i].fd = -1;
+    }
+    *handle = httpd_server;
+    return ESP_OK;
+}
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri) {
+    if (httpd_uri_count >= HOST_HTTPD_MAX_URIS) {
+        return ESP_ERR_NO_MEM;
+    }
+    httpd_uris[httpd_uri_count++] = *uri;
+    return ESP_OK;
+}
+esp_err_t httpd_resp_set_type(httpd_req_t *req, const char *type) { return ESP_OK; }
+esp_err_t httpd_resp_send(httpd_req_t *req, const char *buf, ssize_t len) { return ESP_OK; }
+int httpd_req_to_sockfd(httpd_req_t *req) {
+    return req->aux != NULL ? ((host_ws_session_t *)req->aux)->fd : -1;
+}
+
+// Frame from host_httpd_ws_receive: max_len 0 reports the length, then the
+// payload is copied in pieces like the real server
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *frame, size_t max_len) {
+    host_ws_session_t *in = (host_ws_session_t *)req->aux;
+    if (in->data == NULL) {
+        frame->len = 0;
+        return ESP_OK;
+    }
+    frame->type = HTTPD_WS_TYPE_BINARY;
+    frame->final = true;
+    if (max_len == 0) {
+        frame->len = in->len;
+        return ESP_OK;
+    }
+    size_t len = in->len - in->offset < max_len ? in->len - in->offset : max_len;
+    memcpy(frame->payload, in->data + in->offset, len);
+    in->offset += len;
+    frame->len = len;
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_send_data_async(httpd_handle_t handle, int fd, httpd_ws_frame_t *frame,
+                                   transfer_complete_cb cb, void *arg) {
+    if (handle == NULL || handle != httpd_server) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < HOST_HTTPD_MAX_PENDING; i++) {
+        if (ws_pending[i].fd < 0) {
+            ws_pending[i].fd = fd;
+            ws_pending[i].frame = *frame;
+            ws_pending[i].cb = cb;
+            ws_pending[i].arg = arg;
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+static const httpd_uri_t *find_ws_uri(const char *uri) {
+    for (int i = 0; i < httpd_uri_count; i++) {
+        if (httpd_uris[i].is_websocket && strcmp(httpd_uris[i].uri, uri) == 0) {
+            return &httpd_uris[i];
+        }
+    }
+    return NULL;
+}
+
+// One request on the session
+static esp_err_t call_ws_handler(const httpd_uri_t *uri, int fd, int method, const uint8_t *data, size_t len) {
+    host_ws_session_t session = { fd, data, len, 0 };
+    httpd_req_t *req = calloc(1, sizeof(httpd_req_t));
+    req->handle = httpd_server;
+    req->method = method;
+    strncpy((char *)req->uri, uri->uri, sizeof(req->uri) - 1);
+    req->aux = &session;
+    esp_err_t ret = uri->handler(req);
+    free(req);
+    return ret;
+}
+
+// Send results in queue order; frames still queued for a closed fd fail
+static int complete_sends(int fd, esp_err_t result) {
+    int completed = 0;
+    for (int i = 0; i < HOST_HTTPD_MAX_PENDING; i++) {
+        if (ws_pending[i].fd != fd) {
+            continue;
+        }
+        host_ws_send_t send = ws_pending[i];
+        ws_pending[i].fd = -1;
+        if (result == ESP_OK && ws_hook != NULL) {
+            ws_hook(fd, send.frame.payload, send.frame.len);
+        }
+        if (send.cb != NULL) {
+            send.cb(result, fd, send.arg);
+        }
+        completed++;
+    }
+    return completed;
+}
+
+void host_httpd_close(int fd) {
+    complete_sends(fd, ESP_FAIL);
+    if (httpd_config.close_fn != NULL) {
+        httpd_config.close_fn(httpd_server, fd);
+    } else {
+        close(fd);
+    }
+}
+
+int host_httpd_ws_open(const char *uri) {
+    const httpd_uri_t *handler = find_ws_uri(uri);
+    if (httpd_server == NULL || handler == NULL) {
+        return -1;
+    }
+    int fd = open("/dev/null", O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (call_ws_handler(handler, fd, HTTP_GET, NULL, 0) != ESP_OK) {
+        host_httpd_close(fd);   // Refused handshake: the server drops the session
+        return -1;
+    }
+    return fd;
+}
+
+esp_err_t host_httpd_ws_receive(int fd, const char *uri, const uint8_t *data, size_t len) {
+    const httpd_uri_t *handler = find_ws_uri(uri);
+    return handler != NULL ? call_ws_handler(handler, fd, 0, data, len) : ESP_ERR_NOT_FOUND;
+}
+
+int host_httpd_ws_complete(int fd) {
+    return complete_sends(fd, ESP_OK);
+}
+
+void host_httpd_set_ws_hook(host_ws_frame_hook_t hook) {
+    ws_hook = hook;
+}
+
+esp_err_t esp_bt_controller_mem_release(esp_bt_mode_t mode) { return ESP_OK; }
+esp_err_t esp_bt_controller_init(esp_bt_controller_config_t *config) { return ESP_OK; }
+esp_err_t esp_bt_controller_enable(esp_bt_mode_t mode) { return ESP_OK; }
+esp_err_t esp_bt_controller_disable(void) { return ESP_OK; }
+esp_err_t esp_bt_sleep_enable(void) { return ESP_OK; }
+esp_err_t esp_bt_sleep_disable(void) { return ESP_OK; }
+esp_err_t esp_bluedroid_init(void) { return ESP_OK; }
+esp_err_t esp_bluedroid_enable(void) { return ESP_OK; }
+esp_err_t esp_bluedroid_disable(void) { return ESP_OK; }
+esp_err_t esp_bt_gap_register_callback(esp_bt_gap_cb_t callback) { return ESP_OK; }
+esp_err_t esp_bt_gap_start_discovery(esp_bt_inq_mode_t mode, uint8_t length, uint8_t responses) { return ESP_OK; }
+esp_err_t esp_bt_gap_cancel_discovery(void) { return ESP_OK; }
+esp_err_t esp_bt_gap_set_qos(esp_bd_addr_t bda, uint32_t t_poll) { return ESP_OK; }
+esp_err_t esp_bt_gap_set_scan_mode(esp_bt_connection_mode_t c, esp_bt_discovery_mode_t d) { return ESP_OK; }
+esp_err_t esp_bt_gap_set_device_name(const char *name) { return ESP_OK; }
+esp_err_t esp_bt_gap_set_pin(esp_bt_pin_type_t type, uint8_t len, esp_bt_pin_code_t pin) { return ESP_OK; }
+esp_err_t esp_bt_gap_set_security_param(esp_bt_sp_param_t param, void *value, uint8_t len) { return ESP_OK; }
+esp_err_t esp_spp_init(esp_spp_mode_t mode) { return ESP_OK; }
+esp_err_t esp_spp_deinit(void) { return ESP_OK; }
+esp_err_t esp_spp_register_callback(esp_spp_cb_t *callback) { return ESP_OK; }
+esp_err_t esp_spp_connect(int sec_mask, esp_spp_role_t role, uint8_t scn, esp_bd_addr_t bda) { return ESP_OK; }
+esp_err_t esp_spp_disconnect(uint32_t handle) { return ESP_OK; }
+esp_err_t esp_spp_start_srv(int sec_mask, esp_spp_role_t role, uint8_t scn, const char *name) { return ESP_OK; }
+
+static host_spp_write_hook_t spp_write_hook = NULL;
+
+void host_spp_set_write_hook(host_spp_write_hook_t hook) {
+    spp_write_hook = hook;
+}
+
+esp_err_t esp_spp_write(uint32_t handle, int len, uint8_t *data) {
+    if (spp_write_hook != NULL) {
+        spp_write_hook(handle, data, (size_t)len);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_register_callback(esp_gap_ble_cb_t callback) { return ESP_OK; }
+esp_err_t esp_ble_gap_config_adv_data_raw(uint8_t *data, uint32_t len) { return ESP_OK; }
+esp_err_t esp_ble_gap_config_scan_rsp_data_raw(uint8_t *data, uint32_t len) { return ESP_OK; }
+esp_err_t esp_ble_gap_start_advertising(esp_ble_adv_params_t *params) { return ESP_OK; }
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t *params) { return ESP_OK; }
+esp_err_t esp_ble_gatt_set_local_mtu(uint16_t mtu) { return ESP_OK; }
+esp_err_t esp_ble_gatts_register_callback(esp_gatts_cb_t callback) { return ESP_OK; }
+esp_err_t esp_ble_gatts_app_register(uint16_t app_id) { return ESP_OK; }
+esp_err_t esp_ble_gatts_create_attr_tab(const esp_gatts_attr_db_t *db, esp_gatt_if_t gatts_if, uint16_t n, uint8_t id) {
+    return ESP_OK;
+}
+esp_err_t esp_ble_gatts_start_service(uint16_t handle) { return ESP_OK; }
+esp_err_t esp_ble_gatts_send_indicate(esp_gatt_if_t gatts_if, uint16_t conn_id, uint16_t handle,
+                                      uint16_t len, uint8_t *value, bool confirm) {
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// NVS: one flat in-memory store (namespace and key joined)
+
+#define NVS_MAX_ENTRIES 64
+
+typedef struct {
+    char key[32];
+    size_t len;
+    uint8_t *data;
+} nvs_entry_t;
+
+static nvs_entry_t nvs_entries[NVS_MAX_ENTRIES];
+static char nvs_namespaces[8][16];
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+
+esp_err_t nvs_flash_erase(void) {
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        free(nvs_entries[i].data);
+        memset(&nvs_entries[i], 0, sizeof(nvs_entries[i]));
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *out) {
+    for (int i = 0; i < 8; i++) {
+        if (nvs_namespaces[i][0] == '\0' || strcmp(nvs_namespaces[i], name) == 0) {
+            snprintf(nvs_namespaces[i], sizeof(nvs_namespaces[i]), "%s", name);
+            *out = (nvs_handle_t)i + 1;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle) {}
+esp_err_t nvs_commit(nvs_handle_t handle) { return ESP_OK; }
+
+static nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key, bool create) {
+    char full[32];
+    snprintf(full, sizeof(full), "%u/%s", (unsigned)handle, key);
+    nvs_entry_t *free_slot = NULL;
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        if (strcmp(nvs_entries[i].key, full) == 0) {
+            return &nvs_entries[i];
+        }
+        if (free_slot == NULL && nvs_entries[i].key[0] == '\0') {
+            free_slot = &nvs_entries[i];
+        }
+    }
+    if (create && free_slot != NULL) {
+        snprintf(free_slot->key, sizeof(free_slot->key), "%s", full);
+        return free_slot;
+    }
+    return NULL;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t len) {
+    nvs_entry_t *e = nvs_find(handle, key, true);
+    if (e == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    free(e->data);
+    e->data = malloc(len > 0 ? len : 1);
+    memcpy(e->data, value, len);
+    e->len = len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *len) {
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out == NULL) {
+        *len = e->len;
+        return ESP_OK;
+    }
+    if (*len < e->len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(out, e->data, e->len);
+    *len = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) {
+    return nvs_set_blob(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out) {
+    size_t len = sizeof(*out);
+    return nvs_get_blob(handle, key, out, &len);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value) {
+    return nvs_set_blob(handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out) {
+    size_t len = sizeof(*out);
+    return nvs_get_blob(handle, key, out, &len);
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value) {
+    return nvs_set_blob(handle, key, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out, size_t *len) {
+    return nvs_get_blob(handle, key, out, len);
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    nvs_entry_t *e = nvs_find(handle, key, false);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    free(e->data);
+    memset(e, 0, sizeof(*e));
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// GPIO: inputs read the driven level (pull-ups read high), outputs record edges
+
+#define GPIO_COUNT 40
+
+static int input_level[GPIO_COUNT];
+static bool input_driven[GPIO_COUNT];
+static bool input_pull_up[GPIO_COUNT];
+static int output_level[GPIO_COUNT];
+static host_gpio_edge_hook_t edge_hook = NULL;
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    for (int pin = 0; pin < GPIO_COUNT; pin++) {
+        if (config->pin_bit_mask & (1ULL << pin)) {
+            input_pull_up[pin] = config->pull_up_en == GPIO_PULLUP_ENABLE;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+    if (pin < 0 || pin >= GPIO_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int new_level = level ? 1 : 0;
+    if (output_level[pin] != new_level) {
+        output_level[pin] = new_level;
+        if (edge_hook != NULL) {
+            edge_hook(pin, new_level, esp_timer_get_time());
+        }
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin) {
+    if (pin < 0 || pin >= GPIO_COUNT) {
+        return 0;
+    }
+    if (input_driven[pin]) {
+        return input_level[pin];
+    }
+    return input_pull_up[pin] ? 1 : 0;
+}
+
+void host_gpio_set_edge_hook(host_gpio_edge_hook_t hook) {
+    edge_hook = hook;
+}
+
+void host_gpio_drive(int pin, int level) {
+    if (pin >= 0 && pin < GPIO_COUNT) {
+        input_driven[pin] = true;
+        input_level[pin] = level ? 1 : 0;
+    }
+}
+
+int host_gpio_output_level(int pin) {
+    return pin >= 0 && pin < GPIO_COUNT ? output_level[pin] : 0;
+}
+
+// ---------------------------------------------------------------------------
+// PCNT: units count whatever host_pcnt_pulses() feeds their channel's GPIO
+
+#define PCNT_UNITS 4
+
+struct pcnt_unit_t {
+    int gpio;
+    int count;
+};
+
+struct pcnt_chan_t {
+    struct pcnt_unit_t *unit;
+};
+
+static struct pcnt_unit_t pcnt_units[PCNT_UNITS];
+static int pcnt_unit_count = 0;
+
+esp_err_t pcnt_new_unit(const pcnt_unit_config_t *config, pcnt_unit_handle_t *out) {
+    if (pcnt_unit_count >= PCNT_UNITS) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *out = &pcnt_units[pcnt_unit_count++];
+    (*out)->gpio = -1;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_set_glitch_filter(pcnt_unit_handle_t unit, const pcnt_glitch_filter_config_t *config) {
+    return ESP_OK;
+}
+
+esp_err_t pcnt_new_channel(pcnt_unit_handle_t unit, const pcnt_chan_config_t *config, pcnt_channel_handle_t *out) {
+    struct pcnt_chan_t *chan = calloc(1, sizeof(*chan));
+    chan->unit = unit;
+    unit->gpio = config->edge_gpio_num;
+    *out = chan;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_channel_set_edge_action(pcnt_channel_handle_t chan, pcnt_channel_edge_action_t pos,
+                                       pcnt_channel_edge_action_t neg) {
+    return ESP_OK;
+}
+
+esp_err_t pcnt_unit_add_watch_point(pcnt_unit_handle_t unit, int value) { return ESP_OK; }
+esp_err_t pcnt_unit_enable(pcnt_unit_handle_t unit) { return ESP_OK; }
+esp_err_t pcnt_unit_start(pcnt_unit_handle_t unit) { return ESP_OK; }
+
+esp_err_t pcnt_unit_clear_count(pcnt_unit_handle_t unit) {
+    unit->count = 0;
+    return ESP_OK;
+}
+
+// accum_count semantics: the count keeps growing past the hardware limit
+esp_err_t pcnt_unit_get_count(pcnt_unit_handle_t unit, int *out) {
+    *out = unit->count;
+    return ESP_OK;
+}
+
+void host_pcnt_pulses(int gpio, int edges) {
+    for (int i = 0; i < pcnt_unit_count; i++) {
+        if (pcnt_units[i].gpio == gpio) {
+            pcnt_units[i].count += edges;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ADC continuous mode: a periodic timer completes one DMA frame per frame
+// period, filled round-robin over the configured pattern
+
+#define ADC_CHANNELS 10
+
+struct adc_continuous_ctx_t {
+    uint32_t frame_bytes;
+    uint32_t sample_freq_hz;
+    uint32_t pattern_num;
+    uint8_t pattern[ADC_CHANNELS];
+    adc_continuous_evt_cbs_t callbacks;
+    void *user_data;
+    uint32_t frames_ready;
+    uint32_t frames_max;
+    esp_timer_handle_t timer;
+};
+
+static uint16_t adc_raw[ADC_CHANNELS];
+
+void host_adc_set_raw(int channel, uint16_t raw) {
+    if (channel >= 0 && channel < ADC_CHANNELS) {
+        adc_raw[channel] = raw;
+    }
+}
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *config, adc_continuous_handle_t *out) {
+    struct adc_continuous_ctx_t *ctx = calloc(1, sizeof(*ctx));
+    ctx->frame_bytes = config->conv_frame_size;
+    ctx->frames_max = config->max_store_buf_size / config->conv_frame_size;
+    *out = ctx;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config) {
+    handle->sample_freq_hz = config->sample_freq_hz;
+    handle->pattern_num = config->pattern_num < ADC_CHANNELS ? config->pattern_num : ADC_CHANNELS;
+    for (uint32_t i = 0; i < handle->pattern_num; i++) {
+        handle->pattern[i] = config->adc_pattern[i].channel;
+    }
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle,
+                                                  const adc_continuous_evt_cbs_t *callbacks, void *user_data) {
+    handle->callbacks = *callbacks;
+    handle->user_data = user_data;
+    return ESP_OK;
+}
+
+static void adc_frame_done(void *arg) {
+    adc_continuous_handle_t handle = arg;
+    if (handle->frames_ready < handle->frames_max) {
+        handle->frames_ready++;
+    }
+    if (handle->callbacks.on_conv_done != NULL) {
+        adc_continuous_evt_data_t data = { .conv_frame_buffer = NULL, .size = handle->frame_bytes };
+        handle->callbacks.on_conv_done(handle, &data, handle->user_data);
+    }
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle) {
+    uint32_t results = handle->frame_bytes / SOC_ADC_DIGI_RESULT_BYTES;
+    const esp_timer_create_args_t args = { .callback = adc_frame_done, .arg = handle, .name = "adc_dma" };
+    esp_err_t ret = handle->timer != NULL ? ESP_OK : esp_timer_create(&args, &handle->timer);
+    if (ret == ESP_OK) {
+        ret = esp_timer_start_periodic(handle->timer, (uint64_t)results * 1000000 / handle->sample_freq_hz);
+    }
+    return ret;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle) {
+    esp_timer_stop(handle->timer);
+    handle->frames_ready = 0;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t max_len,
+                              uint32_t *out_len, uint32_t timeout_ms) {
+    if (handle->frames_ready == 0) {
+        *out_len = 0;
+        return ESP_ERR_TIMEOUT;
+    }
+    handle->frames_ready--;
+    uint32_t len = max_len < handle->frame_bytes ? max_len : handle->frame_bytes;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        adc_digi_output_data_t *p = (adc_digi_output_data_t *)&buf[i];
+        uint8_t channel = handle->pattern_num > 0 ? handle->pattern[(i / SOC_ADC_DIGI_RESULT_BYTES) % handle->pattern_num] : 0;
+        p->val = 0;
+        p->type1.channel = channel;
+        p->type1.data = adc_raw[channel];
+    }
+    *out_len = len;
+    return ESP_OK;
+}
+
+// No eFuse calibration on the host: the firmware's uncalibrated path runs
+esp_err_t adc_cali_create_scheme_line_fitting(const adc_cali_line_fitting_config_t *config, adc_cali_handle_t *out) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *mv) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,675 @@
+// Deterministic virtual-time stand-in for the FreeRTOS and esp_timer APIs.
+//
+// Every task is a pthread, but only the task holding `current` executes; the
+// others wait on their own condition variable. Switches happen only inside
+// API calls (block, yield, or waking a higher-priority task), which is where
+// FreeRTOS would preempt on a single core. When no task is ready the clock
+// jumps to the earliest deadline, so simulated minutes take host milliseconds
+// and every run with the same inputs is identical.
+//
+// This is API-compatible, not the FreeRTOS POSIX port: that port ticks from a
+// wall-clock itimer and cannot skip idle time.
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "host.h"
+
+#define TICK_US                 (1000000 / configTICK_RATE_HZ)
+#define NEVER                   INT64_MAX
+#define LIVELOCK_SWITCHES       1000000     // Switches without the clock moving = spinning task
+#define ESP_TIMER_TASK_PRIO     22          // ESP-IDF default
+#define MAX_END_HOOKS           8
+
+typedef enum {
+    TASK_READY = 0,
+    TASK_BLOCKED,
+    TASK_DELETED
+} task_state_t;
+
+struct tskTaskControlBlock {
+    pthread_t thread;
+    pthread_cond_t run;             // Signalled when this task becomes current
+    char name[configMAX_TASK_NAME_LEN];
+    TaskFunction_t fn;
+    void *arg;
+    UBaseType_t priority;
+    uint32_t stack_depth;
+    task_state_t state;
+    uint64_t order;                 // FIFO position among equal priorities
+    int64_t wake_us;                // Blocked: timeout deadline
+    const void *wait_obj;           // Blocked on this object (NULL = delay)
+    bool woken;                     // Unblocked by the object, not the timeout
+    uint32_t notify_value;
+    struct tskTaskControlBlock *next;
+};
+
+struct QueueDefinition {
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    uint8_t *items;
+};
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t period_us;              // 0 = one-shot
+    int64_t next_us;                // NEVER = stopped
+    struct esp_timer *next;
+};
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static struct tskTaskControlBlock *tasks = NULL;   // Creation order (deleted ones stay for stale handles)
+static struct tskTaskControlBlock *current = NULL;
+static struct esp_timer *timers = NULL;
+static TaskHandle_t timer_task = NULL;
+static int64_t now_us = 0;
+static int64_t end_us = NEVER;
+static uint64_t order_counter = 0;
+static uint64_t switches_since_advance = 0;
+static bool running = false;
+static bool failed = false;
+static host_hook_t end_hooks[MAX_END_HOOKS];
+static int end_hook_count = 0;
+
+static void fatal(const char *format, ...) {
+    va_list args;
+    fflush(stdout);
+    fprintf(stderr, "HOST: ");
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, " (t=%lld us)\n", (long long)now_us);
+    _exit(2);
+}
+
+// Scenario over: report and leave (other task threads are parked on their conditions)
+static void finish(void) {
+    for (int i = 0; i < end_hook_count; i++) {
+        end_hooks[i]();
+    }
+    fflush(stdout);
+    exit(failed ? 1 : 0);
+}
+
+static TickType_t ticks_now(void) {
+    return (TickType_t)(now_us / TICK_US);
+}
+
+static int64_t deadline_after(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        return NEVER;
+    }
+    return ((int64_t)ticks_now() + ticks) * TICK_US;
+}
+
+static struct tskTaskControlBlock *pick_next(void) {
+    struct tskTaskControlBlock *best = NULL;
+    for (struct tskTaskControlBlock *t = tasks; t != NULL; t = t->next) {
+        if (t->state == TASK_READY &&
+            (best == NULL || t->priority > best->priority ||
+             (t->priority == best->priority && t->order < best->order))) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+static void make_ready(struct tskTaskControlBlock *t, bool by_object) {
+    t->state = TASK_READY;
+    t->wait_obj = NULL;
+    t->wake_us = NEVER;
+    t->woken = by_object;
+    t->order = ++order_counter;
+}
+
+// Nothing ready: jump to the earliest deadline and release what expires there
+static void advance_clock(void) {
+    int64_t next = NEVER;
+    for (struct tskTaskControlBlock *t = tasks; t != NULL; t = t->next) {
+        if (t->state == TASK_BLOCKED && t->wake_us < next) {
+            next = t->wake_us;
+        }
+    }
+    if (next == NEVER || next >= end_us) {
+        if (end_us != NEVER) {
+            now_us = end_us;
+        }
+        finish();
+    }
+    if (next > now_us) {
+        now_us = next;
+    }
+    switches_since_advance = 0;
+    for (struct tskTaskControlBlock *t = tasks; t != NULL; t = t->next) {
+        if (t->state == TASK_BLOCKED && t->wake_us <= now_us) {
+            make_ready(t, false);
+        }
+    }
+}
+
+// Hand the CPU to the best ready task; returns once `self` runs again.
+// Called with the lock held by the current task after it changed its own state.
+static void reschedule(struct tskTaskControlBlock *self) {
+    struct tskTaskControlBlock *next;
+    while ((next = pick_next()) == NULL) {
+        advance_clock();
+    }
+    if (++switches_since_advance > LIVELOCK_SWITCHES) {
+        fatal("livelock: '%s' keeps running while the clock stands still", next->name);
+    }
+    if (next == self) {
+        return;
+    }
+    current = next;
+    pthread_cond_signal(&next->run);
+    if (self->state == TASK_DELETED) {
+        return;
+    }
+    while (current != self) {
+        pthread_cond_wait(&self->run, &lock);
+    }
+}
+
+// A higher-priority task became ready: switch now, like the kernel would
+static void preempt_if_needed(void) {
+    if (!running || current == NULL) {
+        return;
+    }
+    struct tskTaskControlBlock *next = pick_next();
+    if (next != NULL && next->priority > current->priority) {
+        reschedule(current);
+    }
+}
+
+// Block the calling task; returns true if an object (not the timeout) woke it
+static bool block_on(const void *obj, int64_t wake_us) {
+    struct tskTaskControlBlock *self = current;
+    if (!running || self == NULL) {
+        return false;   // Scheduler not running: nothing could ever give the object
+    }
+    self->state = TASK_BLOCKED;
+    self->wait_obj = obj;
+    self->wake_us = wake_us;
+    self->woken = false;
+    self->order = ++order_counter;
+    reschedule(self);
+    return self->woken;
+}
+
+// Wake the highest-priority task blocked on obj; true if one was woken
+static bool wake_one(const void *obj) {
+    struct tskTaskControlBlock *best = NULL;
+    for (struct tskTaskControlBlock *t = tasks; t != NULL; t = t->next) {
+        if (t->state == TASK_BLOCKED && t->wait_obj == obj &&
+            (best == NULL || t->priority > best->priority ||
+             (t->priority == best->priority && t->order < best->order))) {
+            best = t;
+        }
+    }
+    if (best == NULL) {
+        return false;
+    }
+    make_ready(best, true);
+    return true;
+}
+
+static void *task_entry(void *pv) {
+    struct tskTaskControlBlock *self = pv;
+    pthread_mutex_lock(&lock);
+    while (current != self) {
+        pthread_cond_wait(&self->run, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+    self->fn(self->arg);
+    fatal("task '%s' returned without vTaskDelete", self->name);
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Tasks
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *created) {
+    struct tskTaskControlBlock *t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return pdFAIL;
+    }
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    t->fn = fn;
+    t->arg = arg;
+    t->priority = priority < configMAX_PRIORITIES ? priority : configMAX_PRIORITIES - 1;
+    t->stack_depth = stack_depth;
+    pthread_cond_init(&t->run, NULL);
+
+    pthread_mutex_lock(&lock);
+    make_ready(t, false);
+    struct tskTaskControlBlock **tail = &tasks;
+    while (*tail != NULL) {
+        tail = &(*tail)->next;
+    }
+    *tail = t;
+    if (created != NULL) {
+        *created = t;
+    }
+    if (pthread_create(&t->thread, NULL, task_entry, t) != 0) {
+        fatal("cannot start a thread for task '%s'", name);
+    }
+    pthread_detach(t->thread);
+    preempt_if_needed();
+    pthread_mutex_unlock(&lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core) {
+    return xTaskCreate(fn, name, stack_depth, arg, priority, created);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    pthread_mutex_lock(&lock);
+    struct tskTaskControlBlock *t = task != NULL ? task : current;
+    if (t == NULL) {
+        pthread_mutex_unlock(&lock);
+        return;
+    }
+    t->state = TASK_DELETED;
+    if (t != current) {
+        pthread_mutex_unlock(&lock);   // Parked thread stays parked
+        return;
+    }
+    reschedule(t);
+    pthread_mutex_unlock(&lock);
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    pthread_mutex_lock(&lock);
+    if (!running || current == NULL) {
+        pthread_mutex_unlock(&lock);
+        host_advance_us((int64_t)ticks * TICK_US);
+        return;
+    }
+    if (ticks == 0) {
+        current->order = ++order_counter;   // Yield to equal priorities
+        reschedule(current);
+    } else {
+        block_on(NULL, deadline_after(ticks));
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake, TickType_t increment) {
+    TickType_t wake = *previous_wake + increment;
+    TickType_t now = xTaskGetTickCount();
+    *previous_wake = wake;
+    // Deadline already passed: no block, like the kernel
+    vTaskDelay((int32_t)(wake - now) > 0 ? wake - now : 0);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return ticks_now();
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return ticks_now();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return current;
+}
+
+const char *pcTaskGetName(TaskHandle_t task) {
+    struct tskTaskControlBlock *t = task != NULL ? task : current;
+    return t != NULL ? t->name : "main";
+}
+
+eTaskState eTaskGetState(TaskHandle_t task) {
+    if (task == NULL) {
+        return eInvalid;
+    }
+    if (task == current) {
+        return eRunning;
+    }
+    switch (task->state) {
+        case TASK_READY: return eReady;
+        case TASK_BLOCKED: return eBlocked;
+        default: return eDeleted;
+    }
+}
+
+// No real stack to measure: report half the requested depth as headroom
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    struct tskTaskControlBlock *t = task != NULL ? task : current;
+    return t != NULL ? t->stack_depth / 2 : 0;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void) {
+    UBaseType_t n = 0;
+    for (struct tskTaskControlBlock *t = tasks; t != NULL; t = t->next) {
+        n += t->state != TASK_DELETED;
+    }
+    return n;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&lock);
+    task->notify_value++;
+    if (task->state == TASK_BLOCKED && task->wait_obj == &task->notify_value) {
+        make_ready(task, true);
+        preempt_if_needed();
+    }
+    pthread_mutex_unlock(&lock);
+    return pdPASS;
+}
+
+// Runs in the esp_timer task (stand-in for ISR context): wake only, no switch
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_woken) {
+    pthread_mutex_lock(&lock);
+    task->notify_value++;
+    if (task->state == TASK_BLOCKED && task->wait_obj == &task->notify_value) {
+        make_ready(task, true);
+        if (higher_priority_woken != NULL && current != NULL && task->priority > current->priority) {
+            *higher_priority_woken = pdTRUE;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    pthread_mutex_lock(&lock);
+    struct tskTaskControlBlock *self = current;
+    if (self == NULL) {
+        pthread_mutex_unlock(&lock);
+        return 0;
+    }
+    if (self->notify_value == 0 && ticks > 0) {
+        block_on(&self->notify_value, deadline_after(ticks));
+    }
+    uint32_t value = self->notify_value;
+    if (value > 0) {
+        self->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&lock);
+    return value;
+}
+
+// ---------------------------------------------------------------------------
+// Queues and binary semaphores (a semaphore is a queue of one zero-size item)
+
+#define SEND_WAITERS(q) ((const void *)((const char *)(q) + 1))
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct QueueDefinition *q = calloc(1, sizeof(*q));
+    if (q == NULL) {
+        return NULL;
+    }
+    q->length = length;
+    q->item_size = item_size;
+    q->items = calloc(length, item_size > 0 ? item_size : 1);
+    return q;
+}
+
+static BaseType_t queue_send(QueueHandle_t q, const void *item, TickType_t ticks, bool from_isr,
+                             BaseType_t *higher_priority_woken) {
+    int64_t deadline = deadline_after(ticks);
+    while (q->count >= q->length) {
+        if (ticks == 0 || from_isr || !block_on(SEND_WAITERS(q), deadline)) {
+            if (q->count >= q->length) {
+                return errQUEUE_FULL;
+            }
+        }
+    }
+    if (q->item_size > 0 && item != NULL) {
+        memcpy(q->items + ((q->head + q->count) % q->length) * q->item_size, item, q->item_size);
+    }
+    q->count++;
+    if (wake_one(q)) {
+        if (from_isr) {
+            if (higher_priority_woken != NULL) {
+                *higher_priority_woken = pdTRUE;
+            }
+        } else {
+            preempt_if_needed();
+        }
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+    pthread_mutex_lock(&lock);
+    BaseType_t ret = queue_send(q, item, ticks, false, NULL);
+    pthread_mutex_unlock(&lock);
+    return ret;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *higher_priority_woken) {
+    pthread_mutex_lock(&lock);
+    BaseType_t ret = queue_send(q, item, 0, true, higher_priority_woken);
+    pthread_mutex_unlock(&lock);
+    return ret;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+    pthread_mutex_lock(&lock);
+    int64_t deadline = deadline_after(ticks);
+    while (q->count == 0) {
+        if (ticks == 0 || !block_on(q, deadline)) {
+            if (q->count == 0) {
+                pthread_mutex_unlock(&lock);
+                return pdFALSE;
+            }
+        }
+    }
+    if (q->item_size > 0 && item != NULL) {
+        memcpy(item, q->items + q->head * q->item_size, q->item_size);
+    }
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    if (wake_one(SEND_WAITERS(q))) {
+        preempt_if_needed();
+    }
+    pthread_mutex_unlock(&lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    return q->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    pthread_mutex_lock(&lock);
+    q->count = 0;
+    q->head = 0;
+    pthread_mutex_unlock(&lock);
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return xQueueCreate(1, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    return xQueueReceive(semaphore, NULL, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return xQueueSend(semaphore, NULL, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_woken) {
+    return xQueueSendFromISR(semaphore, NULL, higher_priority_woken);
+}
+
+// ---------------------------------------------------------------------------
+// esp_timer: callbacks run in a high-priority task, as with ESP_TIMER_TASK
+
+static struct esp_timer *earliest_timer(void) {
+    struct esp_timer *best = NULL;
+    for (struct esp_timer *t = timers; t != NULL; t = t->next) {
+        if (t->next_us != NEVER && (best == NULL || t->next_us < best->next_us)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+// Returns the timer to fire now (rearmed or stopped), or NULL
+static struct esp_timer *take_due_timer(void) {
+    struct esp_timer *t = earliest_timer();
+    if (t == NULL || t->next_us > now_us) {
+        return NULL;
+    }
+    t->next_us = t->period_us > 0 ? t->next_us + t->period_us : NEVER;
+    return t;
+}
+
+static void esp_timer_task(void *pv) {
+    pthread_mutex_lock(&lock);
+    while (1) {
+        struct esp_timer *due = take_due_timer();
+        if (due != NULL) {
+            pthread_mutex_unlock(&lock);
+            due->callback(due->arg);
+            pthread_mutex_lock(&lock);
+            continue;
+        }
+        struct esp_timer *next = earliest_timer();
+        block_on(&timers, next != NULL ? next->next_us : NEVER);
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+    struct esp_timer *t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    t->callback = args->callback;
+    t->arg = args->arg;
+    t->next_us = NEVER;
+
+    pthread_mutex_lock(&lock);
+    t->next = timers;
+    timers = t;
+    bool need_task = timer_task == NULL;
+    pthread_mutex_unlock(&lock);
+    if (need_task) {
+        xTaskCreate(esp_timer_task, "esp_timer", 4096, NULL, ESP_TIMER_TASK_PRIO, &timer_task);
+    }
+    *out = t;
+    return ESP_OK;
+}
+
+static esp_err_t timer_arm(esp_timer_handle_t t, uint64_t delay_us, uint64_t period_us) {
+    pthread_mutex_lock(&lock);
+    t->period_us = (int64_t)period_us;
+    t->next_us = now_us + (int64_t)delay_us;
+    if (timer_task != NULL && timer_task->state == TASK_BLOCKED && timer_task->wait_obj == &timers) {
+        timer_task->wake_us = t->next_us < timer_task->wake_us ? t->next_us : timer_task->wake_us;
+    }
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period_us) {
+    return timer_arm(t, period_us, period_us);
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us) {
+    return timer_arm(t, timeout_us, 0);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+    pthread_mutex_lock(&lock);
+    esp_err_t ret = t->next_us == NEVER ? ESP_ERR_INVALID_STATE : ESP_OK;
+    t->next_us = NEVER;
+    pthread_mutex_unlock(&lock);
+    return ret;
+}
+
+int64_t esp_timer_get_time(void) {
+    return now_us;
+}
+
+// Virtual time at 240 MHz: code runs in zero virtual time, so measured
+// cycle spans are 0 and logs stay identical between runs
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    return (esp_cpu_cycle_count_t)((uint64_t)now_us * 240);
+}
+
+// ---------------------------------------------------------------------------
+// Harness control
+
+int64_t host_now_us(void) {
+    return now_us;
+}
+
+// Single-threaded tests: time moves only here, due timer callbacks run inline
+void host_advance_us(int64_t us) {
+    int64_t target = now_us + us;
+    pthread_mutex_lock(&lock);
+    while (1) {
+        struct esp_timer *next = earliest_timer();
+        if (next == NULL || next->next_us > target) {
+            break;
+        }
+        if (next->next_us > now_us) {
+            now_us = next->next_us;
+        }
+        struct esp_timer *due = take_due_timer();
+        pthread_mutex_unlock(&lock);
+        due->callback(due->arg);
+        pthread_mutex_lock(&lock);
+    }
+    now_us = target;
+    pthread_mutex_unlock(&lock);
+}
+
+void host_rtos_at_end(host_hook_t hook) {
+    if (end_hook_count < MAX_END_HOOKS) {
+        end_hooks[end_hook_count++] = hook;
+    }
+}
+
+void host_rtos_fail(const char *format, ...) {
+    va_list args;
+    fflush(stdout);
+    fprintf(stderr, "FAIL: ");
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    failed = true;
+}
+
+bool host_rtos_failed(void) {
+    return failed;
+}
+
+void host_rtos_run(int64_t run_until_us) {
+    pthread_mutex_lock(&lock);
+    end_us = run_until_us;
+    running = true;
+    struct tskTaskControlBlock *next;
+    while ((next = pick_next()) == NULL) {
+        advance_clock();
+    }
+    current = next;
+    pthread_cond_signal(&next->run);
+    // The process ends in finish(), called from whichever task blocks last
+    pthread_cond_t never = PTHREAD_COND_INITIALIZER;
+    while (1) {
+        pthread_cond_wait(&never, &lock);
+    }
+}
@@ -0,0 +1,168 @@
+// Whole firmware (app_main and every task it starts) against the simulated
+// adapter, in virtual time.
+//
+//   firmware_sim <seconds> [expected log text ...]
+//
+// Fails if the primary link (and the secondary, when enabled) never
+// initializes, no RPM sample is published, the task watchdog reports a stall,
+// or an expected text never appears in the log. With the SPP proxy a scripted
+// phone connects once and every reply must hold the text its request expects.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host.h"
+#include "elm327.h"
+#include "obd_data.h"
+#include "analog_input.h"
+#include "spp_proxy.h"
+
+#define MAX_EXPECTS 8
+
+void app_main(void);
+
+static const char *expects[MAX_EXPECTS];
+static bool expect_seen[MAX_EXPECTS];
+static int expect_count = 0;
+static uint32_t pid_samples[256];
+static bool link_was_up = false;
+static bool secondary_was_up = false;
+static uint32_t watchdog_stalls = 0;
+
+static void log_sink(esp_log_level_t level, const char *tag, const char *message) {
+    if (strcmp(tag, "WATCHDOG") == 0 && strncmp(message, "STALL ", 6) == 0) {
+        watchdog_stalls++;
+    }
+    for (int i = 0; i < expect_count; i++) {
+        if (!expect_seen[i] && strstr(message, expects[i]) != NULL) {
+            expect_seen[i] = true;
+        }
+    }
+}
+
+static void main_task(void *pv) {
+    app_main();
+    vTaskDelete(NULL);
+}
+
+// Stands in for a stream consumer (BLE/dashboard) and tracks link state
+static void observer_task(void *pv) {
+    uint32_t cursor = 0;
+    obd_sample_t sample;
+    while (1) {
+        while (obd_stream_read(&cursor, &sample)) {
+            pid_samples[sample.pid]++;
+        }
+        link_was_up |= elm327_link_is_up(ELM327_LINK_PRIMARY);
+        secondary_was_up |= elm327_link_is_up(ELM327_LINK_SECONDARY);
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+#if SPP_PROXY_ENABLED
+#define PHONE_HANDLE        0x80
+#define PHONE_START_MS      20000   // Drive under way, the poller's cache is warm
+#define PHONE_TIMEOUT_MS    2000
+
+// Phone app session: each request and a text its reply must hold
+static const struct {
+    const char *cmd;
+    const char *reply;
+} phone_script[] = {
+    { "ATZ",  "ELM327" },   // Reset: answered locally, not counted
+    { "ATE0", "OK" },       // Local
+    { "010C", "41 0C" },    // Polled PID: from the cache
+    { "0100", "41 00" },    // Forwarded
+    { "0902", "49 02" },    // Forwarded, multi-frame
+    { "04",   "?" },        // Clears codes: rejected
+    { "ATRV", "V" },        // Local
+};
+#define PHONE_STEPS (sizeof(phone_script) / sizeof(phone_script[0]))
+
+static char phone_rx[256];
+static size_t phone_rx_len = 0;
+
+static void phone_write_hook(uint32_t handle, const uint8_t *data, size_t len) {
+    if (handle != PHONE_HANDLE) {
+        return;
+    }
+    for (size_t i = 0; i < len && phone_rx_len < sizeof(phone_rx) - 1; i++) {
+        phone_rx[phone_rx_len++] = data[i] == '\r' ? '|' : (char)data[i];
+    }
+    phone_rx[phone_rx_len] = '\0';
+}
+
+static void phone_task(void *pv) {
+    char line[16];
+    
+    vTaskDelay(pdMS_TO_TICKS(PHONE_START_MS));
+    spp_proxy_on_open(PHONE_HANDLE);
+    for (size_t i = 0; i < PHONE_STEPS; i++) {
+        phone_rx_len = 0;
+        phone_rx[0] = '\0';
+        int len = snprintf(line, sizeof(line), "%s\r", phone_script[i].cmd);
+        spp_proxy_on_data((const uint8_t *)line, (uint16_t)len);
+        for (int ms = 0; ms < PHONE_TIMEOUT_MS && strchr(phone_rx, '>') == NULL; ms += portTICK_PERIOD_MS) {
+            vTaskDelay(1);
+        }
+        if (strchr(phone_rx, '>') == NULL || strstr(phone_rx, phone_script[i].reply) == NULL) {
+            host_rtos_fail("phone: %s answered '%s', want '%s'", phone_script[i].cmd, phone_rx,
+                           phone_script[i].reply);
+        }
+    }
+    spp_proxy_on_close();
+    vTaskDelete(NULL);
+}
+#endif
+
+static void report(void) {
+    printf("SIM: %lld s simulated, link %s, samples: rpm %u, throttle %u, speed %u, timing %u, coolant %u, "
+           "watchdog stalls %u\n",
+           (long long)(host_now_us() / 1000000), link_was_up ? "up" : "never up",
+           pid_samples[0x0C], pid_samples[0x11], pid_samples[0x0D], pid_samples[0x0E], pid_samples[0x05],
+           watchdog_stalls);
+    if (!link_was_up) {
+        host_rtos_fail("primary link never finished initialization");
+    }
+    if (ELM327_SECONDARY_ENABLED && !secondary_was_up) {
+        host_rtos_fail("secondary link never finished initialization");
+    }
+    if (watchdog_stalls > 0) {
+        host_rtos_fail("task watchdog reported %u stall(s)", watchdog_stalls);
+    }
+    for (int i = 0; i < expect_count; i++) {
+        if (!expect_seen[i]) {
+            host_rtos_fail("expected log text never appeared: '%s'", expects[i]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int64_t seconds = argc > 1 ? atoll(argv[1]) : 60;
+    for (int i = 2; i < argc && expect_count < MAX_EXPECTS; i++) {
+        expects[expect_count++] = argv[i];
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    host_log_set_sink(log_sink);
+
+    // The tuner console polls stdin; on target an idle UART reads EOF, here a
+    // blocking read would stop virtual time for every task
+    if (freopen("/dev/null", "r", stdin) == NULL) {
+        host_rtos_fail("cannot detach stdin");
+    }
+
+    // Interlock sensors in range: 1000 psi bottle, AFR 12.5 (uncalibrated ADC path)
+    host_adc_set_raw(ANALOG_PRESSURE_CHANNEL, 2535);
+    host_adc_set_raw(ANALOG_AFR_CHANNEL, 1001);
+
+    xTaskCreate(main_task, "main", 3584, NULL, 1, NULL);
+    xTaskCreate(observer_task, "observer", 2048, NULL, 1, NULL);
+#if SPP_PROXY_ENABLED
+    host_spp_set_write_hook(phone_write_hook);
+    xTaskCreate(phone_task, "phone", 2048, NULL, 1, NULL);
+#endif
+    host_rtos_at_end(report);
+    host_rtos_run(seconds * 1000000LL);
+    return 0;
+}
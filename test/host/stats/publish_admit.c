@@ -0,0 +1,118 @@
+// Publish policy decisions for scripted sample sequences.
+//
+//   publish_admit
+//
+// Each step feeds one sample to publish_policy_admit and states whether it
+// must reach stream consumers. Checks, in order:
+// - the first sample of a channel is always published
+// - deadband (RPM, throttle): changes up to +/- deadband around the last
+//   published value are held back, a slow drift is published once it adds
+//   up past the deadband
+// - on change (speed, coolant): repeats are held back, any change goes out
+// - heartbeat: a held-back channel publishes again PUBLISH_HEARTBEAT_MS after
+//   its last published sample, and the next heartbeat counts from there
+// - channels without a policy are always published
+// - the per-channel counts logged by publish_policy_log_stats
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+#include "publish_policy.h"
+
+typedef struct {
+    const char *what;
+    uint8_t pid;
+    int32_t value;
+    int64_t time_ms;
+    bool published;
+} step_t;
+
+static const step_t steps[] = {
+    // RPM, deadband 25
+    { "rpm first sample",                   0x0C, 3000,    0, true  },
+    { "rpm +25 (inside the deadband)",      0x0C, 3025,   10, false },
+    { "rpm -25 (inside the deadband)",      0x0C, 2975,   20, false },
+    { "rpm +26",                            0x0C, 3026,   30, true  },
+    { "rpm drift +10",                      0x0C, 3036,   40, false },
+    { "rpm drift +20",                      0x0C, 3046,   50, false },
+    { "rpm drift +30 (past the deadband)",  0x0C, 3056,   60, true  },
+    { "rpm -26",                            0x0C, 3030,   70, true  },
+
+    // Throttle, deadband 1
+    { "throttle first sample",              0x11,   40,    0, true  },
+    { "throttle +1",                        0x11,   41,   10, false },
+    { "throttle +2",                        0x11,   42,   20, true  },
+    { "throttle -1",                        0x11,   41,   30, false },
+
+    // Speed, on change
+    { "speed first sample",                 0x0D,   50,    0, true  },
+    { "speed repeat",                       0x0D,   50,   10, false },
+    { "speed +1",                           0x0D,   51,   20, true  },
+    { "speed back -1",                      0x0D,   50,   30, true  },
+    { "speed repeat",                       0x0D,   50,   40, false },
+
+    // Coolant, on change, heartbeat 1000 ms after the last publish (10 ms)
+    { "coolant first sample",               0x05,   90,   10, true  },
+    { "coolant repeat at 500 ms",           0x05,   90,  500, false },
+    { "coolant repeat at 1009 ms",          0x05,   90, 1009, false },
+    { "coolant heartbeat at 1010 ms",       0x05,   90, 1010, true  },
+    { "coolant repeat at 1500 ms",          0x05,   90, 1500, false },
+    { "coolant repeat at 2009 ms",          0x05,   90, 2009, false },
+    { "coolant heartbeat at 2010 ms",       0x05,   90, 2010, true  },
+    { "coolant change at 2100 ms",          0x05,   91, 2100, true  },
+    { "coolant repeat at 3099 ms",          0x05,   91, 3099, false },
+
+    // RPM inside the deadband until its heartbeat (last publish at 70 ms)
+    { "rpm +5 at 1069 ms",                  0x0C, 3035, 1069, false },
+    { "rpm +5 heartbeat at 1070 ms",        0x0C, 3035, 1070, true  },
+    { "rpm +25 from the heartbeat value",   0x0C, 3060, 1080, false },
+
+    // No policy: always published
+    { "intake temperature (no policy)",     0x0F,   30,    0, true  },
+    { "intake temperature repeat",          0x0F,   30,   10, true  },
+};
+#define STEP_COUNT (sizeof(steps) / sizeof(steps[0]))
+
+static int failures = 0;
+static char rpm_stats[160];
+
+static void on_log(esp_log_level_t level, const char *tag, const char *message) {
+    if (strcmp(tag, "PUBLISH") == 0 && strncmp(message, "PID 0C ", 7) == 0) {
+        snprintf(rpm_stats, sizeof(rpm_stats), "%s", message);
+    }
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    host_log_set_level(getenv("PUBLISH_VERBOSE") ? ESP_LOG_INFO : ESP_LOG_ERROR);
+    host_log_set_sink(on_log);
+    publish_policy_init();
+
+    for (size_t i = 0; i < STEP_COUNT; i++) {
+        const step_t *s = &steps[i];
+        bool published = publish_policy_admit(s->pid, s->value, s->time_ms * 1000);
+        bool ok = published == s->published;
+        printf("%-50s %-9s (want %s%s)\n", s->what, published ? "published" : "held",
+               ok ? "" : "FAILED ", s->published ? "published" : "held");
+        if (!ok) {
+            failures++;
+        }
+    }
+
+    // RPM above: 5 published (one heartbeat), 6 held back
+    const char *want = "PID 0C deadband  +/-25: 5 published (1 heartbeats), 6 suppressed (54%)";
+    publish_policy_log_stats();
+    bool ok = strcmp(rpm_stats, want) == 0;
+    printf("rpm stats '%s'%s\n", rpm_stats, ok ? "" : " FAILED");
+    if (!ok) {
+        printf("  want '%s'\n", want);
+        failures++;
+    }
+
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("Publish policy checks passed\n");
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Rolling min/max/mean against a brute-force scan, in virtual time.
+//
+//   rolling_window
+//
+// Every sample pushed is also kept in a plain history; after each push and
+// each read the statistics must equal a scan over the samples still inside
+// the window (and, once a channel is full, over its newest capacity samples).
+// Checks, in order:
+// - random values at random 1-40 ms spacing, with gaps longer than the window
+//   that must leave the channel empty
+// - each channel at its fastest publish period holds a full window without
+//   dropping anything (speed: 1000 ms of 10 ms pulse samples)
+// - pushing faster than that fills the channel: it holds its capacity and
+//   the oldest samples go first
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+#include "rolling_stats.h"
+
+#define HISTORY             4096
+
+typedef struct {
+    int64_t timestamp_us;
+    int32_t value;
+} sample_t;
+
+static sample_t history[ROLLING_CH_COUNT][HISTORY];
+static uint32_t pushed[ROLLING_CH_COUNT];
+static uint32_t seed = 12345;
+static int failures = 0;
+static int comparisons = 0;
+
+static const uint32_t window_ms[ROLLING_CH_COUNT] = {
+    [ROLLING_CH_RPM]      = ROLLING_WINDOW_RPM_MS,
+    [ROLLING_CH_THROTTLE] = ROLLING_WINDOW_THROTTLE_MS,
+    [ROLLING_CH_SPEED]    = ROLLING_WINDOW_SPEED_MS,
+};
+static const uint32_t capacity[ROLLING_CH_COUNT] = {
+    [ROLLING_CH_RPM]      = ROLLING_CAPACITY_RPM,
+    [ROLLING_CH_THROTTLE] = ROLLING_CAPACITY_THROTTLE,
+    [ROLLING_CH_SPEED]    = ROLLING_CAPACITY_SPEED,
+};
+static const uint32_t period_ms[ROLLING_CH_COUNT] = {
+    [ROLLING_CH_RPM]      = ROLLING_PERIOD_RPM_MS,
+    [ROLLING_CH_THROTTLE] = ROLLING_PERIOD_THROTTLE_MS,
+    [ROLLING_CH_SPEED]    = ROLLING_PERIOD_SPEED_MS,
+};
+static const char *names[ROLLING_CH_COUNT] = { "rpm", "throttle", "speed" };
+
+static uint32_t next_random(void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+// Scan the history for what the channel should report now
+static rolling_stats_t brute_force(rolling_channel_t ch) {
+    rolling_stats_t want = { 0 };
+    int64_t now_us = host_now_us();
+    int64_t sum = 0;
+    uint32_t first = pushed[ch] > capacity[ch] ? pushed[ch] - capacity[ch] : 0;
+    int64_t oldest_us = 0;
+    int64_t newest_us = 0;
+
+    for (uint32_t i = first; i < pushed[ch]; i++) {
+        const sample_t *s = &history[ch][i % HISTORY];
+        if (now_us - s->timestamp_us > (int64_t)window_ms[ch] * 1000) {
+            continue;
+        }
+        if (want.count == 0) {
+            want.min = want.max = s->value;
+            oldest_us = s->timestamp_us;
+        }
+        want.min = s->value < want.min ? s->value : want.min;
+        want.max = s->value > want.max ? s->value : want.max;
+        sum += s->value;
+        newest_us = s->timestamp_us;
+        want.count++;
+    }
+    if (want.count > 0) {
+        want.mean = (int32_t)(sum / want.count);
+        want.span_ms = (uint32_t)((newest_us - oldest_us) / 1000);
+    }
+    return want;
+}
+
+static void compare(rolling_channel_t ch, const char *phase) {
+    rolling_stats_t got;
+    rolling_stats_t want = brute_force(ch);
+    rolling_stats_get(ch, &got);
+    comparisons++;
+    if (got.count != want.count || (want.count > 0 &&
+        (got.min != want.min || got.max != want.max || got.mean != want.mean || got.span_ms != want.span_ms))) {
+        if (failures++ < 10) {
+            printf("%s, %s at %lld ms: got %u samples min %ld max %ld mean %ld span %lu, "
+                   "want %u min %ld max %ld mean %ld span %lu\n",
+                   phase, names[ch], (long long)(host_now_us() / 1000),
+                   got.count, (long)got.min, (long)got.max, (long)got.mean, (unsigned long)got.span_ms,
+                   want.count, (long)want.min, (long)want.max, (long)want.mean, (unsigned long)want.span_ms);
+        }
+    }
+}
+
+static void push(rolling_channel_t ch, int32_t value) {
+    history[ch][pushed[ch] % HISTORY] = (sample_t){ host_now_us(), value };
+    pushed[ch]++;
+    rolling_stats_push(ch, value);
+}
+
+static void check(bool ok, const char *what, double got, double want) {
+    printf("%-52s %8.0f (want %s%.0f)\n", what, got, ok ? "" : "FAILED ", want);
+    if (!ok) {
+        failures++;
+    }
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    host_log_set_level(getenv("ROLLING_VERBOSE") ? ESP_LOG_INFO : ESP_LOG_ERROR);
+    rolling_stats_init();
+
+    // Random spacing and values, now and then a pause longer than any window
+    for (int i = 0; i < 20000; i++) {
+        rolling_channel_t ch = (rolling_channel_t)(next_random() % ROLLING_CH_COUNT);
+        host_advance_us((int64_t)(1 + next_random() % 40) * 1000);
+        if (next_random() % 500 == 0) {
+            host_advance_us((int64_t)ROLLING_WINDOW_SPEED_MS * 1000 + 1000);
+            for (int c = 0; c < ROLLING_CH_COUNT; c++) {
+                compare((rolling_channel_t)c, "random, after a pause");
+            }
+        }
+        push(ch, (int32_t)(next_random() % 20001) - 10000);
+        compare(ch, "random");
+    }
+    check(failures == 0, "random pushes, mismatches against the scan", failures, 0);
+
+    // Each channel at its fastest publisher's period for two windows: a full
+    // window with nothing dropped
+    rolling_stats_init();
+    memset(pushed, 0, sizeof(pushed));
+    for (int ch = 0; ch < ROLLING_CH_COUNT; ch++) {
+        for (uint32_t t = 0; t <= 2 * window_ms[ch]; t += period_ms[ch]) {
+            host_advance_us((int64_t)period_ms[ch] * 1000);
+            push((rolling_channel_t)ch, (int32_t)(next_random() % 256));
+            compare((rolling_channel_t)ch, "publish rate");
+        }
+        rolling_stats_t s;
+        rolling_stats_get((rolling_channel_t)ch, &s);
+        char what[64];
+        snprintf(what, sizeof(what), "%s at %lu ms, samples in a full window", names[ch],
+                 (unsigned long)period_ms[ch]);
+        check(s.count == window_ms[ch] / period_ms[ch] + 1 && s.span_ms == window_ms[ch], what,
+              s.count, window_ms[ch] / period_ms[ch] + 1);
+    }
+
+    // Throttle every millisecond: far more than its window holds
+    for (int i = 0; i < 1000; i++) {
+        host_advance_us(1000);
+        push(ROLLING_CH_THROTTLE, (int32_t)(next_random() % 101));
+        compare(ROLLING_CH_THROTTLE, "overflow");
+    }
+    rolling_stats_t s;
+    rolling_stats_get(ROLLING_CH_THROTTLE, &s);
+    check(s.count == ROLLING_CAPACITY_THROTTLE && s.span_ms == ROLLING_CAPACITY_THROTTLE - 1,
+          "throttle at 1 ms, samples held", s.count, ROLLING_CAPACITY_THROTTLE);
+
+    printf("%d comparisons against the scan\n", comparisons);
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("Rolling statistics checks passed\n");
+    return 0;
+}